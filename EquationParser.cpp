@@ -1,4 +1,5 @@
 #include "EquationParser.h"
+#include "Instrumentation.h"
 #include <cctype>
 #include <algorithm>
 #include <iostream>
@@ -457,6 +458,7 @@ double EquationParser::parsePrimary()
 
 bool EquationParser::validate(std::string &errorMessage)
 {
+    SURFACE_TIME_SCOPE(PARSE);
     try
     {
         // Try to tokenize
@@ -536,4 +538,693 @@ std::vector<std::string> EquationParser::getVariables() const
     }
 
     return vars;
-}
\ No newline at end of file
+}
+
+// ---- Compilation ----
+
+void EquationParser::emit(CompiledEquation &out, int &depth, CompiledEquation::OpCode op,
+                          double constant, int slot)
+{
+    CompiledEquation::Instruction instruction;
+    instruction.op = op;
+    instruction.constant = constant;
+    instruction.slot = slot;
+    out.program.push_back(instruction);
+
+    // Track the stack depth the program needs
+    if (op == CompiledEquation::PUSH_CONSTANT || op == CompiledEquation::PUSH_VARIABLE)
+        depth++;
+    else if (op != CompiledEquation::NEGATE && op < CompiledEquation::SIN)
+        depth--; // Binary operator
+    else if (op >= CompiledEquation::POW)
+        depth--; // Binary function
+    out.stackDepth = std::max(out.stackDepth, depth);
+}
+
+CompiledEquation EquationParser::compile(const std::vector<std::string> &variableNames)
+{
+    SURFACE_TIME_SCOPE(COMPILE);
+    CompiledEquation out;
+    out.variableNames = variableNames;
+
+    tokenize();
+    currentToken = 0;
+    int depth = 0;
+    compileExpression(out, depth);
+
+    if (currentToken >= tokens.size())
+        throw std::runtime_error("Unexpected end of expression");
+    if (tokens[currentToken].type != END)
+        throw std::runtime_error("Unexpected token: " + tokens[currentToken].value);
+
+    return out;
+}
+
+void EquationParser::compileExpression(CompiledEquation &out, int &depth)
+{
+    compileTerm(out, depth);
+
+    while (currentToken < tokens.size() &&
+           tokens[currentToken].type == OPERATOR &&
+           (tokens[currentToken].value == "+" || tokens[currentToken].value == "-"))
+    {
+        std::string op = tokens[currentToken].value;
+        currentToken++;
+        compileTerm(out, depth);
+        emit(out, depth, op == "+" ? CompiledEquation::ADD : CompiledEquation::SUBTRACT);
+    }
+}
+
+void EquationParser::compileTerm(CompiledEquation &out, int &depth)
+{
+    compilePower(out, depth);
+
+    while (currentToken < tokens.size() &&
+           tokens[currentToken].type == OPERATOR &&
+           (tokens[currentToken].value == "*" || tokens[currentToken].value == "/" || tokens[currentToken].value == "%"))
+    {
+        std::string op = tokens[currentToken].value;
+        currentToken++;
+        compilePower(out, depth);
+
+        if (op == "*")
+            emit(out, depth, CompiledEquation::MULTIPLY);
+        else if (op == "/")
+            emit(out, depth, CompiledEquation::DIVIDE);
+        else
+            emit(out, depth, CompiledEquation::MODULO);
+    }
+}
+
+void EquationParser::compilePower(CompiledEquation &out, int &depth)
+{
+    compileUnary(out, depth);
+
+    if (currentToken < tokens.size() &&
+        tokens[currentToken].type == OPERATOR &&
+        tokens[currentToken].value == "^")
+    {
+        currentToken++;
+        compilePower(out, depth); // Right associative
+        emit(out, depth, CompiledEquation::POWER);
+    }
+}
+
+void EquationParser::compileUnary(CompiledEquation &out, int &depth)
+{
+    if (currentToken < tokens.size() &&
+        tokens[currentToken].type == OPERATOR &&
+        (tokens[currentToken].value == "+" || tokens[currentToken].value == "-"))
+    {
+        std::string op = tokens[currentToken].value;
+        currentToken++;
+        compileUnary(out, depth);
+        if (op == "-")
+            emit(out, depth, CompiledEquation::NEGATE);
+        return;
+    }
+
+    compilePrimary(out, depth);
+}
+
+void EquationParser::compilePrimary(CompiledEquation &out, int &depth)
+{
+    static const std::map<std::string, CompiledEquation::OpCode> functionCodes = {
+        {"sin", CompiledEquation::SIN}, {"cos", CompiledEquation::COS},
+        {"tan", CompiledEquation::TAN}, {"exp", CompiledEquation::EXP},
+        {"log", CompiledEquation::LOG}, {"ln", CompiledEquation::LOG},
+        {"log10", CompiledEquation::LOG10}, {"sqrt", CompiledEquation::SQRT},
+        {"abs", CompiledEquation::ABS}, {"floor", CompiledEquation::FLOOR},
+        {"ceil", CompiledEquation::CEIL}, {"pow", CompiledEquation::POW},
+        {"min", CompiledEquation::MIN}, {"max", CompiledEquation::MAX}};
+
+    if (currentToken >= tokens.size())
+        throw std::runtime_error("Unexpected end of expression");
+
+    Token token = tokens[currentToken];
+
+    if (token.type == NUMBER)
+    {
+        currentToken++;
+        emit(out, depth, CompiledEquation::PUSH_CONSTANT, token.numValue);
+        return;
+    }
+
+    if (token.type == VARIABLE)
+    {
+        currentToken++;
+        auto slot = std::find(out.variableNames.begin(), out.variableNames.end(), token.value);
+        if (slot == out.variableNames.end())
+            throw std::runtime_error("Undefined variable: " + token.value);
+        emit(out, depth, CompiledEquation::PUSH_VARIABLE, 0, static_cast<int>(slot - out.variableNames.begin()));
+        return;
+    }
+
+    if (token.type == FUNCTION)
+    {
+        std::string funcName = token.value;
+        currentToken++;
+
+        if (currentToken >= tokens.size() || tokens[currentToken].type != LPAREN)
+            throw std::runtime_error("Expected '(' after function name");
+
+        currentToken++; // Skip '('
+
+        auto code = functionCodes.find(funcName);
+        if (code == functionCodes.end())
+            throw std::runtime_error("Unknown function: " + funcName);
+
+        if (binaryFunctions.find(funcName) != binaryFunctions.end())
+        {
+            compileExpression(out, depth);
+
+            if (currentToken >= tokens.size() || tokens[currentToken].value != ",")
+                throw std::runtime_error("Expected ',' in binary function");
+
+            currentToken++; // Skip ','
+            compileExpression(out, depth);
+        }
+        else
+        {
+            compileExpression(out, depth);
+        }
+
+        if (currentToken >= tokens.size() || tokens[currentToken].type != RPAREN)
+            throw std::runtime_error("Expected ')' after function argument");
+
+        currentToken++; // Skip ')'
+        emit(out, depth, code->second);
+        return;
+    }
+
+    if (token.type == LPAREN)
+    {
+        currentToken++; // Skip '('
+        compileExpression(out, depth);
+
+        if (currentToken >= tokens.size() || tokens[currentToken].type != RPAREN)
+            throw std::runtime_error("Expected ')'");
+
+        currentToken++; // Skip ')'
+        return;
+    }
+
+    throw std::runtime_error("Unexpected token: " + token.value);
+}
+
+// ---- Compiled evaluation ----
+
+double CompiledEquation::evaluate(const double *values) const
+{
+    // Small programs run entirely on the C++ stack
+    double local[64];
+    std::vector<double> heap;
+    double *stack = local;
+    if (stackDepth > 64)
+    {
+        heap.resize(stackDepth);
+        stack = heap.data();
+    }
+
+    int top = -1;
+    for (const Instruction &instruction : program)
+    {
+        switch (instruction.op)
+        {
+        case PUSH_CONSTANT:
+            stack[++top] = instruction.constant;
+            break;
+        case PUSH_VARIABLE:
+            stack[++top] = values[instruction.slot];
+            break;
+        case ADD:
+            stack[top - 1] += stack[top];
+            --top;
+            break;
+        case SUBTRACT:
+            stack[top - 1] -= stack[top];
+            --top;
+            break;
+        case MULTIPLY:
+            stack[top - 1] *= stack[top];
+            --top;
+            break;
+        case DIVIDE:
+            stack[top - 1] /= stack[top];
+            --top;
+            break;
+        case MODULO:
+            stack[top - 1] = std::fmod(stack[top - 1], stack[top]);
+            --top;
+            break;
+        case POWER:
+        case POW:
+            stack[top - 1] = std::pow(stack[top - 1], stack[top]);
+            --top;
+            break;
+        case MIN:
+            stack[top - 1] = std::min(stack[top - 1], stack[top]);
+            --top;
+            break;
+        case MAX:
+            stack[top - 1] = std::max(stack[top - 1], stack[top]);
+            --top;
+            break;
+        case NEGATE:
+            stack[top] = -stack[top];
+            break;
+        case SIN:
+            stack[top] = std::sin(stack[top]);
+            break;
+        case COS:
+            stack[top] = std::cos(stack[top]);
+            break;
+        case TAN:
+            stack[top] = std::tan(stack[top]);
+            break;
+        case EXP:
+            stack[top] = std::exp(stack[top]);
+            break;
+        case LOG:
+            stack[top] = std::log(stack[top]);
+            break;
+        case LOG10:
+            stack[top] = std::log10(stack[top]);
+            break;
+        case SQRT:
+            stack[top] = std::sqrt(stack[top]);
+            break;
+        case ABS:
+            stack[top] = std::abs(stack[top]);
+            break;
+        case FLOOR:
+            stack[top] = std::floor(stack[top]);
+            break;
+        case CEIL:
+            stack[top] = std::ceil(stack[top]);
+            break;
+        }
+    }
+
+    return top >= 0 ? stack[top] : 0.0;
+}
+
+double CompiledEquation::evaluate(double x, double y, double z) const
+{
+    // x, y and z are bound by name; any other variable reads as 0
+    double local[16] = {};
+    std::vector<double> heap;
+    double *values = local;
+    if (variableNames.size() > 16)
+    {
+        heap.assign(variableNames.size(), 0.0);
+        values = heap.data();
+    }
+
+    for (size_t k = 0; k < variableNames.size(); ++k)
+    {
+        const std::string &name = variableNames[k];
+        if (name == "x")
+            values[k] = x;
+        else if (name == "y")
+            values[k] = y;
+        else if (name == "z")
+            values[k] = z;
+    }
+
+    return evaluate(values);
+}
+
+namespace
+{
+    // u^n for a constant exponent; n = 0 and n = 1 stay exact at u = 0
+    expr::Dual2 dualPower(const expr::Dual2 &u, double n)
+    {
+        if (n == 0)
+            return expr::Dual2(std::pow(u.v, n));
+        if (n == 1)
+            return u;
+        return expr::dualPow(u, n);
+    }
+}
+
+expr::Dual2 CompiledEquation::evaluateDerivatives(double x, double y) const
+{
+    using expr::Dual2;
+
+    Dual2 local[64];
+    std::vector<Dual2> heap;
+    Dual2 *stack = local;
+    if (stackDepth > 64)
+    {
+        heap.resize(stackDepth);
+        stack = heap.data();
+    }
+
+    // Seed x and y with unit derivatives; anything else is a constant 0
+    std::vector<Dual2> values(variableNames.size());
+    for (size_t k = 0; k < variableNames.size(); ++k)
+    {
+        if (variableNames[k] == "x")
+            values[k] = Dual2(x, 1, 0, 0, 0, 0);
+        else if (variableNames[k] == "y")
+            values[k] = Dual2(y, 0, 1, 0, 0, 0);
+    }
+
+    int top = -1;
+    for (const Instruction &instruction : program)
+    {
+        if (instruction.op == PUSH_CONSTANT)
+        {
+            stack[++top] = Dual2(instruction.constant);
+            continue;
+        }
+        if (instruction.op == PUSH_VARIABLE)
+        {
+            stack[++top] = values[instruction.slot];
+            continue;
+        }
+
+        // Top of the stack: the operand of unary ops, the right one of binary ops
+        Dual2 &u = stack[top];
+        switch (instruction.op)
+        {
+        case ADD:
+            stack[top - 1] = stack[top - 1] + u;
+            --top;
+            break;
+        case SUBTRACT:
+            stack[top - 1] = stack[top - 1] - u;
+            --top;
+            break;
+        case MULTIPLY:
+            stack[top - 1] = stack[top - 1] * u;
+            --top;
+            break;
+        case DIVIDE:
+            stack[top - 1] = stack[top - 1] / u;
+            --top;
+            break;
+        case MODULO:
+        {
+            // fmod(a, b) = a - trunc(a / b) b, with trunc(a / b) locally constant
+            Dual2 &a = stack[top - 1];
+            double quotient = std::trunc(a.v / u.v);
+            double remainder = std::fmod(a.v, u.v);
+            a = a - Dual2(quotient) * u;
+            a.v = remainder;
+            --top;
+            break;
+        }
+        case POWER:
+        case POW:
+        {
+            Dual2 &a = stack[top - 1];
+            if (u.dx == 0 && u.dy == 0 && u.dxx == 0 && u.dxy == 0 && u.dyy == 0)
+            {
+                a = dualPower(a, u.v);
+            }
+            else
+            {
+                // a^b = exp(b log a)
+                double value = std::pow(a.v, u.v);
+                a = expr::dualExp(u * expr::dualLog(a));
+                a.v = value;
+            }
+            --top;
+            break;
+        }
+        case MIN:
+            if (u.v < stack[top - 1].v)
+                stack[top - 1] = u;
+            --top;
+            break;
+        case MAX:
+            if (stack[top - 1].v < u.v)
+                stack[top - 1] = u;
+            --top;
+            break;
+        case NEGATE:
+            u = -u;
+            break;
+        case SIN:
+            u = expr::dualSin(u);
+            break;
+        case COS:
+            u = expr::dualCos(u);
+            break;
+        case TAN:
+            u = expr::dualTan(u);
+            break;
+        case EXP:
+            u = expr::dualExp(u);
+            break;
+        case LOG:
+            u = expr::dualLog(u);
+            break;
+        case LOG10:
+        {
+            const double ln10 = std::log(10.0);
+            u = u.chain(std::log10(u.v), 1.0 / (u.v * ln10), -1.0 / (u.v * u.v * ln10));
+            break;
+        }
+        case SQRT:
+            u = expr::dualSqrt(u);
+            break;
+        case ABS:
+            u = expr::dualAbs(u);
+            break;
+        case FLOOR:
+            u = Dual2(std::floor(u.v));
+            break;
+        case CEIL:
+            u = Dual2(std::ceil(u.v));
+            break;
+        default:
+            break;
+        }
+    }
+
+    return top >= 0 ? stack[top] : Dual2(0.0);
+}
+
+double CompiledEquation::evaluateGradient(const double *values, double *gradient) const
+{
+    // Forward pass records every instruction's value and operands on a tape
+    // reused by the calling thread; the reverse pass then pushes adjoints
+    // from the result back to the variables, so one call costs about two
+    // evaluations whatever the number of variables.
+    thread_local std::vector<double> tape, adjoint;
+    thread_local std::vector<int> left, right, stack;
+    size_t length = program.size();
+    tape.resize(length);
+    adjoint.assign(length, 0.0);
+    left.resize(length);
+    right.resize(length);
+    stack.resize(std::max(stackDepth, 1));
+
+    int top = -1;
+    for (size_t i = 0; i < length; ++i)
+    {
+        const Instruction &instruction = program[i];
+        left[i] = right[i] = -1;
+        switch (instruction.op)
+        {
+        case PUSH_CONSTANT:
+            tape[i] = instruction.constant;
+            stack[++top] = static_cast<int>(i);
+            continue;
+        case PUSH_VARIABLE:
+            tape[i] = values[instruction.slot];
+            stack[++top] = static_cast<int>(i);
+            continue;
+        case ADD:
+        case SUBTRACT:
+        case MULTIPLY:
+        case DIVIDE:
+        case MODULO:
+        case POWER:
+        case POW:
+        case MIN:
+        case MAX:
+            left[i] = stack[top - 1];
+            right[i] = stack[top];
+            --top;
+            break;
+        default:
+            left[i] = stack[top];
+            break;
+        }
+        stack[top] = static_cast<int>(i);
+
+        double a = tape[left[i]];
+        double b = right[i] >= 0 ? tape[right[i]] : 0.0;
+        switch (instruction.op)
+        {
+        case ADD:
+            tape[i] = a + b;
+            break;
+        case SUBTRACT:
+            tape[i] = a - b;
+            break;
+        case MULTIPLY:
+            tape[i] = a * b;
+            break;
+        case DIVIDE:
+            tape[i] = a / b;
+            break;
+        case MODULO:
+            tape[i] = std::fmod(a, b);
+            break;
+        case POWER:
+        case POW:
+            tape[i] = std::pow(a, b);
+            break;
+        case MIN:
+            tape[i] = std::min(a, b);
+            break;
+        case MAX:
+            tape[i] = std::max(a, b);
+            break;
+        case NEGATE:
+            tape[i] = -a;
+            break;
+        case SIN:
+            tape[i] = std::sin(a);
+            break;
+        case COS:
+            tape[i] = std::cos(a);
+            break;
+        case TAN:
+            tape[i] = std::tan(a);
+            break;
+        case EXP:
+            tape[i] = std::exp(a);
+            break;
+        case LOG:
+            tape[i] = std::log(a);
+            break;
+        case LOG10:
+            tape[i] = std::log10(a);
+            break;
+        case SQRT:
+            tape[i] = std::sqrt(a);
+            break;
+        case ABS:
+            tape[i] = std::abs(a);
+            break;
+        case FLOOR:
+            tape[i] = std::floor(a);
+            break;
+        case CEIL:
+            tape[i] = std::ceil(a);
+            break;
+        default:
+            break;
+        }
+    }
+
+    for (size_t k = 0; k < variableNames.size(); ++k)
+        gradient[k] = 0.0;
+    if (top < 0)
+        return 0.0;
+
+    // Reverse pass; piecewise functions use the active piece, as in
+    // evaluateDerivatives
+    int result = stack[top];
+    adjoint[result] = 1.0;
+    for (int i = result; i >= 0; --i)
+    {
+        double bar = adjoint[i];
+        if (bar == 0.0)
+            continue;
+        const Instruction &instruction = program[i];
+        if (instruction.op == PUSH_VARIABLE)
+        {
+            gradient[instruction.slot] += bar;
+            continue;
+        }
+        if (instruction.op == PUSH_CONSTANT)
+            continue;
+
+        double a = tape[left[i]];
+        double b = right[i] >= 0 ? tape[right[i]] : 0.0;
+        double &abar = adjoint[left[i]];
+        switch (instruction.op)
+        {
+        case ADD:
+            abar += bar;
+            adjoint[right[i]] += bar;
+            break;
+        case SUBTRACT:
+            abar += bar;
+            adjoint[right[i]] -= bar;
+            break;
+        case MULTIPLY:
+            abar += bar * b;
+            adjoint[right[i]] += bar * a;
+            break;
+        case DIVIDE:
+            abar += bar / b;
+            adjoint[right[i]] -= bar * a / (b * b);
+            break;
+        case MODULO:
+            // fmod(a, b) = a - trunc(a / b) b
+            abar += bar;
+            adjoint[right[i]] -= bar * std::trunc(a / b);
+            break;
+        case POWER:
+        case POW:
+            if (b != 0)
+                abar += bar * b * std::pow(a, b - 1.0);
+            if (a > 0)
+                adjoint[right[i]] += bar * tape[i] * std::log(a);
+            break;
+        case MIN:
+            adjoint[b < a ? right[i] : left[i]] += bar;
+            break;
+        case MAX:
+            adjoint[a < b ? right[i] : left[i]] += bar;
+            break;
+        case NEGATE:
+            abar -= bar;
+            break;
+        case SIN:
+            abar += bar * std::cos(a);
+            break;
+        case COS:
+            abar -= bar * std::sin(a);
+            break;
+        case TAN:
+        {
+            double c = std::cos(a);
+            abar += bar / (c * c);
+            break;
+        }
+        case EXP:
+            abar += bar * tape[i];
+            break;
+        case LOG:
+            abar += bar / a;
+            break;
+        case LOG10:
+            abar += bar / (a * std::log(10.0));
+            break;
+        case SQRT:
+            abar += bar * 0.5 / tape[i];
+            break;
+        case ABS:
+            abar += a < 0 ? -bar : bar;
+            break;
+        default:
+            break; // FLOOR and CEIL are locally constant
+        }
+    }
+
+    return tape[result];
+}
+
+double EquationObjective::valueAndGradient(const double *x, double *grad) const
+{
+    return equation->evaluateGradient(x, grad);
+}
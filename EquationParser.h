@@ -8,6 +8,97 @@
 #include <cmath>
 #include <sstream>
 #include <stdexcept>
+#include <memory>
+#include "SurfaceExpr.h"
+#include "Objective.h"
+
+// Equation compiled to a flat postfix program.
+// Immutable after compilation, so one instance can be evaluated from many
+// threads at once, and it skips the tokenizing and map lookups that
+// EquationParser::evaluate repeats on every call. Arithmetic follows IEEE
+// rules (x / 0 gives inf) instead of throwing.
+class CompiledEquation
+{
+public:
+    enum OpCode
+    {
+        PUSH_CONSTANT,
+        PUSH_VARIABLE,
+        ADD,
+        SUBTRACT,
+        MULTIPLY,
+        DIVIDE,
+        MODULO,
+        POWER,
+        NEGATE,
+        SIN,
+        COS,
+        TAN,
+        EXP,
+        LOG,
+        LOG10,
+        SQRT,
+        ABS,
+        FLOOR,
+        CEIL,
+        POW,
+        MIN,
+        MAX
+    };
+
+    struct Instruction
+    {
+        OpCode op;
+        double constant; // PUSH_CONSTANT
+        int slot;        // PUSH_VARIABLE
+    };
+
+private:
+    std::vector<Instruction> program;
+    std::vector<std::string> variableNames;
+    int stackDepth;
+
+    friend class EquationParser;
+
+public:
+    CompiledEquation() : stackDepth(0) {}
+
+    // values[k] is the value of getVariableNames()[k]
+    double evaluate(const double *values) const;
+
+    // Convenience for the default x, y, z slots
+    double evaluate(double x, double y, double z = 0) const;
+
+    // Value, gradient and Hessian in x and y, by running the program on
+    // second-order duals; z and other variables are held at 0. Piecewise
+    // functions (abs, floor, ceil, %, min, max) use the derivative of the
+    // active piece.
+    expr::Dual2 evaluateDerivatives(double x, double y) const;
+
+    // Value, with the gradient in every variable written to gradient (one
+    // entry per getVariableNames()), by reverse-mode differentiation
+    double evaluateGradient(const double *values, double *gradient) const;
+
+    const std::vector<std::string> &getVariableNames() const { return variableNames; }
+    const std::vector<Instruction> &getProgram() const { return program; }
+    int getStackDepth() const { return stackDepth; }
+};
+
+// Compiled equation as an N-dimensional objective over all its variables,
+// in compile() order, with reverse-mode gradients
+class EquationObjective : public Objective
+{
+private:
+    std::shared_ptr<const CompiledEquation> equation;
+
+public:
+    explicit EquationObjective(std::shared_ptr<const CompiledEquation> equation)
+        : equation(equation) {}
+
+    size_t dimension() const override { return equation->getVariableNames().size(); }
+    double value(const double *x) const override { return equation->evaluate(x); }
+    double valueAndGradient(const double *x, double *grad) const override;
+};
 
 class EquationParser
 {
@@ -50,6 +141,15 @@ private:
     double parseUnary();
     double parsePrimary();
 
+    // Compilation mirrors the parse methods above
+    void compileExpression(CompiledEquation &out, int &depth);
+    void compileTerm(CompiledEquation &out, int &depth);
+    void compilePower(CompiledEquation &out, int &depth);
+    void compileUnary(CompiledEquation &out, int &depth);
+    void compilePrimary(CompiledEquation &out, int &depth);
+    void emit(CompiledEquation &out, int &depth, CompiledEquation::OpCode op,
+              double constant = 0, int slot = -1);
+
     bool isOperator(char c) const;
     bool isFunction(const std::string &str) const;
     int getPrecedence(char op) const;
@@ -76,6 +176,11 @@ public:
     // Quick evaluation for x, y, z
     double evaluate(double x, double y, double z = 0);
 
+    // Compile for fast, thread-safe evaluation. Variables are bound to slots
+    // in the given order; throws std::runtime_error on syntax errors or
+    // variables not in the list.
+    CompiledEquation compile(const std::vector<std::string> &variableNames = {"x", "y", "z"});
+
     // Validate equation syntax
     bool validate(std::string &errorMessage);
 
@@ -1,8 +1,10 @@
 #include "GUIManager.h"
+#include "Instrumentation.h"
 #include <iostream>
 #include <sstream>
 #include <iomanip>
 #include <cstring>
+#include <algorithm>
 
 // Static instance for callbacks
 GUIManager *GUIManager::instance = nullptr;
@@ -15,6 +17,8 @@ GUIManager::GUIManager()
       runOptimization(true),
       startX(5.0), startY(5.0),
       learningRate(0.01),
+      multiStarts(1),
+      basinResolution(0),
       xMin(-10.0), xMax(10.0),
       yMin(-10.0), yMax(10.0),
       resolution(50),
@@ -125,6 +129,17 @@ void GUIManager::timerCallback(int value)
     }
 }
 
+void GUIManager::progressCallback(int)
+{
+    if (instance && instance->asyncRun)
+    {
+        instance->pollOptimization();
+        glutPostRedisplay();
+        if (instance->asyncRun)
+            glutTimerFunc(33, progressCallback, 0);
+    }
+}
+
 void GUIManager::display()
 {
     glClear(GL_COLOR_BUFFER_BIT);
@@ -219,6 +234,8 @@ void GUIManager::displayConfiguration()
         "Start X: ",
         "Start Y: ",
         "Learning Rate: ",
+        "Start Points: ",
+        "Basin Map Resolution (0 = off): ",
         "X Min: ",
         "X Max: ",
         "Y Min: ",
@@ -231,6 +248,8 @@ void GUIManager::displayConfiguration()
         std::to_string(startX),
         std::to_string(startY),
         std::to_string(learningRate),
+        std::to_string(multiStarts),
+        std::to_string(basinResolution),
         std::to_string(xMin),
         std::to_string(xMax),
         std::to_string(yMin),
@@ -338,6 +357,24 @@ void GUIManager::handleConfigurationInput(unsigned char key)
                     return;
                 }
                 break;
+            case STARTS_FIELD:
+                multiStarts = std::stoi(configInput);
+                if (multiStarts < 1 || multiStarts > 1024)
+                {
+                    errorMessage = "Start points must be between 1 and 1024";
+                    currentState = ERROR_DISPLAY;
+                    return;
+                }
+                break;
+            case BASINS_FIELD:
+                basinResolution = std::stoi(configInput);
+                if (basinResolution != 0 && (basinResolution < 2 || basinResolution > 2048))
+                {
+                    errorMessage = "Basin map resolution must be 0 or between 2 and 2048";
+                    currentState = ERROR_DISPLAY;
+                    return;
+                }
+                break;
             case X_MIN_FIELD:
                 xMin = std::stod(configInput);
                 break;
@@ -445,15 +482,22 @@ void GUIManager::validateAndProceed()
         return;
     }
 
-    // Check that equation uses x and y
+    // Check that equation uses x and y, and nothing else the compiled
+    // surface could not bind
     auto vars = parser->getVariables();
     bool hasX = false, hasY = false;
     for (const auto &var : vars)
     {
         if (var == "x")
             hasX = true;
-        if (var == "y")
+        else if (var == "y")
             hasY = true;
+        else
+        {
+            errorMessage = "Unknown variable '" + var + "': equations may only use x and y";
+            currentState = ERROR_DISPLAY;
+            return;
+        }
     }
 
     if (!hasX || !hasY)
@@ -475,38 +519,120 @@ void GUIManager::startVisualization()
     std::cout << "Bounds: [" << xMin << ", " << xMax << "] x [" << yMin << ", " << yMax << "]" << std::endl;
     std::cout << "Resolution: " << resolution << std::endl;
 
-    // Create custom surface from equation
+    // Create custom surface from equation; the compiled form is safe to
+    // evaluate from several threads at once and gives exact derivatives
+    compiledEquation = std::make_shared<CompiledEquation>(parser->compile());
+    std::shared_ptr<CompiledEquation> compiled = compiledEquation;
     currentSurface = std::make_unique<CustomSurface>(
-        [this](double x, double y) -> double
+        [compiled](double x, double y) -> double
         {
-            return this->parser->evaluate(x, y, 0);
+            return compiled->evaluate(x, y, 0);
+        },
+        [compiled](double x, double y)
+        {
+            return compiled->evaluateDerivatives(x, y);
         });
 
     // Run optimization if requested
-    if (runOptimization)
+    if (runOptimization && multiStarts > 1)
+    {
+        std::cout << "\nRunning multi-start optimization..." << std::endl;
+        std::cout << "Start points: " << multiStarts << " (Sobol)" << std::endl;
+        std::cout << "Learning rate: " << learningRate << std::endl;
+
+        MultiStartOptions options;
+        options.starts = multiStarts;
+        options.mergeTolerance = 1e-3 * std::max(xMax - xMin, yMax - yMin);
+        MultiStartOptimizer multiStart(currentSurface.get(),
+                                       MultiStartOptimizer::gradientDescent(learningRate, 1000, 1e-6),
+                                       options);
+        MultiStartResult multiResult = multiStart.optimize(xMin, xMax, yMin, yMax);
+
+        std::cout << "\nOptimization complete!" << std::endl;
+        std::cout << "Converged runs: " << multiResult.convergedRuns << " / " << multiStarts << std::endl;
+        std::cout << "Distinct minima: " << multiResult.minima.size() << std::endl;
+        for (size_t i = 0; i < multiResult.minima.size(); ++i)
+        {
+            const LocalMinimum &minimum = multiResult.minima[i];
+            std::cout << "  " << i + 1 << ". (" << minimum.point.getX() << ", " << minimum.point.getY()
+                      << ", " << minimum.value << ") reached by " << minimum.hits << " run(s)" << std::endl;
+        }
+        std::cout << "Evaluations: " << multiResult.functionEvaluations << " function, "
+                  << multiResult.gradientEvaluations << " gradient" << std::endl;
+        std::cout << "Wall time: " << multiResult.wallSeconds * 1000.0 << " ms" << std::endl;
+
+        // Show the path of the run that found the best minimum
+        optResult = std::make_unique<OptimizationResult>(*multiResult.best());
+    }
+    else if (runOptimization)
     {
         std::cout << "\nRunning optimization..." << std::endl;
         std::cout << "Start point: (" << startX << ", " << startY << ")" << std::endl;
         std::cout << "Learning rate: " << learningRate << std::endl;
 
-        GradientDescent optimizer(currentSurface.get(), learningRate, 1000, 1e-6);
-        optResult = std::make_unique<OptimizationResult>(optimizer.optimize(startX, startY));
+        // Runs on a worker thread; the path streams into the view as it
+        // grows and 'c' cancels (see pollOptimization)
+        OptimizationBudget budget;
+        budget.seconds = 60;
+        asyncRun = std::make_unique<AsyncOptimization>(
+            std::make_unique<GradientDescent>(currentSurface.get(), learningRate, 1000, 1e-6),
+            startX, startY, budget);
+        optResult = std::make_unique<OptimizationResult>();
+    }
+
+    // Label every grid vertex with the minimum gradient descent reaches from it
+    if (basinResolution > 0)
+    {
+        std::cout << "\nComputing basin map (" << basinResolution << " x " << basinResolution << ")..." << std::endl;
+
+        BasinMapOptions options;
+        options.resolution = basinResolution;
+        options.mergeTolerance = 1e-3 * std::max(xMax - xMin, yMax - yMin);
+        BasinMapper mapper(currentSurface.get(), MultiStartOptimizer::gradientDescent(learningRate, 1000, 1e-6),
+                           options);
+        basinMap = std::make_unique<BasinMap>(mapper.compute(xMin, xMax, yMin, yMax));
 
-        std::cout << "\nOptimization complete!" << std::endl;
-        std::cout << "Converged: " << (optResult->converged ? "Yes" : "No") << std::endl;
-        std::cout << "Iterations: " << optResult->iterations << std::endl;
-        std::cout << "Minimum at: (" << optResult->minimumPoint.getX()
-                  << ", " << optResult->minimumPoint.getY()
-                  << ", " << optResult->minimumPoint.getZ() << ")" << std::endl;
+        std::cout << "Basins: " << basinMap->minima.size() << std::endl;
+        for (size_t i = 0; i < basinMap->minima.size(); ++i)
+        {
+            const LocalMinimum &minimum = basinMap->minima[i];
+            std::cout << "  " << i + 1 << ". (" << minimum.point.getX() << ", " << minimum.point.getY()
+                      << ", " << minimum.value << ") " << minimum.hits << " cells" << std::endl;
+        }
+        std::cout << "Cells stopped on a labelled cell: " << basinMap->absorbedCells << std::endl;
+        std::cout << "Wall time: " << basinMap->wallSeconds * 1000.0 << " ms" << std::endl;
     }
 
+    // Reuse the cached mesh for this equation, domain and resolution if present
+    MeshCache meshCache;
+    heightField = std::make_unique<HeightField>(meshCache.getOrCreate(
+        MeshCache::hashEquation(parser->getEquation()), *currentSurface,
+        xMin, xMax, yMin, yMax, resolution));
+
+    // Where the set-up went: parse, compile, optimization and mesh totals so far
+    std::cout << "\nInstrumentation:" << std::endl;
+    instrumentation::print(std::cout, instrumentation::snapshot());
+
     // Create visualizer
     visualizer = std::make_unique<Visualizer>(currentSurface.get(), xMin, xMax, yMin, yMax, resolution);
+    visualizer->setHeightField(heightField.get());
 
     if (optResult)
     {
         visualizer->setOptimizationResult(optResult.get());
     }
+    if (basinMap)
+    {
+        visualizer->setBasinMap(basinMap.get());
+    }
+    if (asyncRun)
+    {
+        visualizer->setStatusText("Optimizing...  (c to cancel)");
+        visualizer->setCancelHandler([this]()
+                                     {
+            if (asyncRun)
+                asyncRun->cancel(); });
+    }
 
     // Close current window and prepare new window
     int oldWindow = glutGetWindow();
@@ -534,14 +660,71 @@ void GUIManager::startVisualization()
     glutDisplayFunc(Visualizer::displayCallback);
     glutReshapeFunc(Visualizer::reshapeCallback);
     glutKeyboardFunc(Visualizer::keyboardCallback);
+    glutMouseFunc(Visualizer::mouseCallback);
 
     // Destroy old GUI window
     glutDestroyWindow(oldWindow);
 
+    // Stream the running optimization into the view
+    if (asyncRun)
+    {
+        glutTimerFunc(33, progressCallback, 0);
+    }
+
     // Trigger initial display
     glutPostRedisplay();
 }
 
+void GUIManager::pollOptimization()
+{
+    asyncRun->drainPath(optResult->path);
+
+    if (!asyncRun->finished())
+    {
+        const OptimizationMonitor &monitor = asyncRun->getMonitor();
+        std::ostringstream status;
+        status << "Optimizing...  iteration " << monitor.getIterations()
+               << ", " << monitor.getEvaluations() << " evaluations  (c to cancel)";
+        visualizer->setStatusText(status.str());
+        return;
+    }
+
+    // The optimizer's own recording replaces the streamed (possibly lossy) path
+    *optResult = asyncRun->wait();
+    asyncRun.reset();
+
+    std::string outcome = optResult->converged ? "Converged" : "Not converged";
+    switch (optResult->stopReason)
+    {
+    case StopReason::CANCELLED:
+        outcome = "Cancelled";
+        break;
+    case StopReason::TIME_BUDGET:
+        outcome = "Stopped: time budget";
+        break;
+    case StopReason::EVALUATION_BUDGET:
+        outcome = "Stopped: evaluation budget";
+        break;
+    case StopReason::NONE:
+    case StopReason::ABSORBED:
+        break;
+    }
+
+    std::cout << "\nOptimization complete!" << std::endl;
+    std::cout << "Outcome: " << outcome << std::endl;
+    std::cout << "Iterations: " << optResult->iterations << std::endl;
+    std::cout << "Minimum at: (" << optResult->minimumPoint.getX()
+              << ", " << optResult->minimumPoint.getY()
+              << ", " << optResult->minimumPoint.getZ() << ")" << std::endl;
+    std::cout << "Instrumentation:" << std::endl;
+    instrumentation::print(std::cout, instrumentation::snapshot());
+
+    std::ostringstream status;
+    status << outcome << " after " << optResult->iterations << " iterations, f = "
+           << optResult->minimumPoint.getZ();
+    visualizer->setStatusText(status.str());
+}
+
 void GUIManager::drawText(const std::string &text, float x, float y, void *font)
 {
     glRasterPos2f(x, y);
@@ -5,6 +5,10 @@
 #include "EquationParser.h"
 #include "Optimizer.h"
 #include "Visualizer.h"
+#include "MeshCache.h"
+#include "MultiStartOptimizer.h"
+#include "AsyncOptimizer.h"
+#include "BasinMap.h"
 #include <GL/glut.h>
 #include <string>
 #include <memory>
@@ -32,14 +36,20 @@ private:
     bool runOptimization;
     double startX, startY;
     double learningRate;
+    int multiStarts; // Start points; 1 runs a single descent from (startX, startY)
+    int basinResolution; // Basin map vertices per side; 0 skips the map
     double xMin, xMax, yMin, yMax;
     int resolution;
 
     // Current surface and results
     std::unique_ptr<CustomSurface> currentSurface;
     std::unique_ptr<EquationParser> parser;
+    std::shared_ptr<CompiledEquation> compiledEquation; // Thread-safe evaluation
     std::unique_ptr<OptimizationResult> optResult;
+    std::unique_ptr<AsyncOptimization> asyncRun; // Single-start run in progress
     std::unique_ptr<Visualizer> visualizer;
+    std::unique_ptr<HeightField> heightField;
+    std::unique_ptr<BasinMap> basinMap;
 
     // Input cursor position
     int cursorPos;
@@ -57,6 +67,8 @@ private:
         START_X_FIELD,
         START_Y_FIELD,
         LEARNING_RATE_FIELD,
+        STARTS_FIELD,
+        BASINS_FIELD,
         X_MIN_FIELD,
         X_MAX_FIELD,
         Y_MIN_FIELD,
@@ -83,6 +95,7 @@ public:
     static void keyboardCallback(unsigned char key, int x, int y);
     static void specialCallback(int key, int x, int y);
     static void timerCallback(int value);
+    static void progressCallback(int value);
 
 private:
     void display();
@@ -96,6 +109,7 @@ private:
 
     void validateAndProceed();
     void startVisualization();
+    void pollOptimization();
 
     // Helper functions for rendering text
     void drawText(const std::string &text, float x, float y, void *font = GLUT_BITMAP_9_BY_15);
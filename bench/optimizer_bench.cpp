@@ -0,0 +1,140 @@
+// Compares the optimizers on the bundled surfaces and standard test
+// functions: iterations to tolerance, evaluations and wall time per run.
+//
+//     optimizer_bench [--csv]
+
+#include "Surface.h"
+#include "TestFunctions.h"
+#include "PolicyOptimizer.h"
+#include "TrustRegion.h"
+#include "DerivativeFree.h"
+#include "PopulationOptimizer.h"
+#include <chrono>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+struct BenchFunction
+{
+    std::string name;
+    const Surface *surface;
+    double startX, startY;
+    double learningRate; // Tuned for plain gradient descent
+};
+
+struct BenchOptimizer
+{
+    std::string name;
+    std::function<std::unique_ptr<Optimizer>(const Surface *, double)> create;
+};
+
+// Seconds per optimize() call, repeating until the total is measurable
+static double timeRun(Optimizer &optimizer, double x, double y)
+{
+    using Clock = std::chrono::steady_clock;
+    int repeats = 0;
+    auto start = Clock::now();
+    double elapsed = 0;
+    do
+    {
+        optimizer.optimize(x, y);
+        repeats++;
+        elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+    } while (elapsed < 0.02 && repeats < 1000);
+    return elapsed / repeats;
+}
+
+int main(int argc, char **argv)
+{
+    bool csv = argc > 1 && std::strcmp(argv[1], "--csv") == 0;
+
+    const int maxIterations = 100000;
+    const double tolerance = 1e-6;
+
+    Paraboloid paraboloid;
+    SaddleSurface saddle;
+    RosenbrockSurface rosenbrock;
+    HimmelblauSurface himmelblau;
+    BealeSurface beale;
+    BoothSurface booth;
+
+    std::vector<BenchFunction> functions = {
+        {"paraboloid", &paraboloid, 5.0, 5.0, 0.1},
+        {"saddle", &saddle, 1.0, 0.0, 0.1}, // Stationary point at the origin along y = 0
+        {"rosenbrock", &rosenbrock, -1.2, 1.0, 0.001},
+        {"himmelblau", &himmelblau, 0.0, 0.0, 0.01},
+        {"beale", &beale, 1.0, 1.0, 0.01},
+        {"booth", &booth, 0.0, 0.0, 0.05}};
+
+    // Momentum methods share the descent learning rate; the adaptive methods
+    // take steps of about lr per axis, so they get one fixed rate. The
+    // Newton methods start from a unit step (trust radius), the
+    // derivative-free ones from a unit simplex, poll step or population spread.
+    std::vector<BenchOptimizer> optimizers = {
+        {"gradient-descent", [&](const Surface *s, double lr)
+         { return std::unique_ptr<Optimizer>(new GradientDescent(s, lr, maxIterations, tolerance)); }},
+        {"momentum", [&](const Surface *s, double lr)
+         { return std::unique_ptr<Optimizer>(new MomentumOptimizer(s, lr, maxIterations, tolerance)); }},
+        {"nesterov", [&](const Surface *s, double lr)
+         { return std::unique_ptr<Optimizer>(new NesterovOptimizer(s, lr, maxIterations, tolerance)); }},
+        {"rmsprop", [&](const Surface *s, double)
+         { return std::unique_ptr<Optimizer>(new RMSPropOptimizer(s, 0.01, maxIterations, tolerance)); }},
+        {"adam", [&](const Surface *s, double)
+         { return std::unique_ptr<Optimizer>(new AdamOptimizer(s, 0.01, maxIterations, tolerance)); }},
+        {"newton", [&](const Surface *s, double)
+         { return std::unique_ptr<Optimizer>(new NewtonOptimizer(s, 1.0, maxIterations, tolerance)); }},
+        {"trust-region", [&](const Surface *s, double)
+         { return std::unique_ptr<Optimizer>(new TrustRegionNewton(s, 1.0, maxIterations, tolerance)); }},
+        {"nelder-mead", [&](const Surface *s, double)
+         { return std::unique_ptr<Optimizer>(new NelderMead(s, 1.0, maxIterations, tolerance)); }},
+        {"pattern-search", [&](const Surface *s, double)
+         { return std::unique_ptr<Optimizer>(new PatternSearch(s, 1.0, maxIterations, tolerance)); }},
+        {"particle-swarm", [&](const Surface *s, double)
+         { return std::unique_ptr<Optimizer>(new ParticleSwarm(s, 1.0, maxIterations, tolerance)); }},
+        {"diff-evolution", [&](const Surface *s, double)
+         { return std::unique_ptr<Optimizer>(new DifferentialEvolution(s, 1.0, maxIterations, tolerance)); }},
+        {"cma-es", [&](const Surface *s, double)
+         { return std::unique_ptr<Optimizer>(new CMAES(s, 1.0, maxIterations, tolerance)); }}};
+
+    if (csv)
+        std::cout << "function,optimizer,converged,iterations,function_evaluations,gradient_evaluations,"
+                     "hessian_evaluations,final_value,microseconds\n";
+    else
+        std::cout << std::left << std::setw(12) << "function" << std::setw(18) << "optimizer"
+                  << std::right << std::setw(6) << "conv" << std::setw(10) << "iters"
+                  << std::setw(10) << "f evals" << std::setw(14) << "final f"
+                  << std::setw(12) << "us/run" << "\n";
+
+    for (const BenchFunction &function : functions)
+    {
+        for (const BenchOptimizer &entry : optimizers)
+        {
+            std::unique_ptr<Optimizer> optimizer = entry.create(function.surface, function.learningRate);
+            OptimizationResult result = optimizer->optimize(function.startX, function.startY);
+            double micros = 1e6 * timeRun(*optimizer, function.startX, function.startY);
+
+            if (csv)
+            {
+                std::cout << function.name << "," << entry.name << "," << (result.converged ? 1 : 0)
+                          << "," << result.iterations << "," << result.functionEvaluations
+                          << "," << result.gradientEvaluations << "," << result.hessianEvaluations << ","
+                          << std::setprecision(9) << result.minimumValue << ","
+                          << std::setprecision(6) << micros << "\n";
+            }
+            else
+            {
+                std::cout << std::left << std::setw(12) << function.name << std::setw(18) << entry.name
+                          << std::right << std::setw(6) << (result.converged ? "yes" : "no")
+                          << std::setw(10) << result.iterations
+                          << std::setw(10) << result.functionEvaluations
+                          << std::setw(14) << std::scientific << std::setprecision(3) << result.minimumValue
+                          << std::setw(12) << std::fixed << std::setprecision(1) << micros << "\n";
+            }
+        }
+    }
+
+    return 0;
+}
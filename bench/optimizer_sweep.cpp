@@ -0,0 +1,184 @@
+// Hyperparameter sweep: runs every combination of optimizer, learning rate,
+// tolerance, iteration limit and start point on one surface and writes the
+// runs as CSV and/or the binary columnar format.
+//
+//     optimizer_sweep [--function NAME | --equation EXPR]
+//                     [--optimizers a,b,...] [--lr 0.001,0.01] [--tol 1e-6]
+//                     [--iters 1000] [--starts N] [--domain xmin,xmax,ymin,ymax]
+//                     [--samples N] [--seed S] [--csv FILE|-] [--binary FILE]
+
+#include "ParameterSweep.h"
+#include "MultiStartOptimizer.h"
+#include "TestFunctions.h"
+#include "EquationParser.h"
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <vector>
+
+template <typename T, typename Parse>
+static std::vector<T> parseList(const std::string &text, Parse parse)
+{
+    std::vector<T> values;
+    for (const std::string &item : splitList(text))
+        values.push_back(parse(item));
+    if (values.empty())
+        throw std::runtime_error("Empty list: " + text);
+    return values;
+}
+
+// Summary of one setting over all its start points
+struct Setting
+{
+    int runs = 0;
+    int converged = 0;
+    long long evaluations = 0;
+};
+
+int main(int argc, char **argv)
+{
+    try
+    {
+        std::string function = "rosenbrock", equation, csvPath, binaryPath;
+        SweepSpace space;
+        SweepOptions options;
+        int startCount = 16;
+        std::vector<double> domain = {-5, 5, -5, 5};
+
+        for (int i = 1; i < argc; ++i)
+        {
+            std::string arg = argv[i];
+            if (i + 1 >= argc)
+                throw std::runtime_error("Missing value for " + arg);
+            std::string value = argv[++i];
+
+            auto toDouble = [](const std::string &s)
+            { return std::stod(s); };
+            auto toInt = [](const std::string &s)
+            { return std::stoi(s); };
+
+            if (arg == "--function")
+                function = value;
+            else if (arg == "--equation")
+                equation = value;
+            else if (arg == "--optimizers")
+                space.optimizers = splitList(value);
+            else if (arg == "--lr")
+                space.learningRates = parseList<double>(value, toDouble);
+            else if (arg == "--tol")
+                space.tolerances = parseList<double>(value, toDouble);
+            else if (arg == "--iters")
+                space.maxIterations = parseList<int>(value, toInt);
+            else if (arg == "--starts")
+                startCount = std::stoi(value);
+            else if (arg == "--domain")
+                domain = parseList<double>(value, toDouble);
+            else if (arg == "--samples")
+                options.samples = std::stoul(value);
+            else if (arg == "--seed")
+                options.seed = static_cast<unsigned>(std::stoul(value));
+            else if (arg == "--csv")
+                csvPath = value;
+            else if (arg == "--binary")
+                binaryPath = value;
+            else
+                throw std::runtime_error("Unknown option: " + arg);
+        }
+        if (domain.size() != 4)
+            throw std::runtime_error("--domain takes xmin,xmax,ymin,ymax");
+        if (startCount < 1)
+            throw std::runtime_error("--starts must be at least 1");
+
+        std::unique_ptr<Surface> surface;
+        if (!equation.empty())
+        {
+            EquationParser parser(equation);
+            std::string error;
+            if (!parser.validate(error))
+                throw std::runtime_error("Invalid equation: " + error);
+            auto compiled = std::make_shared<CompiledEquation>(parser.compile());
+            surface.reset(new CustomSurface([compiled](double x, double y)
+                                            { return compiled->evaluate(x, y, 0); },
+                                            [compiled](double x, double y)
+                                            { return compiled->evaluateDerivatives(x, y); }));
+        }
+        else
+        {
+            surface = namedSurface(function);
+        }
+
+        space.starts = MultiStartOptimizer::generateStarts(StartPattern::SOBOL, startCount, 1,
+                                                           domain[0], domain[1], domain[2], domain[3]);
+
+        ParameterSweep sweep(surface.get(), space, options);
+        auto wallStart = std::chrono::steady_clock::now();
+        SweepResults results = sweep.run();
+        double wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart).count();
+
+        if (csvPath == "-")
+        {
+            results.writeCsv(std::cout);
+        }
+        else if (!csvPath.empty())
+        {
+            std::ofstream out(csvPath);
+            if (!out)
+                throw std::runtime_error("Cannot write " + csvPath);
+            results.writeCsv(out);
+        }
+        if (!binaryPath.empty())
+            results.writeBinary(binaryPath);
+
+        // Best settings: most converged starts, then fewest evaluations
+        typedef std::tuple<int, double, double, int> Key;
+        std::map<Key, Setting> settings;
+        for (size_t row = 0; row < results.size(); ++row)
+        {
+            Setting &setting = settings[Key(results.optimizer[row], results.learningRate[row],
+                                            results.tolerance[row], results.maxIterations[row])];
+            setting.runs++;
+            setting.converged += results.converged[row];
+            setting.evaluations += results.functionEvaluations[row] + results.gradientEvaluations[row] +
+                                   results.hessianEvaluations[row];
+        }
+        std::vector<std::pair<Key, Setting>> ranked(settings.begin(), settings.end());
+        std::stable_sort(ranked.begin(), ranked.end(), [](const auto &a, const auto &b)
+                         {
+            double rateA = double(a.second.converged) / a.second.runs;
+            double rateB = double(b.second.converged) / b.second.runs;
+            if (rateA != rateB)
+                return rateA > rateB;
+            return double(a.second.evaluations) / a.second.runs < double(b.second.evaluations) / b.second.runs; });
+
+        std::cerr << results.size() << " of " << sweep.combinations() << " combinations in "
+                  << std::fixed << std::setprecision(3) << wallSeconds << " s\n";
+        std::cerr << std::left << std::setw(18) << "optimizer" << std::right << std::setw(12) << "lr"
+                  << std::setw(10) << "tol" << std::setw(10) << "iters" << std::setw(12) << "converged"
+                  << std::setw(14) << "evals/run" << "\n";
+        for (size_t k = 0; k < ranked.size() && k < 10; ++k)
+        {
+            const Key &key = ranked[k].first;
+            const Setting &setting = ranked[k].second;
+            std::cerr << std::left << std::setw(18) << results.optimizerNames[std::get<0>(key)] << std::right
+                      << std::setw(12) << std::defaultfloat << std::get<1>(key)
+                      << std::setw(10) << std::get<2>(key) << std::setw(10) << std::get<3>(key)
+                      << std::setw(7) << setting.converged << " / " << std::setw(2) << setting.runs
+                      << std::setw(14) << std::fixed << std::setprecision(1)
+                      << double(setting.evaluations) / setting.runs << "\n";
+        }
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << "optimizer_sweep: " << e.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,180 @@
+// Compares the headless renderers, SoftwareRenderer (rasterizer) and
+// RayCaster, over grid resolutions and image sizes: milliseconds per frame
+// of an orbit, and the one-off cost of sampling the surface and building
+// the mesh or the pyramid. The rasterizer is skipped for grids whose mesh
+// would exceed --max-mesh-vertices.
+//
+//     render_bench [--function NAME] [--zoom 60] [--resolutions 256,1024,4096,8192]
+//                  [--sizes 320x240,1280x720,3840x2160] [--frames 4]
+//                  [--max-mesh-vertices 17000000] [--csv]
+
+#include "SoftwareRenderer.h"
+#include "RayCaster.h"
+#include "TestFunctions.h"
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using Clock = std::chrono::steady_clock;
+
+static double millisecondsSince(Clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+// Milliseconds per frame over an orbit of the given number of frames
+template <typename RenderFrame>
+static double timeOrbit(RenderSettings settings, int frames, RenderFrame renderFrame)
+{
+    Image image;
+    float rotationY = settings.rotationY;
+    auto start = Clock::now();
+    for (int frame = 0; frame < frames; ++frame)
+    {
+        settings.rotationY = rotationY + 360.0f * frame / frames;
+        renderFrame(settings, image);
+    }
+    return millisecondsSince(start) / frames;
+}
+
+int main(int argc, char **argv)
+{
+    try
+    {
+        std::string function = "himmelblau";
+        std::vector<int> resolutions = {256, 1024, 4096, 8192};
+        std::vector<std::pair<int, int>> sizes = {{320, 240}, {1280, 720}, {3840, 2160}};
+        int frames = 4;
+        double maxMeshVertices = 17e6;
+        float zoom = 60.0f;
+        bool csv = false;
+
+        for (int i = 1; i < argc; ++i)
+        {
+            std::string arg = argv[i];
+            if (arg == "--csv")
+            {
+                csv = true;
+                continue;
+            }
+            if (i + 1 >= argc)
+                throw std::runtime_error("Missing value for " + arg);
+            std::string value = argv[++i];
+
+            if (arg == "--function")
+                function = value;
+            else if (arg == "--zoom")
+                zoom = std::stof(value);
+            else if (arg == "--resolutions")
+            {
+                resolutions.clear();
+                for (const std::string &item : splitList(value))
+                    resolutions.push_back(std::stoi(item));
+            }
+            else if (arg == "--sizes")
+            {
+                sizes.clear();
+                for (const std::string &item : splitList(value))
+                {
+                    size_t x = item.find('x');
+                    if (x == std::string::npos)
+                        throw std::runtime_error("Sizes are WIDTHxHEIGHT: " + item);
+                    sizes.push_back({std::stoi(item.substr(0, x)), std::stoi(item.substr(x + 1))});
+                }
+            }
+            else if (arg == "--frames")
+                frames = std::max(1, std::stoi(value));
+            else if (arg == "--max-mesh-vertices")
+                maxMeshVertices = std::stod(value);
+            else
+                throw std::runtime_error("Unknown option: " + arg);
+        }
+
+        std::unique_ptr<Surface> surface = namedSurface(function);
+        SoftwareRenderer rasterizer;
+        RayCaster rayCaster;
+
+        if (csv)
+            std::cout << "function,resolution,width,height,mesh_ms,raster_ms,pyramid_ms,raycast_ms\n";
+        else
+            std::cout << std::left << std::setw(12) << "grid" << std::setw(12) << "image" << std::right
+                      << std::setw(12) << "mesh ms" << std::setw(12) << "raster ms" << std::setw(14)
+                      << "pyramid ms" << std::setw(12) << "raycast ms" << std::setw(12) << "faster" << "\n";
+
+        for (int resolution : resolutions)
+        {
+            double vertices = (resolution + 1.0) * (resolution + 1.0);
+            bool rasterize = vertices <= maxMeshVertices;
+
+            // Build each structure on its own so only one is in memory
+            GridMeshF mesh;
+            double meshMilliseconds = 0.0;
+            if (rasterize)
+            {
+                auto start = Clock::now();
+                mesh = buildGridMesh(surface->sampleHeightField(-5, 5, -5, 5, resolution, true));
+                meshMilliseconds = millisecondsSince(start);
+            }
+
+            std::vector<double> rasterMilliseconds;
+            for (const auto &size : sizes)
+            {
+                RenderSettings settings;
+                settings.width = size.first;
+                settings.height = size.second;
+                settings.zoom = zoom;
+                rasterMilliseconds.push_back(
+                    rasterize ? timeOrbit(settings, frames, [&](const RenderSettings &frameSettings, Image &image)
+                                          { rasterizer.render(mesh, nullptr, frameSettings, image); })
+                              : 0.0);
+            }
+            mesh = GridMeshF();
+
+            auto start = Clock::now();
+            HeightPyramid pyramid(surface->sampleHeightField(-5, 5, -5, 5, resolution, false));
+            double pyramidMilliseconds = millisecondsSince(start);
+
+            for (size_t s = 0; s < sizes.size(); ++s)
+            {
+                RenderSettings settings;
+                settings.width = sizes[s].first;
+                settings.height = sizes[s].second;
+                settings.zoom = zoom;
+                double rayMilliseconds = timeOrbit(settings, frames, [&](const RenderSettings &frameSettings, Image &image)
+                                                   { rayCaster.render(pyramid, nullptr, frameSettings, image, surface.get()); });
+
+                std::string grid = std::to_string(resolution) + "^2";
+                std::string image = std::to_string(settings.width) + "x" + std::to_string(settings.height);
+                if (csv)
+                {
+                    std::cout << function << "," << resolution << "," << settings.width << "," << settings.height
+                              << "," << meshMilliseconds << "," << rasterMilliseconds[s] << ","
+                              << pyramidMilliseconds << "," << rayMilliseconds << "\n";
+                    continue;
+                }
+
+                std::cout << std::left << std::setw(12) << grid << std::setw(12) << image << std::right
+                          << std::fixed << std::setprecision(1);
+                if (rasterize)
+                    std::cout << std::setw(12) << meshMilliseconds << std::setw(12) << rasterMilliseconds[s];
+                else
+                    std::cout << std::setw(12) << "-" << std::setw(12) << "-";
+                std::cout << std::setw(14) << pyramidMilliseconds << std::setw(12) << rayMilliseconds
+                          << std::setw(12)
+                          << (!rasterize || rayMilliseconds < rasterMilliseconds[s] ? "raycaster" : "rasterizer")
+                          << "\n";
+            }
+        }
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << "render_bench: " << e.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,431 @@
+// Standard test-function suite: every optimizer on the classic 2-D
+// functions, each evaluated natively (analytic derivatives), as a parsed
+// equation with dual-number derivatives, and as a parsed equation with
+// finite differences. Writes one CSV row per run and, given a baseline
+// written by an earlier run, exits with status 1 when a run regressed.
+//
+//     surface_bench [--functions a,b] [--backends a,b] [--optimizers a,b]
+//                   [--csv FILE|-] [--write-baseline FILE] [--baseline FILE]
+//                   [--eval-tolerance 0.05] [--value-tolerance 1e-6]
+//                   [--distance-tolerance 1e-3] [--time-tolerance 0]
+//                   [--min-time 0.01]
+//
+// A run regresses when it no longer converges, needs more evaluations
+// (function + gradient + Hessian) than the baseline by more than the
+// relative eval tolerance, ends further above the global minimum value or
+// further from the nearest global minimum by more than the absolute value
+// and distance tolerances, or, when --time-tolerance is positive, runs
+// slower by more than that fraction. Baseline rows excluded by an explicit
+// --functions, --backends or --optimizers filter are skipped; any other
+// baseline row missing from the run is a regression.
+// Exit status: 0 clean, 1 regressions, 2 bad usage or I/O error.
+
+#include "TestFunctions.h"
+#include "ParameterSweep.h"
+#include "EquationParser.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+struct SuiteFunction
+{
+    std::string name;
+    std::shared_ptr<Surface> native;
+    std::string equation; // Same function in EquationParser syntax
+    double startX, startY;
+    double learningRate;  // Tuned for plain gradient descent
+    double minimumValue;
+    std::vector<std::pair<double, double>> minima; // Global minimizers
+};
+
+struct Run
+{
+    bool converged = false;
+    int iterations = 0;
+    long long functionEvaluations = 0;
+    long long gradientEvaluations = 0;
+    long long hessianEvaluations = 0;
+    double finalValue = 0;
+    double valueError = 0; // finalValue - global minimum value
+    double distance = 0;   // To the nearest global minimizer
+    double micros = 0;
+
+    long long evaluations() const { return functionEvaluations + gradientEvaluations + hessianEvaluations; }
+};
+
+// function, backend, optimizer
+typedef std::tuple<std::string, std::string, std::string> RunKey;
+
+static const char *PI = "3.141592653589793";
+
+static std::vector<SuiteFunction> suite()
+{
+    std::string twoPi = std::string("2*") + PI;
+    return {
+        {"rosenbrock", std::make_shared<RosenbrockSurface>(), "(1 - x)^2 + 100*(y - x^2)^2",
+         -1.2, 1.0, 0.001, 0.0, {{1, 1}}},
+        {"himmelblau", std::make_shared<HimmelblauSurface>(), "(x^2 + y - 11)^2 + (x + y^2 - 7)^2",
+         0.0, 0.0, 0.01, 0.0,
+         {{3, 2}, {-2.805118086952745, 3.131312518250573}, {-3.779310253377747, -3.283185991286170},
+          {3.584428340330492, -1.848126526964404}}},
+        {"rastrigin", std::make_shared<RastriginSurface>(),
+         "20 + x^2 - 10*cos(" + twoPi + "*x) + y^2 - 10*cos(" + twoPi + "*y)",
+         3.0, 3.0, 0.001, 0.0, {{0, 0}}},
+        {"ackley", std::make_shared<AckleySurface>(),
+         "-20*exp(-0.2*sqrt(0.5*(x^2 + y^2))) - exp(0.5*(cos(" + twoPi + "*x) + cos(" + twoPi +
+             "*y))) + 2.718281828459045 + 20",
+         2.5, 2.5, 0.01, 0.0, {{0, 0}}},
+        {"beale", std::make_shared<BealeSurface>(),
+         "(1.5 - x + x*y)^2 + (2.25 - x + x*y^2)^2 + (2.625 - x + x*y^3)^2",
+         1.0, 1.0, 0.01, 0.0, {{3, 0.5}}},
+        {"booth", std::make_shared<BoothSurface>(), "(x + 2*y - 7)^2 + (2*x + y - 5)^2",
+         0.0, 0.0, 0.05, 0.0, {{1, 3}}},
+        {"six-hump-camel", std::make_shared<SixHumpCamelSurface>(),
+         "(4 - 2.1*x^2 + x^4/3)*x^2 + x*y + (4*y^2 - 4)*y^2",
+         -1.5, 1.0, 0.01, -1.031628453489877,
+         {{0.08984201368301331, -0.7126564032704135}, {-0.08984201368301331, 0.7126564032704135}}}};
+}
+
+static const std::vector<std::string> &backendNames()
+{
+    static const std::vector<std::string> names = {"native", "parsed", "parsed-fd"};
+    return names;
+}
+
+static std::shared_ptr<Surface> createBackend(const SuiteFunction &function, const std::string &backend)
+{
+    if (backend == "native")
+        return function.native;
+
+    EquationParser parser(function.equation);
+    auto compiled = std::make_shared<CompiledEquation>(parser.compile());
+    auto value = [compiled](double x, double y)
+    { return compiled->evaluate(x, y, 0); };
+    if (backend == "parsed")
+        return std::make_shared<CustomSurface>(value, [compiled](double x, double y)
+                                               { return compiled->evaluateDerivatives(x, y); });
+    if (backend == "parsed-fd")
+        return std::make_shared<CustomSurface>(value);
+    throw std::runtime_error("Unknown backend: " + backend);
+}
+
+// Momentum methods share the descent learning rate; the adaptive methods
+// take steps of about lr per axis, so they get one fixed rate. The others
+// start from a unit step, trust radius, simplex, poll step or spread.
+static double learningRateFor(const std::string &optimizer, const SuiteFunction &function)
+{
+    if (optimizer == "gradient-descent" || optimizer == "momentum" || optimizer == "nesterov")
+        return function.learningRate;
+    if (optimizer == "rmsprop" || optimizer == "adam")
+        return 0.01;
+    return 1.0;
+}
+
+static std::vector<std::string> select(const std::string &option, const std::vector<std::string> &known,
+                                       const std::string &what)
+{
+    if (option.empty())
+        return known;
+    std::vector<std::string> chosen = splitList(option);
+    for (const std::string &name : chosen)
+        if (std::find(known.begin(), known.end(), name) == known.end())
+            throw std::runtime_error("Unknown " + what + ": " + name);
+    return chosen;
+}
+
+static Run measure(Optimizer &optimizer, const SuiteFunction &function, double minSeconds)
+{
+    OptimizationResult result = optimizer.optimize(function.startX, function.startY);
+
+    Run run;
+    run.converged = result.converged;
+    run.iterations = result.iterations;
+    run.functionEvaluations = result.functionEvaluations;
+    run.gradientEvaluations = result.gradientEvaluations;
+    run.hessianEvaluations = result.hessianEvaluations;
+    run.finalValue = result.minimumValue;
+    run.valueError = result.minimumValue - function.minimumValue;
+    run.distance = INFINITY;
+    for (const auto &minimum : function.minima)
+        run.distance = std::min(run.distance, std::hypot(result.minimumPoint.getX() - minimum.first,
+                                                         result.minimumPoint.getY() - minimum.second));
+
+    // Microseconds per run, repeating until the total is measurable
+    using Clock = std::chrono::steady_clock;
+    int repeats = 0;
+    double elapsed = 0;
+    auto start = Clock::now();
+    do
+    {
+        optimizer.optimize(function.startX, function.startY);
+        repeats++;
+        elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+    } while (elapsed < minSeconds && repeats < 1000);
+    run.micros = 1e6 * elapsed / repeats;
+    return run;
+}
+
+static void writeCsv(std::ostream &out, const std::vector<std::pair<RunKey, Run>> &runs)
+{
+    out << "function,backend,optimizer,converged,iterations,function_evaluations,gradient_evaluations,"
+           "hessian_evaluations,final_value,value_error,distance,microseconds\n";
+    for (const auto &entry : runs)
+    {
+        const Run &run = entry.second;
+        out << std::get<0>(entry.first) << "," << std::get<1>(entry.first) << "," << std::get<2>(entry.first)
+            << "," << (run.converged ? 1 : 0) << "," << run.iterations << "," << run.functionEvaluations
+            << "," << run.gradientEvaluations << "," << run.hessianEvaluations
+            << std::setprecision(12) << "," << run.finalValue << "," << run.valueError << "," << run.distance
+            << std::setprecision(6) << "," << run.micros << "\n";
+    }
+}
+
+// Reads a CSV written by writeCsv; columns are found by header name
+static std::map<RunKey, Run> readBaseline(const std::string &path)
+{
+    std::ifstream in(path);
+    if (!in)
+        throw std::runtime_error("Cannot open baseline: " + path);
+
+    auto split = [](const std::string &line)
+    {
+        std::vector<std::string> cells;
+        std::stringstream stream(line);
+        std::string cell;
+        while (std::getline(stream, cell, ','))
+            cells.push_back(cell);
+        return cells;
+    };
+
+    std::string line;
+    if (!std::getline(in, line))
+        throw std::runtime_error("Empty baseline: " + path);
+    std::vector<std::string> header = split(line);
+    auto column = [&](const std::string &name)
+    {
+        auto it = std::find(header.begin(), header.end(), name);
+        if (it == header.end())
+            throw std::runtime_error("Baseline " + path + " has no column " + name);
+        return static_cast<size_t>(it - header.begin());
+    };
+    size_t function = column("function"), backend = column("backend"), optimizer = column("optimizer");
+    size_t converged = column("converged"), iterations = column("iterations");
+    size_t fEvals = column("function_evaluations"), gEvals = column("gradient_evaluations");
+    size_t hEvals = column("hessian_evaluations"), finalValue = column("final_value");
+    size_t valueError = column("value_error"), distance = column("distance"), micros = column("microseconds");
+
+    std::map<RunKey, Run> runs;
+    for (int number = 2; std::getline(in, line); ++number)
+    {
+        if (line.empty())
+            continue;
+        std::vector<std::string> cells = split(line);
+        if (cells.size() != header.size())
+            throw std::runtime_error("Malformed baseline line " + std::to_string(number) + ": " + path);
+
+        Run run;
+        run.converged = cells[converged] == "1";
+        run.iterations = std::stoi(cells[iterations]);
+        run.functionEvaluations = std::stoll(cells[fEvals]);
+        run.gradientEvaluations = std::stoll(cells[gEvals]);
+        run.hessianEvaluations = std::stoll(cells[hEvals]);
+        run.finalValue = std::stod(cells[finalValue]);
+        run.valueError = std::stod(cells[valueError]);
+        run.distance = std::stod(cells[distance]);
+        run.micros = std::stod(cells[micros]);
+        runs[RunKey(cells[function], cells[backend], cells[optimizer])] = run;
+    }
+    return runs;
+}
+
+struct Tolerances
+{
+    double evaluations = 0.05; // Relative
+    double value = 1e-6;       // Absolute, on value_error
+    double distance = 1e-3;    // Absolute
+    double time = 0;           // Relative; 0 skips the timing check
+};
+
+// Reasons the run is worse than the baseline; empty when it is not
+static std::vector<std::string> compare(const Run &run, const Run &base, const Tolerances &tolerances)
+{
+    std::vector<std::string> reasons;
+    std::ostringstream text;
+    if (base.converged && !run.converged)
+        reasons.push_back("no longer converges");
+    if (run.evaluations() > base.evaluations() * (1 + tolerances.evaluations) + 1)
+        reasons.push_back("evaluations " + std::to_string(base.evaluations()) + " -> " +
+                          std::to_string(run.evaluations()));
+    // NaN in the run counts as worse; NaN in the baseline never compares
+    if (!(run.valueError <= base.valueError + tolerances.value) && !std::isnan(base.valueError))
+    {
+        text.str("");
+        text << "value error " << base.valueError << " -> " << run.valueError;
+        reasons.push_back(text.str());
+    }
+    if (!(run.distance <= base.distance + tolerances.distance) && !std::isnan(base.distance))
+    {
+        text.str("");
+        text << "distance " << base.distance << " -> " << run.distance;
+        reasons.push_back(text.str());
+    }
+    if (tolerances.time > 0 && run.micros > base.micros * (1 + tolerances.time))
+    {
+        text.str("");
+        text << std::fixed << std::setprecision(1) << "time " << base.micros << " us -> " << run.micros << " us";
+        reasons.push_back(text.str());
+    }
+    return reasons;
+}
+
+int main(int argc, char **argv)
+{
+    std::string functionOption, backendOption, optimizerOption, csvPath = "-", baselinePath, writeBaselinePath;
+    Tolerances tolerances;
+    double minSeconds = 0.01;
+
+    std::vector<std::pair<RunKey, Run>> runs;
+    std::map<RunKey, Run> baseline;
+    std::vector<std::string> functionNames, backends, optimizers;
+    std::vector<SuiteFunction> functions = suite();
+
+    try
+    {
+        for (int i = 1; i < argc; ++i)
+        {
+            std::string arg = argv[i];
+            if (i + 1 >= argc)
+                throw std::runtime_error("Missing value for " + arg);
+            std::string value = argv[++i];
+
+            if (arg == "--functions")
+                functionOption = value;
+            else if (arg == "--backends")
+                backendOption = value;
+            else if (arg == "--optimizers")
+                optimizerOption = value;
+            else if (arg == "--csv")
+                csvPath = value;
+            else if (arg == "--baseline")
+                baselinePath = value;
+            else if (arg == "--write-baseline")
+                writeBaselinePath = value;
+            else if (arg == "--eval-tolerance")
+                tolerances.evaluations = std::stod(value);
+            else if (arg == "--value-tolerance")
+                tolerances.value = std::stod(value);
+            else if (arg == "--distance-tolerance")
+                tolerances.distance = std::stod(value);
+            else if (arg == "--time-tolerance")
+                tolerances.time = std::stod(value);
+            else if (arg == "--min-time")
+                minSeconds = std::stod(value);
+            else
+                throw std::runtime_error("Unknown option: " + arg);
+        }
+
+        std::vector<std::string> knownFunctions;
+        for (const SuiteFunction &function : functions)
+            knownFunctions.push_back(function.name);
+        functionNames = select(functionOption, knownFunctions, "function");
+        backends = select(backendOption, backendNames(), "backend");
+        optimizers = select(optimizerOption, ParameterSweep::optimizerNames(), "optimizer");
+
+        // Read it first so a bad path fails before the suite runs
+        if (!baselinePath.empty())
+            baseline = readBaseline(baselinePath);
+
+        const int maxIterations = 100000;
+        const double tolerance = 1e-6;
+        for (const SuiteFunction &function : functions)
+        {
+            if (std::find(functionNames.begin(), functionNames.end(), function.name) == functionNames.end())
+                continue;
+            for (const std::string &backend : backends)
+            {
+                std::shared_ptr<Surface> surface = createBackend(function, backend);
+                for (const std::string &name : optimizers)
+                {
+                    std::unique_ptr<Optimizer> optimizer = ParameterSweep::createOptimizer(
+                        name, surface.get(), learningRateFor(name, function), maxIterations, tolerance);
+                    optimizer->setPathRecording(PathRecording::none());
+                    runs.emplace_back(RunKey(function.name, backend, name), measure(*optimizer, function, minSeconds));
+                }
+            }
+        }
+
+        if (csvPath == "-")
+        {
+            writeCsv(std::cout, runs);
+        }
+        else
+        {
+            std::ofstream out(csvPath);
+            if (!out)
+                throw std::runtime_error("Cannot write " + csvPath);
+            writeCsv(out, runs);
+        }
+        if (!writeBaselinePath.empty())
+        {
+            std::ofstream out(writeBaselinePath);
+            if (!out)
+                throw std::runtime_error("Cannot write " + writeBaselinePath);
+            writeCsv(out, runs);
+        }
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << "surface_bench: " << e.what() << std::endl;
+        return 2;
+    }
+
+    if (baselinePath.empty())
+        return 0;
+
+    std::set<RunKey> ran;
+    int regressions = 0;
+    for (const auto &entry : runs)
+    {
+        ran.insert(entry.first);
+        auto base = baseline.find(entry.first);
+        if (base == baseline.end())
+            continue; // New run, nothing to compare against
+        for (const std::string &reason : compare(entry.second, base->second, tolerances))
+        {
+            std::cerr << "REGRESSION " << std::get<0>(entry.first) << " / " << std::get<1>(entry.first)
+                      << " / " << std::get<2>(entry.first) << ": " << reason << "\n";
+            regressions++;
+        }
+    }
+    for (const auto &entry : baseline)
+    {
+        const RunKey &key = entry.first;
+        // Only an explicit filter excuses a baseline row; without one, every
+        // row must still exist (a dropped function or optimizer fails)
+        bool selected = (functionOption.empty() || std::count(functionNames.begin(), functionNames.end(), std::get<0>(key))) &&
+                        (backendOption.empty() || std::count(backends.begin(), backends.end(), std::get<1>(key))) &&
+                        (optimizerOption.empty() || std::count(optimizers.begin(), optimizers.end(), std::get<2>(key)));
+        if (selected && !ran.count(key))
+        {
+            std::cerr << "REGRESSION " << std::get<0>(key) << " / " << std::get<1>(key) << " / "
+                      << std::get<2>(key) << ": missing from this run\n";
+            regressions++;
+        }
+    }
+
+    std::cerr << runs.size() << " runs compared with " << baselinePath << ": " << regressions
+              << (regressions == 1 ? " regression" : " regressions") << std::endl;
+    return regressions > 0 ? 1 : 0;
+}
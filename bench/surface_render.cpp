@@ -0,0 +1,191 @@
+// Headless rendering: draws a surface, and optionally an optimizer's path,
+// with the software rasterizer or the ray caster and writes a PNG or PPM.
+// Needs no display or GPU. With --frames N it renders N frames orbiting the
+// surface and reports the frame rate.
+//
+//     surface_render [--function NAME | --equation EXPR]
+//                    [--renderer rasterizer|raycaster]
+//                    [--domain xmin,xmax,ymin,ymax] [--resolution 100]
+//                    [--size 800x600] [--rotation-x 30] [--rotation-y 45]
+//                    [--zoom 30] [--axes 1] [--optimizer NAME] [--lr 0.01]
+//                    [--start x,y] [--frames N] [--output FILE]
+
+#include "SoftwareRenderer.h"
+#include "RayCaster.h"
+#include "ParameterSweep.h"
+#include "TestFunctions.h"
+#include "EquationParser.h"
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+static std::vector<double> parseNumbers(const std::string &text, char separator)
+{
+    std::vector<double> values;
+    std::stringstream stream(text);
+    std::string item;
+    while (std::getline(stream, item, separator))
+        values.push_back(std::stod(item));
+    return values;
+}
+
+int main(int argc, char **argv)
+{
+    try
+    {
+        std::string function = "paraboloid", equation, optimizerName, output;
+        std::string rendererName = "rasterizer";
+        std::vector<double> domain = {-5, 5, -5, 5};
+        std::vector<double> start;
+        int resolution = 100, frames = 0;
+        double learningRate = 0.01;
+        RenderSettings settings;
+
+        for (int i = 1; i < argc; ++i)
+        {
+            std::string arg = argv[i];
+            if (i + 1 >= argc)
+                throw std::runtime_error("Missing value for " + arg);
+            std::string value = argv[++i];
+
+            if (arg == "--function")
+                function = value;
+            else if (arg == "--equation")
+                equation = value;
+            else if (arg == "--renderer")
+                rendererName = value;
+            else if (arg == "--domain")
+                domain = parseNumbers(value, ',');
+            else if (arg == "--resolution")
+                resolution = std::stoi(value);
+            else if (arg == "--size")
+            {
+                std::vector<double> size = parseNumbers(value, 'x');
+                if (size.size() != 2)
+                    throw std::runtime_error("--size takes WIDTHxHEIGHT");
+                settings.width = static_cast<int>(size[0]);
+                settings.height = static_cast<int>(size[1]);
+            }
+            else if (arg == "--rotation-x")
+                settings.rotationX = std::stof(value);
+            else if (arg == "--rotation-y")
+                settings.rotationY = std::stof(value);
+            else if (arg == "--zoom")
+                settings.zoom = std::stof(value);
+            else if (arg == "--axes")
+                settings.drawAxes = std::stoi(value) != 0;
+            else if (arg == "--optimizer")
+                optimizerName = value;
+            else if (arg == "--lr")
+                learningRate = std::stod(value);
+            else if (arg == "--start")
+                start = parseNumbers(value, ',');
+            else if (arg == "--frames")
+                frames = std::stoi(value);
+            else if (arg == "--output")
+                output = value;
+            else
+                throw std::runtime_error("Unknown option: " + arg);
+        }
+        if (domain.size() != 4)
+            throw std::runtime_error("--domain takes xmin,xmax,ymin,ymax");
+        if (!start.empty() && start.size() != 2)
+            throw std::runtime_error("--start takes x,y");
+        if (resolution < 1)
+            throw std::runtime_error("--resolution must be at least 1");
+        if (rendererName != "rasterizer" && rendererName != "raycaster")
+            throw std::runtime_error("Unknown renderer: " + rendererName);
+
+        std::unique_ptr<Surface> surface;
+        if (!equation.empty())
+        {
+            EquationParser parser(equation);
+            std::string error;
+            if (!parser.validate(error))
+                throw std::runtime_error("Invalid equation: " + error);
+            auto compiled = std::make_shared<CompiledEquation>(parser.compile());
+            surface.reset(new CustomSurface([compiled](double x, double y)
+                                            { return compiled->evaluate(x, y, 0); },
+                                            [compiled](double x, double y)
+                                            { return compiled->evaluateDerivatives(x, y); }));
+        }
+        else
+        {
+            surface = namedSurface(function);
+        }
+
+        // The rasterizer draws a mesh with stored normals; the ray caster
+        // walks a pyramid of the heights and takes normals from the surface
+        bool rayCast = rendererName == "raycaster";
+        HeightField field = surface->sampleHeightField(domain[0], domain[1], domain[2], domain[3],
+                                                       resolution, !rayCast);
+        GridMeshF mesh;
+        HeightPyramid pyramid;
+        if (rayCast)
+            pyramid = HeightPyramid(field);
+        else
+            mesh = buildGridMesh(field);
+        field = HeightField();
+
+        // The path starts from the centre of the domain unless --start is given
+        OptimizationResult result;
+        if (!optimizerName.empty())
+        {
+            if (start.empty())
+                start = {0.5 * (domain[0] + domain[1]), 0.5 * (domain[2] + domain[3])};
+            std::unique_ptr<Optimizer> optimizer =
+                ParameterSweep::createOptimizer(optimizerName, surface.get(), learningRate, 1000, 1e-6);
+            result = optimizer->optimize(start[0], start[1]);
+            std::cerr << optimizerName << ": " << result.iterations << " iterations, minimum "
+                      << result.minimumValue << (result.converged ? "" : " (not converged)") << "\n";
+        }
+        const OptimizationResult *path = optimizerName.empty() ? nullptr : &result;
+
+        SoftwareRenderer rasterizer;
+        RayCaster rayCaster;
+        auto renderFrame = [&](Image &image)
+        {
+            if (rayCast)
+                rayCaster.render(pyramid, path, settings, image, surface.get());
+            else
+                rasterizer.render(mesh, path, settings, image);
+        };
+
+        Image image;
+        if (frames > 0)
+        {
+            // Orbit once around the surface
+            float rotationY = settings.rotationY;
+            auto begin = std::chrono::steady_clock::now();
+            for (int frame = 0; frame < frames; ++frame)
+            {
+                settings.rotationY = rotationY + 360.0f * frame / frames;
+                renderFrame(image);
+            }
+            double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+            std::cerr << rendererName << ", " << frames << " frames of " << settings.width << "x"
+                      << settings.height << ", " << resolution << "^2 grid: " << std::fixed << std::setprecision(3)
+                      << 1000.0 * seconds / frames << " ms/frame, " << std::setprecision(1)
+                      << frames / seconds << " frames/s\n";
+        }
+        else
+        {
+            renderFrame(image);
+        }
+
+        if (!output.empty())
+            writeImage(image, output);
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << "surface_render: " << e.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
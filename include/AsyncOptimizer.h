@@ -0,0 +1,91 @@
+#ifndef ASYNC_OPTIMIZER_H
+#define ASYNC_OPTIMIZER_H
+
+#include "Optimizer.h"
+#include "SpscQueue.h"
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <thread>
+
+// Limits of one run; 0 means unlimited
+struct OptimizationBudget
+{
+    double seconds = 0;        // Wall-clock time
+    long long evaluations = 0; // Function, gradient and Hessian calls together
+};
+
+// Shared between a running optimizer and its observer. The optimizer
+// publishes every iterate (Optimizer::keepGoing) and learns whether to stop;
+// the observer reads progress and may cancel from any thread. Iterates go
+// through a lock-free single-producer queue; when the observer falls behind
+// they are dropped and counted rather than stalling the optimizer.
+class OptimizationMonitor : public IterationObserver
+{
+private:
+    std::atomic<bool> cancelled;
+    OptimizationBudget budget;
+    std::chrono::steady_clock::time_point startTime;
+    SpscQueue<Point3D> points;
+
+    std::atomic<long long> iterations;
+    std::atomic<long long> evaluations;
+    std::atomic<long long> droppedPoints;
+
+public:
+    explicit OptimizationMonitor(const OptimizationBudget &budget = OptimizationBudget(),
+                                 size_t queueCapacity = 4096);
+
+    // Restart the clock and counters for a new run
+    void start();
+
+    void cancel() { cancelled.store(true, std::memory_order_relaxed); }
+    bool isCancelled() const { return cancelled.load(std::memory_order_relaxed); }
+
+    // Optimizer thread: record an iterate; returns why the run must stop,
+    // or StopReason::NONE to continue
+    StopReason publish(double x, double y, double z, long long evaluationsSoFar) override;
+
+    // Observer thread
+    bool popPoint(Point3D &point) { return points.pop(point); }
+    long long getIterations() const { return iterations.load(std::memory_order_relaxed); }
+    long long getEvaluations() const { return evaluations.load(std::memory_order_relaxed); }
+    long long getDroppedPoints() const { return droppedPoints.load(std::memory_order_relaxed); }
+    double elapsedSeconds() const;
+};
+
+// Runs one optimize() call on a worker thread. The caller polls finished()
+// (e.g. from a GLUT timer), drains path points as they arrive and takes the
+// full result at the end. Destroying a running job cancels and joins it.
+class AsyncOptimization
+{
+private:
+    std::unique_ptr<Optimizer> optimizer;
+    OptimizationMonitor monitor;
+    OptimizationResult result;
+    std::atomic<bool> done;
+    std::thread worker;
+
+public:
+    AsyncOptimization(std::unique_ptr<Optimizer> optimizer, double startX, double startY,
+                      const OptimizationBudget &budget = OptimizationBudget(),
+                      size_t queueCapacity = 4096);
+    ~AsyncOptimization();
+
+    AsyncOptimization(const AsyncOptimization &) = delete;
+    AsyncOptimization &operator=(const AsyncOptimization &) = delete;
+
+    // Cancellation token: the optimizer stops at its next iteration
+    void cancel() { monitor.cancel(); }
+    bool finished() const { return done.load(std::memory_order_acquire); }
+
+    // Move the points published since the last call to the end of path
+    size_t drainPath(std::vector<Point3D> &path);
+
+    const OptimizationMonitor &getMonitor() const { return monitor; }
+
+    // Waits for the worker; the path is the optimizer's own full recording
+    const OptimizationResult &wait();
+};
+
+#endif
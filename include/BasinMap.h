@@ -0,0 +1,67 @@
+#ifndef BASIN_MAP_H
+#define BASIN_MAP_H
+
+#include "MultiStartOptimizer.h"
+#include <vector>
+
+struct BasinMapOptions
+{
+    int resolution = 256;         // Grid vertices per side
+    double mergeTolerance = 1e-3; // Converged points closer than this are one minimum
+    bool earlyTermination = true; // Stop trajectories on already labelled cells
+    ThreadPool *pool = nullptr;   // Defaults to ThreadPool::shared()
+};
+
+// Which minimum the optimizer reaches from every vertex of a grid
+struct BasinMap
+{
+    static constexpr int NO_MINIMUM = -1; // Did not converge (or diverged)
+
+    int resolution = 0;
+    double xMin = 0, xMax = 0, yMin = 0, yMax = 0;
+
+    // Row-major, resolution x resolution, vertex (i, j) at index j * resolution + i
+    std::vector<int> labels;     // Index into minima or NO_MINIMUM
+    std::vector<int> iterations; // Iterations from the vertex to its minimum
+
+    std::vector<LocalMinimum> minima; // Ranked by value; hits counts cells, bestRun is a cell
+
+    long long iterationsRun = 0; // Iterations actually executed
+    size_t absorbedCells = 0;    // Trajectories stopped on a labelled cell
+    double wallSeconds = 0;
+
+    double xAt(int i) const { return xMin + i * (xMax - xMin) / (resolution - 1); }
+    double yAt(int j) const { return yMin + j * (yMax - yMin) / (resolution - 1); }
+
+    int label(int i, int j) const { return labels[static_cast<size_t>(j) * resolution + i]; }
+
+    // Vertex nearest to (x, y); false outside the grid
+    bool cellAt(double x, double y, int &i, int &j) const;
+
+    // Label and iteration count of the nearest vertex; NO_MINIMUM and 0 outside
+    int labelAt(double x, double y) const;
+    int iterationsAt(double x, double y) const;
+};
+
+// Runs an optimizer from every grid vertex and labels each with the minimum
+// it converges to. Vertices are visited coarse to fine: a pass covers the
+// vertices on a grid of half the previous spacing, and a trajectory that
+// enters the cell of a vertex finished in an earlier pass stops there and
+// takes over its label. Only earlier passes are consulted, so the map does
+// not depend on the thread count. Basin boundaries are resolved to about
+// one cell.
+class BasinMapper
+{
+private:
+    const Surface *surface;
+    MultiStartOptimizer::OptimizerFactory factory;
+    BasinMapOptions options;
+
+public:
+    BasinMapper(const Surface *surf, MultiStartOptimizer::OptimizerFactory factory,
+                const BasinMapOptions &options = BasinMapOptions());
+
+    BasinMap compute(double xMin, double xMax, double yMin, double yMax) const;
+};
+
+#endif
@@ -0,0 +1,54 @@
+#ifndef BATCH_GRADIENT_DESCENT_H
+#define BATCH_GRADIENT_DESCENT_H
+
+#include "Optimizer.h"
+#include <vector>
+
+struct BatchOptimizationResult
+{
+    std::vector<OptimizationResult> runs; // Indexed like the start points
+
+    long long packedSteps; // Calls to the batch evaluate/gradient path
+    long long laneSteps;   // Descent iterations summed over all lanes
+    double seconds;
+
+    double descentsPerSecond() const { return seconds > 0 ? runs.size() / seconds : 0.0; }
+
+    // Average fraction of the lanes doing useful work per packed step
+    double laneUtilization(int lanes) const
+    {
+        return packedSteps > 0 ? static_cast<double>(laneSteps) / (packedSteps * lanes) : 0.0;
+    }
+};
+
+// Gradient descent over packs of start points in lockstep. Each step makes
+// one evaluateBatch and one gradientBatch call for all live lanes, so
+// surfaces with vectorized batch overrides fill the SIMD registers. Lanes
+// that converge or run out of iterations are retired and refilled with the
+// next start; live lanes stay packed at the front. Every lane follows the
+// same arithmetic as GradientDescent::optimize, so runs match it exactly.
+class BatchGradientDescent
+{
+public:
+    static const int MAX_LANES = 16;
+
+private:
+    const Surface *surface;
+    double learningRate;
+    int maxIterations;
+    double tolerance;
+    int lanes;
+    PathRecording pathRecording;
+
+public:
+    BatchGradientDescent(const Surface *surf, double lr = 0.1,
+                         int maxIter = 1000, double tol = 1e-6, int lanes = 8);
+
+    // Paths cost memory per step; use PathRecording::none() for throughput runs
+    void setPathRecording(const PathRecording &recording) { pathRecording = recording; }
+    int getLanes() const { return lanes; }
+
+    BatchOptimizationResult optimize(const std::vector<Point3D> &starts) const;
+};
+
+#endif
@@ -0,0 +1,47 @@
+#ifndef BYTE_ORDER_H
+#define BYTE_ORDER_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+// Byte-order helpers for the binary file formats
+
+inline bool hostIsLittleEndian()
+{
+    const uint16_t probe = 1;
+    uint8_t first;
+    std::memcpy(&first, &probe, 1);
+    return first == 1;
+}
+
+// Value with its bytes reversed (integers and floating point alike)
+template <typename T>
+T byteSwapped(T value)
+{
+    unsigned char bytes[sizeof(T)];
+    std::memcpy(bytes, &value, sizeof(T));
+    std::reverse(bytes, bytes + sizeof(T));
+    std::memcpy(&value, bytes, sizeof(T));
+    return value;
+}
+
+// Convert between host and little-endian order; the same swap serves both
+// directions, and it is a no-op on little-endian hosts
+template <typename T>
+T littleEndian(T value)
+{
+    return hostIsLittleEndian() ? value : byteSwapped(value);
+}
+
+template <typename T>
+void littleEndianArray(T *values, size_t count)
+{
+    if (hostIsLittleEndian())
+        return;
+    for (size_t k = 0; k < count; ++k)
+        values[k] = byteSwapped(values[k]);
+}
+
+#endif
@@ -0,0 +1,39 @@
+#ifndef DERIVATIVE_FREE_H
+#define DERIVATIVE_FREE_H
+
+#include "Optimizer.h"
+
+// Optimizers that only evaluate the surface. They suit non-smooth equations
+// (abs, floor, ceil, %), where finite-difference gradients are meaningless
+// and gradient methods waste their evaluations. Both stop once their search
+// pattern has shrunk below the tolerance, measured in x and y, and report
+// gradientEvaluations = 0.
+
+// Nelder-Mead simplex: reflect, expand, contract or shrink a triangle of
+// points. The path records the best vertex after each iteration.
+class NelderMead : public Optimizer
+{
+public:
+    // lr is the edge length of the initial simplex
+    NelderMead(const Surface *surf, double lr = 1.0,
+               int maxIter = 1000, double tol = 1e-6);
+
+    OptimizationResult optimize(double startX, double startY) override;
+};
+
+// Compass (pattern) search: poll the four axis neighbours at the current
+// step and move to the first one that improves; halve the step when none
+// does. Needs no gradients and copes with mildly non-smooth surfaces; it
+// is only guaranteed to reach a stationary point on smooth ones, and can
+// stall at a kink.
+class PatternSearch : public Optimizer
+{
+public:
+    // lr is the initial step
+    PatternSearch(const Surface *surf, double lr = 1.0,
+                  int maxIter = 1000, double tol = 1e-6);
+
+    OptimizationResult optimize(double startX, double startY) override;
+};
+
+#endif
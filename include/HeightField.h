@@ -0,0 +1,88 @@
+#ifndef HEIGHT_FIELD_H
+#define HEIGHT_FIELD_H
+
+#include <cstddef>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+// Heights (and optionally unit normals) sampled on a regular grid.
+// Sample (i, j) lies at x = xMin + i * xStep, y = yMin + j * yStep and is
+// stored row-major at index j * columns + i; normals are packed xyz triples.
+// The samples are either owned or borrowed from a memory-mapped file; copies
+// share the same samples. Scalar is float for rendering and previews (half
+// the memory, twice the SIMD width) or double where precision matters.
+template <typename Scalar>
+class HeightFieldT
+{
+private:
+    double xMin, xMax, yMin, yMax;
+    int columns, rows;
+
+    std::shared_ptr<const void> storage; // Keeps the sample memory alive
+    const Scalar *heights;
+    const Scalar *normals;
+
+public:
+    typedef Scalar ScalarType;
+
+    HeightFieldT()
+        : xMin(0), xMax(0), yMin(0), yMax(0), columns(0), rows(0),
+          heights(nullptr), normals(nullptr) {}
+
+    // Allocate zeroed storage for columns x rows samples
+    HeightFieldT(double xMin, double xMax, double yMin, double yMax,
+                 int columns, int rows, bool withNormals = false)
+        : xMin(xMin), xMax(xMax), yMin(yMin), yMax(yMax), columns(columns), rows(rows),
+          heights(nullptr), normals(nullptr)
+    {
+        if (columns < 2 || rows < 2)
+            throw std::runtime_error("Height field needs at least 2x2 samples");
+
+        // Heights and normals share one allocation
+        size_t count = sampleCount();
+        auto samples = std::make_shared<std::vector<Scalar>>(withNormals ? 4 * count : count, Scalar(0));
+        heights = samples->data();
+        normals = withNormals ? samples->data() + count : nullptr;
+        storage = samples;
+    }
+
+    // Borrow samples kept alive by owner (e.g. a MappedFile)
+    HeightFieldT(double xMin, double xMax, double yMin, double yMax,
+                 int columns, int rows, const Scalar *heights, const Scalar *normals,
+                 std::shared_ptr<const void> owner)
+        : xMin(xMin), xMax(xMax), yMin(yMin), yMax(yMax), columns(columns), rows(rows),
+          storage(std::move(owner)), heights(heights), normals(normals) {}
+
+    bool empty() const { return heights == nullptr; }
+    bool hasNormals() const { return normals != nullptr; }
+
+    double getXMin() const { return xMin; }
+    double getXMax() const { return xMax; }
+    double getYMin() const { return yMin; }
+    double getYMax() const { return yMax; }
+    int getColumns() const { return columns; }
+    int getRows() const { return rows; }
+    size_t sampleCount() const { return static_cast<size_t>(columns) * rows; }
+
+    double xStep() const { return (xMax - xMin) / (columns - 1); }
+    double yStep() const { return (yMax - yMin) / (rows - 1); }
+    double xAt(int i) const { return xMin + i * xStep(); }
+    double yAt(int j) const { return yMin + j * yStep(); }
+
+    Scalar height(int i, int j) const { return heights[static_cast<size_t>(j) * columns + i]; }
+    const Scalar *normal(int i, int j) const { return normals + 3 * (static_cast<size_t>(j) * columns + i); }
+
+    const Scalar *getHeights() const { return heights; }
+    const Scalar *getNormals() const { return normals; }
+
+    // Writable access while filling owned storage
+    Scalar *heightData() { return const_cast<Scalar *>(heights); }
+    Scalar *normalData() { return const_cast<Scalar *>(normals); }
+};
+
+// Single precision is the rendering and cache format
+typedef HeightFieldT<float> HeightField;
+typedef HeightFieldT<double> HeightFieldD;
+
+#endif
@@ -0,0 +1,70 @@
+#ifndef HEIGHT_PYRAMID_H
+#define HEIGHT_PYRAMID_H
+
+#include "HeightField.h"
+#include "Point3D.h"
+#include <vector>
+
+class ThreadPool;
+
+// Mip-style min/max/mean pyramid over the cells of a height field.
+// Level 0 cell (i, j) spans samples i..i+1 x j..j+1; each higher level
+// merges 2x2 cells of the one below, so a level-L cell covers up to
+// 2^L x 2^L base cells. The min/max bounds are conservative, which makes
+// the pyramid usable for LOD error estimates, ray picking and range queries.
+class HeightPyramid
+{
+public:
+    struct Level
+    {
+        int columns, rows; // Cells in this level
+        std::vector<float> minHeights;
+        std::vector<float> maxHeights;
+        std::vector<float> meanHeights;
+
+        size_t index(int i, int j) const { return static_cast<size_t>(j) * columns + i; }
+        float minAt(int i, int j) const { return minHeights[index(i, j)]; }
+        float maxAt(int i, int j) const { return maxHeights[index(i, j)]; }
+        float meanAt(int i, int j) const { return meanHeights[index(i, j)]; }
+    };
+
+private:
+    HeightField field;
+    std::vector<Level> levels;
+
+    void buildBaseLevel(ThreadPool &pool);
+    void buildLevel(int level, ThreadPool &pool);
+
+    bool intersectCell(int level, int i, int j, const Point3D &origin,
+                       const Point3D &direction, double &tBest) const;
+    void rangeQueryCell(int level, int i, int j, int i0, int j0, int i1, int j1,
+                        float &low, float &high) const;
+
+public:
+    HeightPyramid();
+
+    // Build all levels in parallel; pool defaults to ThreadPool::shared()
+    explicit HeightPyramid(const HeightField &field, ThreadPool *pool = nullptr);
+
+    bool empty() const { return levels.empty(); }
+    int levelCount() const { return static_cast<int>(levels.size()); }
+    const Level &level(int index) const { return levels[index]; }
+    const HeightField &getField() const { return field; }
+
+    // Largest height range of the level-L cells overlapping base cells
+    // [i0, i1) x [j0, j1); an upper bound on the error of drawing that
+    // region with a vertex stride of 2^L
+    float maxError(int level, int i0, int j0, int i1, int j1) const;
+
+    // Conservative [low, high] height bounds over the rectangle; returns
+    // false if the rectangle misses the field's domain
+    bool rangeQuery(double xMin, double xMax, double yMin, double yMax,
+                    float &low, float &high) const;
+
+    // Nearest intersection of a ray with the triangulated surface;
+    // tHit is in units of direction
+    bool intersectRay(const Point3D &origin, const Point3D &direction,
+                      Point3D &hit, double *tHit = nullptr) const;
+};
+
+#endif
@@ -0,0 +1,33 @@
+#ifndef IMAGE_H
+#define IMAGE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// 8-bit RGB image, rows stored top to bottom, for the headless renderers
+struct Image
+{
+    int width = 0;
+    int height = 0;
+    std::vector<uint8_t> pixels; // width * height RGB triples
+
+    Image() = default;
+    Image(int width, int height) : width(width), height(height), pixels(3 * static_cast<size_t>(width) * height) {}
+
+    uint8_t *pixel(int x, int y) { return pixels.data() + 3 * (static_cast<size_t>(y) * width + x); }
+    const uint8_t *pixel(int x, int y) const { return pixels.data() + 3 * (static_cast<size_t>(y) * width + x); }
+};
+
+// Binary PPM (P6)
+void writePpm(const Image &image, const std::string &path);
+
+// PNG with deflate-compressed scanlines; no external library needed
+void writePng(const Image &image, const std::string &path);
+
+// PNG for a .png extension, PPM otherwise. All writers throw
+// std::runtime_error if the file cannot be written.
+void writeImage(const Image &image, const std::string &path);
+
+#endif
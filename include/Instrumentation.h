@@ -0,0 +1,112 @@
+#ifndef INSTRUMENTATION_H
+#define INSTRUMENTATION_H
+
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+
+// Evaluation counters and phase timers. Every thread adds to its own
+// block, so hot paths never contend; snapshot() sums the blocks of live
+// and finished threads. Built with SURFACE_INSTRUMENTATION=0 (CMake option
+// SURFACE_INSTRUMENTATION=OFF) the macros below expand to nothing and
+// snapshot() reports zeros.
+//
+// Counts are added per run or per batch (Optimizer::recordCounters,
+// Surface::sampleHeights), not per call, so they cost nothing per evaluation.
+
+#ifndef SURFACE_INSTRUMENTATION
+#define SURFACE_INSTRUMENTATION 1
+#endif
+
+namespace instrumentation
+{
+    enum Counter
+    {
+        EVALUATIONS, // Surface values
+        GRADIENTS,
+        HESSIANS,
+        OPTIMIZER_RUNS,
+        COUNTER_COUNT
+    };
+
+    enum Phase
+    {
+        PARSE,    // EquationParser::validate
+        COMPILE,  // EquationParser::compile
+        MESH,     // Height field sampling
+        OPTIMIZE, // Optimizer runs, from resetCounters to recordCounters
+        RENDER,   // Visualizer frames
+        PHASE_COUNT
+    };
+
+    struct PhaseTotal
+    {
+        uint64_t calls = 0;
+        uint64_t nanoseconds = 0;
+
+        double milliseconds() const { return nanoseconds * 1e-6; }
+    };
+
+    struct Stats
+    {
+        uint64_t counters[COUNTER_COUNT] = {};
+        PhaseTotal phases[PHASE_COUNT];
+
+        uint64_t counter(Counter c) const { return counters[c]; }
+        const PhaseTotal &phase(Phase p) const { return phases[p]; }
+    };
+
+    constexpr bool enabled() { return SURFACE_INSTRUMENTATION != 0; }
+
+    const char *counterName(Counter c);
+    const char *phaseName(Phase p);
+
+    // Totals over all threads since start-up or the last reset()
+    Stats snapshot();
+    void reset();
+
+    // Counters and phases with non-zero totals, one per line
+    void print(std::ostream &out, const Stats &stats);
+
+    // Nanoseconds on the steady clock, shared with the tracer (Trace.h)
+    inline uint64_t clockNanoseconds()
+    {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                         std::chrono::steady_clock::now().time_since_epoch())
+                                         .count());
+    }
+
+    // Adds to the calling thread's block. A phase interval also becomes a
+    // trace event while tracing is recording, with value as its argument.
+    void add(Counter c, uint64_t n);
+    void addPhase(Phase p, uint64_t begin, uint64_t end, int64_t value = 0, bool hasValue = false);
+
+    // Adds the lifetime of the scope to a phase
+    class ScopedTimer
+    {
+    private:
+        Phase phase;
+        uint64_t begin;
+
+    public:
+        explicit ScopedTimer(Phase phase) : phase(phase), begin(clockNanoseconds()) {}
+        ~ScopedTimer() { addPhase(phase, begin, clockNanoseconds()); }
+
+        ScopedTimer(const ScopedTimer &) = delete;
+        ScopedTimer &operator=(const ScopedTimer &) = delete;
+    };
+}
+
+#define SURFACE_INSTRUMENT_CONCAT2(a, b) a##b
+#define SURFACE_INSTRUMENT_CONCAT(a, b) SURFACE_INSTRUMENT_CONCAT2(a, b)
+
+#if SURFACE_INSTRUMENTATION
+#define SURFACE_COUNT(counter, n) ::instrumentation::add(::instrumentation::counter, (n))
+#define SURFACE_TIME_SCOPE(phase) \
+    ::instrumentation::ScopedTimer SURFACE_INSTRUMENT_CONCAT(surfaceTimer, __LINE__)(::instrumentation::phase)
+#else
+#define SURFACE_COUNT(counter, n) ((void)0)
+#define SURFACE_TIME_SCOPE(phase) ((void)0)
+#endif
+
+#endif
@@ -0,0 +1,154 @@
+#ifndef LINE_SEARCH_H
+#define LINE_SEARCH_H
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+// N-dimensional objective: returns f(x) and writes the gradient into grad
+// (already sized like x)
+typedef std::function<double(const std::vector<double> &x, std::vector<double> &grad)> ObjectiveFunction;
+
+// Objective as seen by a line search. Value and gradient are separate so
+// searches that only test sufficient decrease skip gradients at rejected
+// trial points.
+class LineObjective
+{
+public:
+    virtual ~LineObjective() {}
+
+    virtual double value(const std::vector<double> &x) = 0;
+    virtual void gradient(const std::vector<double> &x, std::vector<double> &grad) = 0;
+
+    // Override when both come cheaper together
+    virtual double valueAndGradient(const std::vector<double> &x, std::vector<double> &grad)
+    {
+        gradient(x, grad);
+        return value(x);
+    }
+};
+
+// LineObjective over a combined ObjectiveFunction. The gradient of the
+// last evaluated point is kept, so value() followed by gradient() at the
+// same point costs one call.
+class CombinedLineObjective : public LineObjective
+{
+private:
+    ObjectiveFunction objective;
+    std::vector<double> lastX, lastGradient;
+    double lastValue;
+    int calls;
+
+public:
+    explicit CombinedLineObjective(ObjectiveFunction objective)
+        : objective(objective), lastValue(0), calls(0) {}
+
+    double value(const std::vector<double> &x) override;
+    void gradient(const std::vector<double> &x, std::vector<double> &grad) override;
+    double valueAndGradient(const std::vector<double> &x, std::vector<double> &grad) override;
+
+    int getCalls() const { return calls; }
+};
+
+enum class LineSearchMethod
+{
+    FIXED,        // Take the initial step as is (plain fixed learning rate)
+    ARMIJO,       // Backtracking with quadratic/cubic interpolation
+    STRONG_WOLFE, // Bracketing and zoom (Nocedal & Wright 3.5/3.6)
+    MORE_THUENTE  // More & Thuente's safeguarded interval search (MINPACK)
+};
+
+struct LineSearchOptions
+{
+    double c1 = 1e-4;   // Sufficient decrease constant
+    double c2 = 0.9;    // Curvature constant (Wolfe methods)
+    int maxSteps = 30;  // Trial points per search
+    double minStep = 1e-20;
+    double maxStep = 1e20;
+};
+
+// Accepted point of a search. f and, when hasGradient is set, the gradient
+// are ready for the next iteration, so the optimizer does not evaluate
+// them again.
+struct LineSearchPoint
+{
+    double alpha;
+    double f;
+    double slope; // g . d, valid when hasGradient
+    std::vector<double> x;
+    std::vector<double> g;
+    bool hasGradient;
+};
+
+// Chooses a step length along a descent direction d from x, where f and g
+// are the value and gradient at x. Returns false if no acceptable step was
+// found. Implementations are stateless and may be shared between threads.
+class LineSearch
+{
+protected:
+    LineSearchOptions options;
+
+    // x + alpha * d into point.x
+    static void moveTo(const std::vector<double> &x, const std::vector<double> &d,
+                       double alpha, LineSearchPoint &point);
+
+public:
+    explicit LineSearch(const LineSearchOptions &options) : options(options) {}
+    virtual ~LineSearch() {}
+
+    virtual bool search(LineObjective &objective, const std::vector<double> &x,
+                        double f, const std::vector<double> &g,
+                        const std::vector<double> &d, double initialStep,
+                        LineSearchPoint &accepted) const = 0;
+
+    const LineSearchOptions &getOptions() const { return options; }
+
+    static std::shared_ptr<const LineSearch> create(LineSearchMethod method,
+                                                    const LineSearchOptions &options = LineSearchOptions());
+};
+
+class FixedStep : public LineSearch
+{
+public:
+    explicit FixedStep(const LineSearchOptions &options = LineSearchOptions()) : LineSearch(options) {}
+
+    bool search(LineObjective &objective, const std::vector<double> &x,
+                double f, const std::vector<double> &g,
+                const std::vector<double> &d, double initialStep,
+                LineSearchPoint &accepted) const override;
+};
+
+class ArmijoBacktracking : public LineSearch
+{
+public:
+    explicit ArmijoBacktracking(const LineSearchOptions &options = LineSearchOptions()) : LineSearch(options) {}
+
+    bool search(LineObjective &objective, const std::vector<double> &x,
+                double f, const std::vector<double> &g,
+                const std::vector<double> &d, double initialStep,
+                LineSearchPoint &accepted) const override;
+};
+
+class StrongWolfe : public LineSearch
+{
+public:
+    explicit StrongWolfe(const LineSearchOptions &options = LineSearchOptions()) : LineSearch(options) {}
+
+    bool search(LineObjective &objective, const std::vector<double> &x,
+                double f, const std::vector<double> &g,
+                const std::vector<double> &d, double initialStep,
+                LineSearchPoint &accepted) const override;
+};
+
+class MoreThuente : public LineSearch
+{
+public:
+    explicit MoreThuente(const LineSearchOptions &options = LineSearchOptions()) : LineSearch(options) {}
+
+    bool search(LineObjective &objective, const std::vector<double> &x,
+                double f, const std::vector<double> &g,
+                const std::vector<double> &d, double initialStep,
+                LineSearchPoint &accepted) const override;
+};
+
+#endif
@@ -0,0 +1,42 @@
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <cstddef>
+#include <string>
+
+// Read-only memory mapping of a whole file.
+// Pages are loaded lazily by the OS, so multi-GB files cost no RAM up front.
+class MappedFile
+{
+private:
+    const unsigned char *bytes;
+    size_t length;
+    std::string path;
+
+#ifdef _WIN32
+    void *fileHandle;
+    void *mappingHandle;
+#else
+    int fileDescriptor;
+#endif
+
+    void close();
+
+public:
+    MappedFile();
+    // Throws std::runtime_error if the file cannot be opened or mapped
+    explicit MappedFile(const std::string &path);
+    ~MappedFile();
+
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+    MappedFile(MappedFile &&other) noexcept;
+    MappedFile &operator=(MappedFile &&other) noexcept;
+
+    bool isOpen() const { return bytes != nullptr; }
+    const unsigned char *data() const { return bytes; }
+    size_t size() const { return length; }
+    const std::string &getPath() const { return path; }
+};
+
+#endif
@@ -0,0 +1,133 @@
+#ifndef MESH_BUILDER_H
+#define MESH_BUILDER_H
+
+#include "HeightField.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// Indexed triangle mesh for a height field, one vertex per grid sample, in
+// the field's precision. Vertex (i, j) is at index j * columns + i;
+// positions and normals are packed xyz triples ready for glVertexPointer /
+// glNormalPointer (GL_FLOAT for GridMesh<float>). Each grid cell adds two
+// triangles to indices, wound counter-clockwise seen from +z, so the
+// buffer goes straight to glDrawElements(GL_TRIANGLES, ..., GL_UNSIGNED_INT).
+template <typename Scalar>
+struct GridMesh
+{
+    int columns = 0;
+    int rows = 0;
+    std::vector<Scalar> positions;
+    std::vector<Scalar> normals;
+    std::vector<uint32_t> indices;
+
+    size_t vertexCount() const { return static_cast<size_t>(columns) * rows; }
+    size_t triangleCount() const { return indices.size() / 3; }
+};
+
+typedef GridMesh<float> GridMeshF;
+typedef GridMesh<double> GridMeshD;
+
+enum class MeshNormals
+{
+    STORED_OR_HEIGHTS, // The field's normals (analytic gradients) if it has them
+    FROM_HEIGHTS       // Central differences on the heights, even if stored
+};
+
+// Build vertices, normals and indices from a height field. Each vertex is
+// computed once, and no surface is evaluated: normals are copied from the
+// field or come from central differences on its heights. Bands of rows are
+// built in parallel; pool defaults to ThreadPool::shared().
+template <typename Scalar>
+GridMesh<Scalar> buildGridMesh(const HeightFieldT<Scalar> &field,
+                               MeshNormals normalSource = MeshNormals::STORED_OR_HEIGHTS,
+                               ThreadPool *pool = nullptr)
+{
+    GridMesh<Scalar> mesh;
+    if (field.empty())
+        return mesh;
+    if (field.sampleCount() > UINT32_MAX)
+        throw std::runtime_error("Height field too large for 32-bit mesh indices");
+
+    mesh.columns = field.getColumns();
+    mesh.rows = field.getRows();
+    mesh.positions.resize(3 * mesh.vertexCount());
+    mesh.normals.resize(3 * mesh.vertexCount());
+    mesh.indices.resize(6 * static_cast<size_t>(mesh.columns - 1) * (mesh.rows - 1));
+
+    const int columns = mesh.columns;
+    const int rows = mesh.rows;
+    const Scalar xStep = static_cast<Scalar>(field.xStep());
+    const Scalar yStep = static_cast<Scalar>(field.yStep());
+    const bool copyNormals = field.hasNormals() && normalSource == MeshNormals::STORED_OR_HEIGHTS;
+
+    // A few thousand vertices per band
+    size_t bandRows = std::max<size_t>(1, 4096 / columns);
+    ThreadPool &workers = pool ? *pool : ThreadPool::shared();
+    workers.parallelFor(0, rows, bandRows, [&](size_t bandBegin, size_t bandEnd)
+                        {
+        for (int j = static_cast<int>(bandBegin); j < static_cast<int>(bandEnd); ++j)
+        {
+            Scalar y = static_cast<Scalar>(field.yAt(j));
+            for (int i = 0; i < columns; ++i)
+            {
+                size_t v = 3 * (static_cast<size_t>(j) * columns + i);
+                mesh.positions[v] = static_cast<Scalar>(field.xAt(i));
+                mesh.positions[v + 1] = y;
+                mesh.positions[v + 2] = field.height(i, j);
+
+                if (copyNormals)
+                {
+                    const Scalar *n = field.normal(i, j);
+                    mesh.normals[v] = n[0];
+                    mesh.normals[v + 1] = n[1];
+                    mesh.normals[v + 2] = n[2];
+                    continue;
+                }
+
+                int iPrev = std::max(i - 1, 0), iNext = std::min(i + 1, columns - 1);
+                int jPrev = std::max(j - 1, 0), jNext = std::min(j + 1, rows - 1);
+                Scalar dzdx = (field.height(iNext, j) - field.height(iPrev, j)) / ((iNext - iPrev) * xStep);
+                Scalar dzdy = (field.height(i, jNext) - field.height(i, jPrev)) / ((jNext - jPrev) * yStep);
+                Scalar inv = Scalar(1) / std::sqrt(dzdx * dzdx + dzdy * dzdy + Scalar(1));
+                mesh.normals[v] = -dzdx * inv;
+                mesh.normals[v + 1] = -dzdy * inv;
+                mesh.normals[v + 2] = inv;
+            }
+
+            // Cells of row j: (i, j) to (i + 1, j + 1)
+            if (j == rows - 1)
+                continue;
+            uint32_t *cell = mesh.indices.data() + 6 * static_cast<size_t>(j) * (columns - 1);
+            for (int i = 0; i + 1 < columns; ++i, cell += 6)
+            {
+                uint32_t v00 = static_cast<uint32_t>(j) * columns + i;
+                uint32_t v10 = v00 + 1;
+                uint32_t v01 = v00 + columns;
+                uint32_t v11 = v01 + 1;
+                cell[0] = v00;
+                cell[1] = v10;
+                cell[2] = v11;
+                cell[3] = v00;
+                cell[4] = v11;
+                cell[5] = v01;
+            }
+        } });
+
+    return mesh;
+}
+
+// Wavefront OBJ with positions, normals and triangles; throws
+// std::runtime_error if the file cannot be written
+void writeObj(const GridMeshF &mesh, const std::string &path);
+
+// Binary STL, the usual format for 3D printing; throws std::runtime_error
+// if the file cannot be written
+void writeStl(const GridMeshF &mesh, const std::string &path);
+
+#endif
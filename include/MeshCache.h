@@ -0,0 +1,80 @@
+#ifndef MESH_CACHE_H
+#define MESH_CACHE_H
+
+#include "HeightField.h"
+#include "Surface.h"
+#include <cstdint>
+#include <string>
+
+// On-disk header of a cached height field, in the writer's native byte order
+// (the payload is mapped in place); an entry from a host of the other byte
+// order has a byte-swapped version and is rejected.
+// Heights (float32, row-major) start at heightOffset; when FLAG_NORMALS is set,
+// packed xyz float32 normals start at normalOffset. The checksum covers every
+// byte after the header.
+struct MeshCacheHeader
+{
+    char magic[8];         // "SOMESH\0\0"
+    uint32_t version;      // MESH_CACHE_VERSION
+    uint32_t flags;        // MeshCache::FLAG_NORMALS
+    uint64_t equationHash; // MeshCache::hashEquation of the source equation
+    double xMin, xMax;
+    double yMin, yMax;
+    uint32_t columns;
+    uint32_t rows;
+    uint64_t heightOffset;
+    uint64_t normalOffset;
+    uint64_t checksum;
+};
+
+const uint32_t MESH_CACHE_VERSION = 1;
+
+// Directory of height fields keyed by equation, domain and resolution.
+// Entries are memory-mapped on load, so a cache hit costs a checksum pass
+// instead of re-evaluating the surface at every vertex.
+class MeshCache
+{
+private:
+    std::string directory;
+
+public:
+    static const uint32_t FLAG_NORMALS = 1;
+
+    // Uses defaultDirectory()
+    MeshCache();
+    explicit MeshCache(const std::string &dir);
+
+    // $SURFACE_OPTIMIZER_CACHE, else the platform user cache directory
+    static std::string defaultDirectory();
+
+    // Stable 64-bit hash of an equation's text (normalize it first)
+    static uint64_t hashEquation(const std::string &equation);
+
+    const std::string &getDirectory() const { return directory; }
+
+    // Cache file used for a key
+    std::string pathFor(uint64_t equationHash,
+                        double xMin, double xMax, double yMin, double yMax,
+                        int resolution, bool withNormals) const;
+
+    // Map a cached entry; returns false on a miss or an invalid/corrupt entry
+    bool load(uint64_t equationHash,
+              double xMin, double xMax, double yMin, double yMax,
+              int resolution, bool withNormals, HeightField &field) const;
+
+    // Write an entry atomically; returns false if the cache is not writable
+    bool store(uint64_t equationHash, const HeightField &field) const;
+
+    // Load the entry, or sample the surface and store it
+    HeightField getOrCreate(uint64_t equationHash, const Surface &surface,
+                            double xMin, double xMax, double yMin, double yMax,
+                            int resolution, bool withNormals = true) const;
+
+    // Standalone file access for batch tools; readFile throws std::runtime_error
+    // on a malformed file or checksum mismatch
+    static void writeFile(const std::string &path, uint64_t equationHash,
+                          const HeightField &field);
+    static HeightField readFile(const std::string &path, MeshCacheHeader *header = nullptr);
+};
+
+#endif
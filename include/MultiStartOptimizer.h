@@ -0,0 +1,83 @@
+#ifndef MULTI_START_OPTIMIZER_H
+#define MULTI_START_OPTIMIZER_H
+
+#include "Optimizer.h"
+#include <functional>
+#include <memory>
+#include <vector>
+
+class ThreadPool;
+
+// How the start points are spread over the domain
+enum class StartPattern
+{
+    GRID,   // Cell centres of a near-square grid
+    RANDOM, // Uniform pseudo-random points from the seed
+    SOBOL   // Low-discrepancy Sobol sequence
+};
+
+struct MultiStartOptions
+{
+    int starts = 16;
+    StartPattern pattern = StartPattern::SOBOL;
+    unsigned seed = 1;            // Used by RANDOM
+    double mergeTolerance = 1e-3; // Converged points closer than this are one minimum
+    ThreadPool *pool = nullptr;   // Defaults to ThreadPool::shared()
+    PathRecording pathRecording;  // Applied to every run's optimizer
+};
+
+// A distinct local minimum and the runs that reached it
+struct LocalMinimum
+{
+    Point3D point;
+    double value;
+    int hits;    // Converged runs merged into this minimum
+    int bestRun; // Index of the run with the lowest value
+};
+
+struct MultiStartResult
+{
+    std::vector<LocalMinimum> minima; // Ranked by value, lowest first
+    std::vector<Point3D> starts;
+    std::vector<OptimizationResult> runs; // Indexed like starts
+
+    int convergedRuns;
+    long long totalIterations;
+    long long functionEvaluations;
+    long long gradientEvaluations;
+    long long hessianEvaluations;
+    double wallSeconds; // Elapsed time of the whole search
+    double runSeconds;  // Summed time of the individual runs
+
+    // Run that reached the lowest minimum, or the lowest run if none converged
+    const OptimizationResult *best() const;
+};
+
+// Runs an optimizer from many start points concurrently and collects the
+// distinct local minima. Results are independent of the thread count: every
+// run owns its optimizer and merging happens in start order afterwards.
+class MultiStartOptimizer
+{
+public:
+    typedef std::function<std::unique_ptr<Optimizer>(const Surface *)> OptimizerFactory;
+
+private:
+    const Surface *surface;
+    OptimizerFactory factory;
+    MultiStartOptions options;
+
+public:
+    MultiStartOptimizer(const Surface *surf, OptimizerFactory factory,
+                        const MultiStartOptions &options = MultiStartOptions());
+
+    MultiStartResult optimize(double xMin, double xMax, double yMin, double yMax) const;
+
+    // Start points for the given pattern (z is 0)
+    static std::vector<Point3D> generateStarts(StartPattern pattern, int count, unsigned seed,
+                                               double xMin, double xMax, double yMin, double yMax);
+
+    // Factory producing GradientDescent with the given settings
+    static OptimizerFactory gradientDescent(double lr = 0.1, int maxIter = 1000, double tol = 1e-6);
+};
+
+#endif
@@ -0,0 +1,29 @@
+#ifndef OBJECTIVE_H
+#define OBJECTIVE_H
+
+#include <cstddef>
+
+// Function of dimension() variables. Points are contiguous arrays of
+// doubles; batches hold count points back to back (point k starts at
+// points + k * dimension()), gradients use the same layout.
+class Objective
+{
+public:
+    virtual ~Objective() {}
+
+    virtual size_t dimension() const = 0;
+
+    virtual double value(const double *x) const = 0;
+
+    // f(x), with the gradient written to grad. The default uses central
+    // differences (2 * dimension() extra evaluations); override with
+    // analytic or automatic derivatives.
+    virtual double valueAndGradient(const double *x, double *grad) const;
+
+    // values[k] = f(point k); override to vectorize across points
+    virtual void valueBatch(const double *points, size_t count, double *values) const;
+    virtual void valueAndGradientBatch(const double *points, size_t count,
+                                       double *values, double *grads) const;
+};
+
+#endif
@@ -3,8 +3,40 @@
 
 #include "Surface.h"
 #include "Point3D.h"
+#include "LineSearch.h"
+#include "PathRecorder.h"
+#include <chrono>
+#include <memory>
 #include <vector>
 
+// Why a run ended early; NONE when it converged or ran out of iterations
+enum class StopReason
+{
+    NONE,
+    CANCELLED,
+    TIME_BUDGET,
+    EVALUATION_BUDGET,
+    ABSORBED // Reached a point whose outcome is already known (BasinMap.h)
+};
+
+// Sees every iterate of a run and decides whether it continues
+class IterationObserver
+{
+public:
+    virtual ~IterationObserver() {}
+
+    // Returns why the run must stop, or StopReason::NONE to continue
+    virtual StopReason publish(double x, double y, double z, long long evaluationsSoFar) = 0;
+};
+
+// One iteration of a traced run (Optimizer::setTracing)
+struct IterationTrace
+{
+    double x, y, z;
+    long long evaluations; // Function + gradient + Hessian evaluations so far
+    double seconds;        // Since the run started
+};
+
 struct OptimizationResult
 {
     Point3D minimumPoint;
@@ -12,6 +44,21 @@ struct OptimizationResult
     int iterations;
     std::vector<Point3D> path; // Optimization path for visualization
     bool converged;
+    int functionEvaluations = 0; // Calls to Surface::evaluate
+    int gradientEvaluations = 0; // Gradient vectors computed
+    int hessianEvaluations = 0;  // Hessians computed
+    std::vector<float> compactPath; // x, y, z triples when recorded compactly
+    StopReason stopReason = StopReason::NONE;
+    std::vector<IterationTrace> trace; // Per-iteration samples when tracing
+
+    // Recorded iterates in either storage form
+    size_t pathSize() const { return compactPath.empty() ? path.size() : compactPath.size() / 3; }
+    Point3D pathPoint(size_t i) const
+    {
+        if (compactPath.empty())
+            return path[i];
+        return Point3D(compactPath[3 * i], compactPath[3 * i + 1], compactPath[3 * i + 2]);
+    }
 };
 
 class Optimizer
@@ -22,11 +69,70 @@ protected:
     int maxIterations;
     double tolerance;
 
+    // Evaluation counts of the current optimize() call
+    int functionEvaluations;
+    int gradientEvaluations;
+    int hessianEvaluations;
+
+    // Surface calls that are tallied into the counts
+    double evaluateSurface(double x, double y);
+    Point3D surfaceGradient(double x, double y);
+    void surfaceHessian(double x, double y, double &fxx, double &fxy, double &fyy);
+
+    // Start and end of every run: also feed the per-thread instrumentation
+    // counters and the OPTIMIZE phase (Instrumentation.h) and the trace
+    void resetCounters();
+    void recordCounters(OptimizationResult &result);
+
+    // Which iterates go into OptimizationResult::path
+    PathRecording pathRecording;
+
+    // Progress sink and stop signal; null runs unobserved
+    IterationObserver *monitor;
+    StopReason stopReason;
+
+    // Per-iteration trace of the current run, filled by keepGoing
+    bool tracing;
+    std::vector<IterationTrace> trace;
+    std::chrono::steady_clock::time_point runStart;
+
+    // Called once per iteration with the current point. Traces it, publishes
+    // it to the monitor and returns false once the run has to stop
+    // (cancelled or over budget); the reason ends up in the result.
+    bool keepGoing(double x, double y, double z);
+
+    // Step selection; null takes the fixed learningRate step
+    std::shared_ptr<const LineSearch> lineSearch;
+
+    // Search from (x, y) along (dx, dy); step holds the initial trial and
+    // returns the accepted one. On success moves to the accepted point and
+    // takes over its value and, if the search computed one, its gradient
+    // (haveGradient tells which).
+    bool lineSearchStep(double &x, double &y, double &z, Point3D &grad, bool &haveGradient,
+                        double dx, double dy, double &step);
+
 public:
     Optimizer(const Surface *surf, double lr = 0.1,
               int maxIter = 1000, double tol = 1e-6);
     virtual ~Optimizer() {}
 
+    // Observe and control runs, e.g. from another thread (AsyncOptimizer.h)
+    void setMonitor(IterationObserver *observer) { monitor = observer; }
+
+    // Record an IterationTrace per iteration into OptimizationResult::trace;
+    // records nothing when built without SURFACE_INSTRUMENTATION
+    void setTracing(bool enabled) { tracing = enabled; }
+    bool isTracing() const { return tracing; }
+
+    // Path storage: none, every k-th, ring buffer or full (the default)
+    void setPathRecording(const PathRecording &recording) { pathRecording = recording; }
+    const PathRecording &getPathRecording() const { return pathRecording; }
+
+    // Choose steps with a line search instead of the fixed learning rate;
+    // learningRate then becomes the initial trial step
+    void setLineSearch(std::shared_ptr<const LineSearch> search) { lineSearch = search; }
+    const LineSearch *getLineSearch() const { return lineSearch.get(); }
+
     // Pure virtual optimization method
     virtual OptimizationResult optimize(double startX, double startY) = 0;
 };
@@ -49,12 +155,6 @@ public:
                     int maxIter = 1000, double tol = 1e-6);
 
     OptimizationResult optimize(double startX, double startY) override;
-
-private:
-    // Calculate second partial derivatives for Hessian matrix
-    double partialXX(double x, double y) const;
-    double partialYY(double x, double y) const;
-    double partialXY(double x, double y) const;
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,103 @@
+#ifndef PARAMETER_SWEEP_H
+#define PARAMETER_SWEEP_H
+
+#include "Optimizer.h"
+#include <cstdint>
+#include <iosfwd>
+#include <memory>
+#include <string>
+#include <vector>
+
+class ThreadPool;
+
+// Values to combine; every combination of one entry per axis is a run
+struct SweepSpace
+{
+    std::vector<std::string> optimizers = {"gradient-descent"}; // Names from ParameterSweep::optimizerNames()
+    std::vector<double> learningRates = {0.01};
+    std::vector<double> tolerances = {1e-6};
+    std::vector<int> maxIterations = {1000};
+    std::vector<Point3D> starts = {Point3D(0, 0, 0)}; // z is ignored
+};
+
+struct SweepOptions
+{
+    size_t samples = 0;         // 0 runs the full grid, otherwise a random subset of this size
+    unsigned seed = 1;          // Chooses the subset
+    ThreadPool *pool = nullptr; // Defaults to ThreadPool::shared()
+};
+
+// One row per run, stored column by column
+struct SweepResults
+{
+    std::vector<std::string> optimizerNames; // Indexed by the optimizer column
+
+    std::vector<uint8_t> optimizer;
+    std::vector<double> learningRate;
+    std::vector<double> tolerance;
+    std::vector<int32_t> maxIterations;
+    std::vector<double> startX, startY;
+
+    std::vector<uint8_t> converged;
+    std::vector<int32_t> iterations;
+    std::vector<int32_t> functionEvaluations;
+    std::vector<int32_t> gradientEvaluations;
+    std::vector<int32_t> hessianEvaluations;
+    std::vector<double> finalValue;
+    std::vector<double> wallSeconds;
+
+    size_t size() const { return optimizer.size(); }
+    void resize(size_t rows);
+
+    // Header line plus one line per run, optimizers by name
+    void writeCsv(std::ostream &out) const;
+
+    // Binary columnar form: SweepFileHeader, the optimizer names
+    // ('\n'-terminated), then each column in declaration order as a packed
+    // little-endian array (byte-swapped on big-endian hosts, like the header).
+    // Every section starts on an 8-byte boundary.
+    void writeBinary(const std::string &path) const;
+    static SweepResults readBinary(const std::string &path);
+};
+
+// On-disk header of SweepResults::writeBinary, little-endian
+struct SweepFileHeader
+{
+    char magic[8];      // "SOSWEEP\0"
+    uint32_t version;   // SWEEP_FILE_VERSION
+    uint32_t nameBytes; // Length of the name table before padding
+    uint64_t rows;
+};
+
+const uint32_t SWEEP_FILE_VERSION = 1;
+
+// Runs every combination (or a seeded random subset) of optimizer,
+// learning rate, tolerance, iteration limit and start point on one surface,
+// in parallel. Row order follows the combination order, optimizers varying
+// slowest and starts fastest, so the results do not depend on the thread
+// count apart from the wall times.
+class ParameterSweep
+{
+private:
+    const Surface *surface;
+    SweepSpace space;
+    SweepOptions options;
+
+public:
+    ParameterSweep(const Surface *surf, const SweepSpace &space,
+                   const SweepOptions &options = SweepOptions());
+
+    // Size of the full grid
+    size_t combinations() const;
+
+    SweepResults run() const;
+
+    // Optimizer for a name; learningRate is its step, trust radius,
+    // simplex edge or population spread. Throws for unknown names.
+    static std::unique_ptr<Optimizer> createOptimizer(const std::string &name, const Surface *surf,
+                                                      double learningRate, int maxIterations,
+                                                      double tolerance);
+    static const std::vector<std::string> &optimizerNames();
+};
+
+#endif
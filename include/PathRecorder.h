@@ -0,0 +1,194 @@
+#ifndef PATH_RECORDER_H
+#define PATH_RECORDER_H
+
+#include "Point3D.h"
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+// Which iterates an optimizer keeps in OptimizationResult::path
+struct PathRecording
+{
+    enum Mode
+    {
+        NONE,    // Endpoint only (minimumPoint); no path storage at all
+        EVERY_K, // Every k-th iterate, plus the last one
+        RING,    // The most recent `capacity` iterates
+        FULL     // Every iterate, with `capacity` reserved up front
+    };
+
+    Mode mode = FULL;
+    int stride = 1;      // k for EVERY_K
+    size_t capacity = 0; // Ring size, or the reservation for FULL (0: maxIterations + 1)
+    bool compact = false; // Store float xyz triples in compactPath instead of Point3D
+
+    static PathRecording none()
+    {
+        PathRecording r;
+        r.mode = NONE;
+        return r;
+    }
+
+    static PathRecording everyK(int k)
+    {
+        PathRecording r;
+        r.mode = EVERY_K;
+        r.stride = std::max(1, k);
+        return r;
+    }
+
+    static PathRecording ring(size_t points)
+    {
+        PathRecording r;
+        r.mode = RING;
+        r.capacity = std::max<size_t>(1, points);
+        return r;
+    }
+
+    static PathRecording full(size_t reserve = 0)
+    {
+        PathRecording r;
+        r.mode = FULL;
+        r.capacity = reserve;
+        return r;
+    }
+
+    PathRecording &asCompact(bool enabled = true)
+    {
+        compact = enabled;
+        return *this;
+    }
+};
+
+// Records iterates into a result's path (or compact path) according to a
+// PathRecording. All storage is sized in the constructor, so record() does
+// not allocate inside the optimizer loop for NONE, RING or FULL.
+class PathRecorder
+{
+private:
+    PathRecording settings;
+    std::vector<Point3D> &points;
+    std::vector<float> &compactPoints;
+
+    size_t seen;    // Iterates offered to record()
+    size_t written; // Iterates stored (ring: total writes)
+    bool lastSkipped;
+    double lastX, lastY, lastZ;
+
+    void store(size_t slot, double x, double y, double z)
+    {
+        if (settings.compact)
+        {
+            float *p = compactPoints.data() + 3 * slot;
+            p[0] = static_cast<float>(x);
+            p[1] = static_cast<float>(y);
+            p[2] = static_cast<float>(z);
+        }
+        else
+        {
+            points[slot] = Point3D(x, y, z);
+        }
+    }
+
+    void append(double x, double y, double z)
+    {
+        if (settings.compact)
+        {
+            compactPoints.push_back(static_cast<float>(x));
+            compactPoints.push_back(static_cast<float>(y));
+            compactPoints.push_back(static_cast<float>(z));
+        }
+        else
+        {
+            points.push_back(Point3D(x, y, z));
+        }
+    }
+
+public:
+    PathRecorder(const PathRecording &settings, std::vector<Point3D> &path,
+                 std::vector<float> &compactPath, int maxIterations)
+        : settings(settings), points(path), compactPoints(compactPath),
+          seen(0), written(0), lastSkipped(false), lastX(0), lastY(0), lastZ(0)
+    {
+        points.clear();
+        compactPoints.clear();
+
+        size_t reserve = 0;
+        switch (settings.mode)
+        {
+        case PathRecording::NONE:
+            break;
+        case PathRecording::EVERY_K:
+            reserve = static_cast<size_t>(std::max(0, maxIterations)) / settings.stride + 2;
+            break;
+        case PathRecording::RING:
+            // Fixed slots written in place
+            if (settings.compact)
+                compactPoints.resize(3 * settings.capacity);
+            else
+                points.resize(settings.capacity);
+            return;
+        case PathRecording::FULL:
+            reserve = settings.capacity ? settings.capacity
+                                        : static_cast<size_t>(std::max(0, maxIterations)) + 1;
+            break;
+        }
+
+        if (settings.compact)
+            compactPoints.reserve(3 * reserve);
+        else
+            points.reserve(reserve);
+    }
+
+    void record(double x, double y, double z)
+    {
+        switch (settings.mode)
+        {
+        case PathRecording::NONE:
+            return;
+        case PathRecording::EVERY_K:
+            lastSkipped = seen % settings.stride != 0;
+            lastX = x;
+            lastY = y;
+            lastZ = z;
+            if (!lastSkipped)
+                append(x, y, z);
+            break;
+        case PathRecording::RING:
+            store(written % settings.capacity, x, y, z);
+            written++;
+            break;
+        case PathRecording::FULL:
+            append(x, y, z);
+            break;
+        }
+        seen++;
+    }
+
+    // Put the stored iterates in order; EVERY_K keeps the last one too
+    void finish()
+    {
+        if (settings.mode == PathRecording::EVERY_K && lastSkipped)
+        {
+            append(lastX, lastY, lastZ);
+            lastSkipped = false;
+        }
+        else if (settings.mode == PathRecording::RING)
+        {
+            size_t count = std::min(written, settings.capacity);
+            size_t oldest = written > settings.capacity ? written % settings.capacity : 0;
+            if (settings.compact)
+            {
+                std::rotate(compactPoints.begin(), compactPoints.begin() + 3 * oldest, compactPoints.end());
+                compactPoints.resize(3 * count);
+            }
+            else
+            {
+                std::rotate(points.begin(), points.begin() + oldest, points.end());
+                points.resize(count);
+            }
+        }
+    }
+};
+
+#endif
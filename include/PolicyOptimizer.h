@@ -0,0 +1,187 @@
+#ifndef POLICY_OPTIMIZER_H
+#define POLICY_OPTIMIZER_H
+
+#include "Optimizer.h"
+#include <cmath>
+
+// First-order optimizers built from one iteration loop and a step policy.
+// The loop is GradientDescent's: record the point, stop once |∇f| falls
+// below the tolerance, otherwise let the policy move (x, y). The policy is
+// a template argument, so its state update inlines into the loop.
+//
+// A policy provides
+//     void reset();
+//     void step(double gx, double gy, double lr, double &x, double &y);
+// where (gx, gy) is the gradient at (x, y). Step policies ignore any line
+// search set on the optimizer; their step rule is the point.
+template <typename StepPolicy>
+class PolicyOptimizer : public Optimizer
+{
+private:
+    StepPolicy policy;
+
+public:
+    PolicyOptimizer(const Surface *surf, double lr = 0.01, int maxIter = 1000,
+                    double tol = 1e-6, const StepPolicy &policy = StepPolicy())
+        : Optimizer(surf, lr, maxIter, tol), policy(policy) {}
+
+    StepPolicy &getPolicy() { return policy; }
+
+    OptimizationResult optimize(double startX, double startY) override
+    {
+        OptimizationResult result;
+        result.converged = false;
+        result.iterations = 0;
+        resetCounters();
+        policy.reset();
+
+        PathRecorder recorder(pathRecording, result.path, result.compactPath, maxIterations);
+
+        double x = startX, y = startY;
+        double z = evaluateSurface(x, y);
+
+        for (int iter = 0; iter < maxIterations; ++iter)
+        {
+            recorder.record(x, y, z);
+            if (!keepGoing(x, y, z))
+                break;
+
+            Point3D grad = surfaceGradient(x, y);
+            double gx = grad.getX(), gy = grad.getY();
+
+            if (std::sqrt(gx * gx + gy * gy) < tolerance)
+            {
+                result.converged = true;
+                result.iterations = iter;
+                break;
+            }
+
+            policy.step(gx, gy, learningRate, x, y);
+            z = evaluateSurface(x, y);
+
+            result.iterations = iter + 1;
+        }
+
+        recorder.finish();
+        result.minimumValue = z;
+        result.minimumPoint = Point3D(x, y, z);
+        recordCounters(result);
+
+        return result;
+    }
+};
+
+// x -= lr * g; identical to GradientDescent without a line search
+struct PlainStep
+{
+    void reset() {}
+
+    void step(double gx, double gy, double lr, double &x, double &y)
+    {
+        x = x - lr * gx;
+        y = y - lr * gy;
+    }
+};
+
+// Heavy ball: v = mu v - lr g; x += v
+struct MomentumStep
+{
+    double momentum;
+    double vx, vy;
+
+    explicit MomentumStep(double momentum = 0.9) : momentum(momentum), vx(0), vy(0) {}
+
+    void reset() { vx = vy = 0; }
+
+    void step(double gx, double gy, double lr, double &x, double &y)
+    {
+        vx = momentum * vx - lr * gx;
+        vy = momentum * vy - lr * gy;
+        x += vx;
+        y += vy;
+    }
+};
+
+// Nesterov accelerated gradient in the form that only needs the gradient
+// at the current point: v' = mu v - lr g; x += -mu v + (1 + mu) v'
+struct NesterovStep
+{
+    double momentum;
+    double vx, vy;
+
+    explicit NesterovStep(double momentum = 0.9) : momentum(momentum), vx(0), vy(0) {}
+
+    void reset() { vx = vy = 0; }
+
+    void step(double gx, double gy, double lr, double &x, double &y)
+    {
+        double px = vx, py = vy;
+        vx = momentum * vx - lr * gx;
+        vy = momentum * vy - lr * gy;
+        x += -momentum * px + (1 + momentum) * vx;
+        y += -momentum * py + (1 + momentum) * vy;
+    }
+};
+
+// Per-coordinate steps scaled by a running RMS of the gradient
+struct RMSPropStep
+{
+    double decay;
+    double epsilon;
+    double sx, sy;
+
+    explicit RMSPropStep(double decay = 0.9, double epsilon = 1e-8)
+        : decay(decay), epsilon(epsilon), sx(0), sy(0) {}
+
+    void reset() { sx = sy = 0; }
+
+    void step(double gx, double gy, double lr, double &x, double &y)
+    {
+        sx = decay * sx + (1 - decay) * gx * gx;
+        sy = decay * sy + (1 - decay) * gy * gy;
+        x -= lr * gx / (std::sqrt(sx) + epsilon);
+        y -= lr * gy / (std::sqrt(sy) + epsilon);
+    }
+};
+
+// Adam: bias-corrected first and second moment estimates
+struct AdamStep
+{
+    double beta1, beta2;
+    double epsilon;
+    double mx, my, vx, vy;
+    double beta1Power, beta2Power; // beta^t for the bias correction
+
+    explicit AdamStep(double beta1 = 0.9, double beta2 = 0.999, double epsilon = 1e-8)
+        : beta1(beta1), beta2(beta2), epsilon(epsilon),
+          mx(0), my(0), vx(0), vy(0), beta1Power(1), beta2Power(1) {}
+
+    void reset()
+    {
+        mx = my = vx = vy = 0;
+        beta1Power = beta2Power = 1;
+    }
+
+    void step(double gx, double gy, double lr, double &x, double &y)
+    {
+        mx = beta1 * mx + (1 - beta1) * gx;
+        my = beta1 * my + (1 - beta1) * gy;
+        vx = beta2 * vx + (1 - beta2) * gx * gx;
+        vy = beta2 * vy + (1 - beta2) * gy * gy;
+        beta1Power *= beta1;
+        beta2Power *= beta2;
+
+        double mScale = 1 / (1 - beta1Power);
+        double vScale = 1 / (1 - beta2Power);
+        x -= lr * (mx * mScale) / (std::sqrt(vx * vScale) + epsilon);
+        y -= lr * (my * mScale) / (std::sqrt(vy * vScale) + epsilon);
+    }
+};
+
+typedef PolicyOptimizer<PlainStep> PlainGradientDescent;
+typedef PolicyOptimizer<MomentumStep> MomentumOptimizer;
+typedef PolicyOptimizer<NesterovStep> NesterovOptimizer;
+typedef PolicyOptimizer<RMSPropStep> RMSPropOptimizer;
+typedef PolicyOptimizer<AdamStep> AdamOptimizer;
+
+#endif
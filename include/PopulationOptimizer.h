@@ -0,0 +1,148 @@
+#ifndef POPULATION_OPTIMIZER_H
+#define POPULATION_OPTIMIZER_H
+
+#include "Optimizer.h"
+#include <cstdint>
+#include <vector>
+
+class ThreadPool;
+
+// Small counter-based generator (SplitMix64). Identical sequences on every
+// platform, unlike the std:: distributions.
+class RandomStream
+{
+private:
+    uint64_t state;
+
+public:
+    explicit RandomStream(uint64_t seed = 0) : state(seed) {}
+
+    // Stream `index` of a seeded family; streams do not overlap in practice
+    static RandomStream forSlot(unsigned seed, size_t index)
+    {
+        RandomStream mixer((static_cast<uint64_t>(seed) << 32) ^ index);
+        return RandomStream(mixer.next());
+    }
+
+    uint64_t next()
+    {
+        uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return z ^ (z >> 31);
+    }
+
+    // Uniform in [0, 1)
+    double uniform() { return (next() >> 11) * (1.0 / 9007199254740992.0); }
+
+    // Standard normal (Box-Muller)
+    double normal();
+};
+
+// Base of the population methods. Every generation's candidates are
+// proposed and evaluated in one parallelFor over the population: each chunk
+// proposes its members and evaluates them with one evaluateBatch call.
+// Member k always draws from its own RandomStream, derived from the seed
+// and k, so results do not depend on the thread count or chunking.
+//
+// lr is the initial spread around the start point. The path is the
+// best-so-far point after each generation; iterations count generations.
+class PopulationOptimizer : public Optimizer
+{
+protected:
+    int populationSize;
+    unsigned seed;
+    ThreadPool *pool; // Null: ThreadPool::shared()
+
+    std::vector<RandomStream> streams; // One per population slot
+    std::vector<double> candidateX, candidateY, candidateZ;
+
+    double originX, originY; // Start point of the current run
+    int generation;          // Generations evaluated so far in this run
+
+    // Best point seen so far
+    double bestX, bestY, bestZ;
+
+    // Per-member proposal: write candidateX/Y[k] using streams[k]. Runs
+    // concurrently for different k.
+    virtual void propose(size_t k) = 0;
+
+    // Reset streams, candidates and the best point for a new run
+    void beginRun(double startX, double startY);
+
+    // propose() and evaluate all members in parallel, then track the best
+    void evaluateGeneration();
+
+    // The best value has run off to -inf (surface unbounded below)
+    bool diverged() const;
+
+    // Copy the best point, path and counts into the result
+    void finishRun(OptimizationResult &result, PathRecorder &recorder);
+
+public:
+    PopulationOptimizer(const Surface *surf, double lr, int maxIter, double tol,
+                        int populationSize, unsigned seed);
+
+    void setSeed(unsigned value) { seed = value; }
+    void setThreadPool(ThreadPool *threadPool) { pool = threadPool; }
+    int getPopulationSize() const { return populationSize; }
+};
+
+// Particle swarm (inertia-weight form with the standard constriction
+// constants). Converges once every personal best is within the tolerance
+// of the swarm's best.
+class ParticleSwarm : public PopulationOptimizer
+{
+private:
+    std::vector<double> px, py, vx, vy;            // Positions and velocities
+    std::vector<double> bestPx, bestPy, bestPz;    // Personal bests
+
+    void propose(size_t k) override;
+
+public:
+    ParticleSwarm(const Surface *surf, double lr = 1.0, int maxIter = 1000,
+                  double tol = 1e-6, int populationSize = 32, unsigned seed = 1);
+
+    OptimizationResult optimize(double startX, double startY) override;
+};
+
+// Differential evolution, DE/rand/1/bin with F = 0.8 and CR = 0.9.
+// Converges once the population is within the tolerance of its best.
+class DifferentialEvolution : public PopulationOptimizer
+{
+private:
+    std::vector<double> px, py, pz;
+    double weight, crossover;
+
+    void propose(size_t k) override;
+
+public:
+    DifferentialEvolution(const Surface *surf, double lr = 1.0, int maxIter = 1000,
+                          double tol = 1e-6, int populationSize = 40, unsigned seed = 1);
+
+    OptimizationResult optimize(double startX, double startY) override;
+};
+
+// CMA-ES: (mu/mu_w, lambda) evolution strategy adapting a full 2x2
+// covariance and the step size sigma (Hansen's tutorial defaults).
+// Converges once sigma times the largest axis of C is below the tolerance.
+class CMAES : public PopulationOptimizer
+{
+private:
+    double meanX, meanY, sigma;
+    double c11, c12, c22;          // Covariance
+    double b11, b12, b21, b22;     // Eigenvectors (columns) of C
+    double d1, d2;                 // Square roots of the eigenvalues
+    std::vector<double> zx, zy;    // Standard normal draws per member
+
+    void propose(size_t k) override;
+
+public:
+    // populationSize = 0 picks the default lambda = 4 + floor(3 ln 2) = 6
+    CMAES(const Surface *surf, double lr = 1.0, int maxIter = 1000,
+          double tol = 1e-6, int populationSize = 0, unsigned seed = 1);
+
+    OptimizationResult optimize(double startX, double startY) override;
+};
+
+#endif
@@ -0,0 +1,66 @@
+#ifndef QUASI_NEWTON_H
+#define QUASI_NEWTON_H
+
+#include "Optimizer.h"
+#include "LineSearch.h"
+#include <functional>
+#include <memory>
+#include <vector>
+
+struct QuasiNewtonOptions
+{
+    int memory = 8;            // Correction pairs kept by L-BFGS; 0 uses dense BFGS
+    int maxIterations = 1000;
+    double tolerance = 1e-6;   // Stop when the gradient norm falls below this
+    std::shared_ptr<const LineSearch> lineSearch; // Strong Wolfe when null
+    double initialStep = 1.0;  // Trial step of the first iteration, scaled by 1/|g|
+    bool recordPath = true;
+
+    // Called with each iterate and its value; returning false stops the run
+    std::function<bool(const std::vector<double> &x, double value)> onIterate;
+};
+
+struct QuasiNewtonResult
+{
+    std::vector<double> x;
+    double value;
+    std::vector<double> gradient;
+    int iterations;
+    int evaluations; // Objective calls; each yields f and its gradient
+    bool converged;
+    std::vector<std::vector<double>> path; // Accepted iterates
+    std::vector<double> pathValues;        // f at each path point
+};
+
+// BFGS / L-BFGS with a Wolfe line search. The line search hands back the
+// gradient of the accepted point, so every objective call is used once.
+class QuasiNewton
+{
+private:
+    ObjectiveFunction objective;
+    QuasiNewtonOptions options;
+
+public:
+    explicit QuasiNewton(ObjectiveFunction objective,
+                         const QuasiNewtonOptions &options = QuasiNewtonOptions());
+
+    QuasiNewtonResult minimize(const std::vector<double> &start) const;
+};
+
+// Quasi-Newton optimizer on a Surface. Needs no Hessian, so it keeps going
+// on saddles and flat regions where NewtonOptimizer stops, and it takes
+// far fewer steps than GradientDescent on ill-conditioned valleys.
+class LBFGSOptimizer : public Optimizer
+{
+private:
+    int memory;
+
+public:
+    // memory = 0 selects dense BFGS; lr is the first trial step
+    LBFGSOptimizer(const Surface *surf, int memory = 8, double lr = 1.0,
+                   int maxIter = 1000, double tol = 1e-6);
+
+    OptimizationResult optimize(double startX, double startY) override;
+};
+
+#endif
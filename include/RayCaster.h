@@ -0,0 +1,73 @@
+#ifndef RAY_CASTER_H
+#define RAY_CASTER_H
+
+#include "SoftwareRenderer.h"
+#include "HeightPyramid.h"
+#include <cstdint>
+#include <vector>
+
+class Surface;
+class ThreadPool;
+
+// CPU ray caster for headless rendering of large height fields. Instead of
+// drawing every triangle it casts one ray per pixel through the min/max
+// HeightPyramid, so its cost grows with the image size and only
+// logarithmically with the grid; it overtakes SoftwareRenderer once the
+// grid has many more cells than the image has pixels, and needs no mesh.
+//
+// Rays are traced in packets of 4x2 pixels that share the camera origin.
+// Each pyramid cell is tested against the whole packet at once, and is
+// skipped when every ray in the packet misses it or has a closer hit. Cells are visited front to back, so most of the
+// pyramid is never touched.
+//
+// The surface is lit per pixel with the normal of the Surface when given,
+// else the field's stored normals, else the triangle's face normal. The
+// path is drawn as thick lines with start / end markers, and the axes as
+// in SoftwareRenderer, depth tested against the surface.
+class RayCaster
+{
+public:
+    static const int TILE_SIZE = 32;
+    static const int PACKET_WIDTH = 4;
+    static const int PACKET_HEIGHT = 2;
+    static const int PACKET_SIZE = PACKET_WIDTH * PACKET_HEIGHT;
+
+    // Screen-space line from a to b; 1 / depth interpolates linearly
+    struct ScreenSegment
+    {
+        float x0, y0, invDepth0;
+        float x1, y1, invDepth1;
+        float halfWidth;
+        float colour[3];
+    };
+
+private:
+    ThreadPool *pool;
+
+    // Per-frame scratch, reused
+    std::vector<ScreenSegment> segments;
+    std::vector<SoftwareRenderer::ScreenDisc> discs;
+    std::vector<std::vector<uint32_t>> bins; // Overlay entries per tile
+    int tileColumns = 0, tileRows = 0;
+
+    void addOverlay(const OptimizationResult *path, const RenderSettings &settings, const ViewTransform &view);
+    void addSegment(const float *a, const float *b, const float *colour, float width, const ViewTransform &view);
+    void binBox(uint32_t id, float minX, float minY, float maxX, float maxY, int width, int height);
+    void renderTile(int tile, const HeightPyramid &pyramid, const Surface *surface,
+                    const RenderSettings &settings, const ViewTransform &view, Image &image);
+
+public:
+    // pool defaults to ThreadPool::shared()
+    explicit RayCaster(ThreadPool *pool = nullptr);
+
+    // Render into image, resized to the settings. surface, if given,
+    // supplies analytic normals; it should be the function the pyramid's
+    // field was sampled from. path may be null.
+    void render(const HeightPyramid &pyramid, const OptimizationResult *path, const RenderSettings &settings,
+                Image &image, const Surface *surface = nullptr);
+
+    Image render(const HeightPyramid &pyramid, const OptimizationResult *path = nullptr,
+                 const RenderSettings &settings = RenderSettings(), const Surface *surface = nullptr);
+};
+
+#endif
@@ -0,0 +1,95 @@
+#ifndef SAMPLED_SURFACE_H
+#define SAMPLED_SURFACE_H
+
+#include "Surface.h"
+#include "MappedFile.h"
+#include <cstdint>
+#include <string>
+
+// On-disk header of a sampled grid file, in the writer's native byte order
+// so samples can be mapped in place. A file from a host of the other byte
+// order reads back with a byte-swapped version and is rejected. The header
+// is followed, at dataOffset, by rows * columns samples in row-major order:
+// sample (i, j) lies at x = xMin + i * (xMax - xMin) / (columns - 1),
+// y = yMin + j * (yMax - yMin) / (rows - 1) and is stored at index j * columns + i.
+struct GridFileHeader
+{
+    char magic[8];      // "SOGRID\0\0"
+    uint32_t version;   // GRID_FILE_VERSION
+    uint32_t dataType;  // SampledSurface::DataType
+    uint64_t columns;   // Samples along x (>= 2)
+    uint64_t rows;      // Samples along y (>= 2)
+    double xMin, xMax;
+    double yMin, yMax;
+    uint64_t dataOffset; // Byte offset of the first sample
+};
+
+const uint32_t GRID_FILE_VERSION = 1;
+
+// Height field sampled on a regular grid and memory-mapped from disk.
+// Only the pages touched by evaluate() are ever read, so datasets larger
+// than RAM can be optimized and visualized like any other surface.
+// Outside the grid bounds the surface is clamped to its border values.
+class SampledSurface : public Surface
+{
+public:
+    enum DataType
+    {
+        FLOAT32 = 0,
+        FLOAT64 = 1
+    };
+
+    enum Interpolation
+    {
+        BILINEAR,
+        BICUBIC // Catmull-Rom, C1 continuous
+    };
+
+private:
+    MappedFile file;
+    GridFileHeader header;
+    const void *samples;
+    Interpolation interpolation;
+    double xStep, yStep;
+
+    template <typename T>
+    double interpolate(double x, double y, double *dx, double *dy) const;
+
+public:
+    // Throws std::runtime_error if the file is missing or malformed
+    explicit SampledSurface(const std::string &path, Interpolation interp = BICUBIC);
+
+    double evaluate(double x, double y) const override;
+
+    // Analytic derivatives of the interpolant (not finite differences)
+    double partialX(double x, double y) const override;
+    double partialY(double x, double y) const override;
+
+    void setInterpolation(Interpolation interp) { interpolation = interp; }
+    Interpolation getInterpolation() const { return interpolation; }
+
+    // Grid description
+    double getXMin() const { return header.xMin; }
+    double getXMax() const { return header.xMax; }
+    double getYMin() const { return header.yMin; }
+    double getYMax() const { return header.yMax; }
+    size_t getColumns() const { return static_cast<size_t>(header.columns); }
+    size_t getRows() const { return static_cast<size_t>(header.rows); }
+    DataType getDataType() const { return static_cast<DataType>(header.dataType); }
+
+    // Raw sample at grid index (i, j)
+    double sample(size_t i, size_t j) const;
+
+    // Write a grid file from row-major samples
+    static void writeGridFile(const std::string &path,
+                              double xMin, double xMax, double yMin, double yMax,
+                              size_t columns, size_t rows,
+                              const double *values, DataType type = FLOAT32);
+
+    // Sample any surface into a grid file, streaming one row at a time
+    static void writeGridFile(const std::string &path, const Surface &surface,
+                              double xMin, double xMax, double yMin, double yMax,
+                              size_t columns, size_t rows, DataType type = FLOAT32);
+};
+
+#endif
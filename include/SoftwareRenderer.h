@@ -0,0 +1,149 @@
+#ifndef SOFTWARE_RENDERER_H
+#define SOFTWARE_RENDERER_H
+
+#include "Image.h"
+#include "MeshBuilder.h"
+#include "Optimizer.h"
+#include <cstdint>
+#include <vector>
+
+class ThreadPool;
+
+// Camera and lighting of Visualizer::display: the eye sits at (0, 0, zoom)
+// looking at the origin, the scene is rotated by rotationX about x and then
+// rotationY about y, seen through a 45 degree perspective. LIGHT0 is a
+// directional light fixed in eye space.
+struct RenderSettings
+{
+    int width = 800;
+    int height = 600;
+
+    float rotationX = 30.0f; // Degrees
+    float rotationY = 45.0f;
+    float zoom = 30.0f;
+    float fieldOfView = 45.0f; // Vertical, degrees
+    float nearPlane = 0.1f;
+    float farPlane = 100.0f;
+
+    float lightDirection[3] = {1.0f, 1.0f, 1.0f}; // Towards the light, eye space
+    float lightAmbient = 0.3f;
+    float lightDiffuse = 0.7f;
+    float globalAmbient = 0.2f; // GL_LIGHT_MODEL_AMBIENT default
+
+    float surfaceColour[3] = {0.5f, 0.7f, 1.0f};
+    float background[3] = {0.0f, 0.0f, 0.0f};
+
+    bool drawAxes = true;
+    float pathWidth = 3.0f; // Pixels, as glLineWidth
+};
+
+// Model-view and projection of RenderSettings, shared by the headless
+// renderers. Eye space looks down -z; depth is the distance along the view
+// axis (GL's w), and screen y grows downwards.
+struct ViewTransform
+{
+    float rotation[9]; // Row-major, applied to world points and normals
+    float zoom;
+    float focalX, focalY;   // Pixels per unit of x / depth and y / depth
+    float centreX, centreY; // Screen position of the view axis
+    float nearPlane, farPlane;
+    float light[3]; // Unit vector towards LIGHT0, eye space
+
+    explicit ViewTransform(const RenderSettings &settings);
+
+    void toEye(const float *world, float *eye) const
+    {
+        eye[0] = rotation[0] * world[0] + rotation[1] * world[1] + rotation[2] * world[2];
+        eye[1] = rotation[3] * world[0] + rotation[4] * world[1] + rotation[5] * world[2];
+        eye[2] = rotation[6] * world[0] + rotation[7] * world[1] + rotation[8] * world[2] - zoom;
+    }
+
+    void rotate(const float *world, float *eye) const
+    {
+        eye[0] = rotation[0] * world[0] + rotation[1] * world[1] + rotation[2] * world[2];
+        eye[1] = rotation[3] * world[0] + rotation[4] * world[1] + rotation[5] * world[2];
+        eye[2] = rotation[6] * world[0] + rotation[7] * world[1] + rotation[8] * world[2];
+    }
+
+    // Fixed-function lighting of a vertex with the given colour
+    void shade(const RenderSettings &settings, const float *eyeNormal, const float *colour, float *lit) const;
+};
+
+// CPU rasterizer for headless batch rendering (no GL context or display).
+// Draws a GridMesh with Gouraud shading, the optimization path as thick
+// lines with start / end markers, and the axes, like Visualizer::display.
+//
+// The screen is split into 64x64 tiles. Triangles are transformed and
+// binned in parallel, then each tile is rasterized by one thread into its
+// own z-buffer, evaluating the edge functions eight pixels at a time.
+// Buffers are kept between frames, so rendering a sequence into the same
+// Image allocates nothing.
+class SoftwareRenderer
+{
+public:
+    static const int TILE_SIZE = 64;
+
+    // Vertex after transformation: screen position, 1 / depth and the
+    // lit colour divided by depth (for perspective-correct interpolation)
+    struct ScreenVertex
+    {
+        float x, y, invDepth;
+        float r, g, b;
+    };
+
+    // Triangle not taken from the mesh: a near-clipped piece or a line quad
+    struct ScreenTriangle
+    {
+        ScreenVertex v[3];
+        float depthBias; // Added to 1 / depth so lines win ties with the surface
+    };
+
+    // Marker drawn as a flat disc, like an unlit glutSolidSphere
+    struct ScreenDisc
+    {
+        float x, y, radius; // Screen
+        float depth, worldRadius; // Eye space
+        float colour[3];
+    };
+
+    // Disc of a marker sphere of the given world radius; false if it is
+    // off screen or crosses the near plane
+    static bool projectDisc(const Point3D &centre, float radius, const float *colour,
+                            const ViewTransform &view, ScreenDisc &disc);
+
+private:
+    ThreadPool *pool;
+
+    // Per-frame scratch, reused
+    std::vector<ScreenVertex> vertices;
+    std::vector<float> eyeDepth;
+    std::vector<std::vector<ScreenTriangle>> extraTriangles; // Per binning group
+    std::vector<ScreenDisc> discs;
+    std::vector<std::vector<uint32_t>> bins; // [group * tileCount + tile]
+    int tileColumns = 0, tileRows = 0;
+    int groupCount = 0;
+
+    void transformVertices(const GridMeshF &mesh, const float *colours, const RenderSettings &settings,
+                           const ViewTransform &view);
+    void binMesh(const GridMeshF &mesh, const ViewTransform &view);
+    void addOverlay(const OptimizationResult *path, const RenderSettings &settings, const ViewTransform &view);
+    void addLine(const float *a, const float *b, const float *colour, float width, const ViewTransform &view);
+    void binTriangle(int group, uint32_t id, const ScreenVertex *v0, const ScreenVertex *v1,
+                     const ScreenVertex *v2, int width, int height);
+    void rasterizeTile(int tile, const GridMeshF &mesh, const RenderSettings &settings, Image &image);
+
+public:
+    // pool defaults to ThreadPool::shared()
+    explicit SoftwareRenderer(ThreadPool *pool = nullptr);
+
+    // Render into image, resized to the settings. colours are optional
+    // per-vertex RGB triples (e.g. basin colours) replacing the surface
+    // colour; path may be null.
+    void render(const GridMeshF &mesh, const OptimizationResult *path, const RenderSettings &settings,
+                Image &image, const float *colours = nullptr);
+
+    Image render(const GridMeshF &mesh, const OptimizationResult *path = nullptr,
+                 const RenderSettings &settings = RenderSettings());
+};
+
+#endif
@@ -0,0 +1,67 @@
+#ifndef SPSC_QUEUE_H
+#define SPSC_QUEUE_H
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+// Bounded lock-free queue for exactly one producer thread and one consumer
+// thread. The capacity is rounded up to a power of two. push() fails
+// instead of blocking when the queue is full, so the producer never waits
+// on the consumer.
+template <typename T>
+class SpscQueue
+{
+private:
+    std::vector<T> slots;
+    size_t mask;
+
+    // Producer and consumer indices on separate cache lines; both only grow
+    alignas(64) std::atomic<size_t> head; // Next slot to write
+    alignas(64) std::atomic<size_t> tail; // Next slot to read
+
+public:
+    explicit SpscQueue(size_t capacity = 1024) : head(0), tail(0)
+    {
+        size_t size = 1;
+        while (size < capacity)
+            size <<= 1;
+        slots.resize(size);
+        mask = size - 1;
+    }
+
+    SpscQueue(const SpscQueue &) = delete;
+    SpscQueue &operator=(const SpscQueue &) = delete;
+
+    size_t capacity() const { return slots.size(); }
+
+    // Producer only
+    bool push(const T &value)
+    {
+        size_t h = head.load(std::memory_order_relaxed);
+        if (h - tail.load(std::memory_order_acquire) == slots.size())
+            return false;
+        slots[h & mask] = value;
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer only
+    bool pop(T &value)
+    {
+        size_t t = tail.load(std::memory_order_relaxed);
+        if (t == head.load(std::memory_order_acquire))
+            return false;
+        value = slots[t & mask];
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Approximate when called while the other side is active
+    bool empty() const
+    {
+        return tail.load(std::memory_order_acquire) == head.load(std::memory_order_acquire);
+    }
+};
+
+#endif
@@ -0,0 +1,158 @@
+#ifndef STATIC_OPTIMIZER_H
+#define STATIC_OPTIMIZER_H
+
+#include "Optimizer.h"
+#include <cmath>
+#include <iostream>
+
+// Optimizers templated on the surface type. F is any type with
+// evaluate(x, y), gradient(x, y, gx, gy) and hessian(x, y, hxx, hxy, hyy),
+// such as StaticSurface subclasses, so every call inlines. Results match
+// the virtual GradientDescent / NewtonOptimizer given the same derivatives.
+
+template <typename F>
+class StaticGradientDescent
+{
+private:
+    const F &function;
+    double learningRate;
+    int maxIterations;
+    double tolerance;
+    PathRecording pathRecording;
+
+public:
+    StaticGradientDescent(const F &f, double lr = 0.1,
+                          int maxIter = 1000, double tol = 1e-6)
+        : function(f), learningRate(lr), maxIterations(maxIter), tolerance(tol) {}
+
+    // Path storage as Optimizer::setPathRecording
+    void setPathRecording(const PathRecording &recording) { pathRecording = recording; }
+    const PathRecording &getPathRecording() const { return pathRecording; }
+
+    OptimizationResult optimize(double startX, double startY) const
+    {
+        OptimizationResult result;
+        result.converged = false;
+        result.iterations = 0;
+        PathRecorder recorder(pathRecording, result.path, result.compactPath, maxIterations);
+
+        double x = startX, y = startY;
+        double z = function.evaluate(x, y);
+
+        for (int iter = 0; iter < maxIterations; ++iter)
+        {
+            recorder.record(x, y, z);
+
+            double gx, gy;
+            function.gradient(x, y, gx, gy);
+
+            if (std::sqrt(gx * gx + gy * gy) < tolerance)
+            {
+                result.converged = true;
+                result.iterations = iter;
+                break;
+            }
+
+            x = x - learningRate * gx;
+            y = y - learningRate * gy;
+            z = function.evaluate(x, y);
+
+            result.iterations = iter + 1;
+        }
+
+        recorder.finish();
+        result.minimumValue = z;
+        result.minimumPoint = Point3D(x, y, z);
+
+        return result;
+    }
+};
+
+// Newton's method with the surface's own Hessian
+template <typename F>
+class StaticNewton
+{
+private:
+    const F &function;
+    double learningRate;
+    int maxIterations;
+    double tolerance;
+    PathRecording pathRecording;
+
+public:
+    StaticNewton(const F &f, double lr = 1.0,
+                 int maxIter = 1000, double tol = 1e-6)
+        : function(f), learningRate(lr), maxIterations(maxIter), tolerance(tol) {}
+
+    // Path storage as Optimizer::setPathRecording
+    void setPathRecording(const PathRecording &recording) { pathRecording = recording; }
+    const PathRecording &getPathRecording() const { return pathRecording; }
+
+    OptimizationResult optimize(double startX, double startY) const
+    {
+        OptimizationResult result;
+        result.converged = false;
+        result.iterations = 0;
+        PathRecorder recorder(pathRecording, result.path, result.compactPath, maxIterations);
+
+        double x = startX, y = startY;
+        double z = function.evaluate(x, y);
+
+        for (int iter = 0; iter < maxIterations; ++iter)
+        {
+            recorder.record(x, y, z);
+
+            double fxx, fxy, fyy;
+            function.hessian(x, y, fxx, fxy, fyy);
+
+            double det = fxx * fyy - fxy * fxy;
+            if (std::abs(det) < 1e-10)
+            {
+                std::cout << "Singular Hessian encountered" << std::endl;
+                break;
+            }
+
+            double gx, gy;
+            function.gradient(x, y, gx, gy);
+
+            if (std::sqrt(gx * gx + gy * gy) < tolerance)
+            {
+                result.converged = true;
+                result.iterations = iter;
+                break;
+            }
+
+            // Newton update: x_new = x_old - H^(-1) * grad f
+            double dx = (fyy * gx - fxy * gy) / det;
+            double dy = (fxx * gy - fxy * gx) / det;
+
+            x = x - learningRate * dx;
+            y = y - learningRate * dy;
+            z = function.evaluate(x, y);
+
+            result.iterations = iter + 1;
+        }
+
+        recorder.finish();
+        result.minimumValue = z;
+        result.minimumPoint = Point3D(x, y, z);
+
+        return result;
+    }
+};
+
+template <typename F>
+StaticGradientDescent<F> makeGradientDescent(const F &f, double lr = 0.1,
+                                             int maxIter = 1000, double tol = 1e-6)
+{
+    return StaticGradientDescent<F>(f, lr, maxIter, tol);
+}
+
+template <typename F>
+StaticNewton<F> makeNewton(const F &f, double lr = 1.0,
+                           int maxIter = 1000, double tol = 1e-6)
+{
+    return StaticNewton<F>(f, lr, maxIter, tol);
+}
+
+#endif
@@ -0,0 +1,191 @@
+#ifndef STATIC_SURFACE_H
+#define STATIC_SURFACE_H
+
+#include "Surface.h"
+#include "SurfaceExpr.h"
+
+// CRTP base for surfaces resolved at compile time.
+// Derived implements evaluate(x, y) and may shadow gradient()/hessian();
+// the defaults use central differences. Templates such as
+// StaticGradientDescent call these without any virtual dispatch.
+template <typename Derived>
+class StaticSurface
+{
+protected:
+    static constexpr double h = 0.0001; // Finite-difference step
+
+    const Derived &derived() const { return static_cast<const Derived &>(*this); }
+
+public:
+    // Evaluate in the caller's precision; the default goes through double
+    template <typename T>
+    T evaluateScalar(T x, T y) const
+    {
+        return static_cast<T>(derived().evaluate(x, y));
+    }
+
+    void gradient(double x, double y, double &gx, double &gy) const
+    {
+        gx = (derived().evaluate(x + h, y) - derived().evaluate(x - h, y)) / (2 * h);
+        gy = (derived().evaluate(x, y + h) - derived().evaluate(x, y - h)) / (2 * h);
+    }
+
+    void hessian(double x, double y, double &hxx, double &hxy, double &hyy) const
+    {
+        double f = derived().evaluate(x, y);
+        hxx = (derived().evaluate(x + h, y) - 2 * f + derived().evaluate(x - h, y)) / (h * h);
+        hyy = (derived().evaluate(x, y + h) - 2 * f + derived().evaluate(x, y - h)) / (h * h);
+        hxy = (derived().evaluate(x + h, y + h) - derived().evaluate(x + h, y - h) -
+               derived().evaluate(x - h, y + h) + derived().evaluate(x - h, y - h)) /
+              (4 * h * h);
+    }
+};
+
+// Surface defined by an expression; derivatives are exact and inlined
+template <typename E>
+class ExprFunction : public StaticSurface<ExprFunction<E>>
+{
+private:
+    E expression;
+
+public:
+    explicit ExprFunction(const E &e) : expression(e) {}
+
+    double evaluate(double x, double y) const
+    {
+        return expr::value(expression, x, y);
+    }
+
+    // Native float or double evaluation of the expression
+    template <typename T>
+    T evaluateScalar(T x, T y) const
+    {
+        return expression.eval(x, y);
+    }
+
+    void gradient(double x, double y, double &gx, double &gy) const
+    {
+        expr::Dual1 d = expr::gradient(expression, x, y);
+        gx = d.dx;
+        gy = d.dy;
+    }
+
+    void hessian(double x, double y, double &hxx, double &hxy, double &hyy) const
+    {
+        expr::Dual2 d = expr::hessian(expression, x, y);
+        hxx = d.dxx;
+        hxy = d.dxy;
+        hyy = d.dyy;
+    }
+
+    const E &getExpression() const { return expression; }
+};
+
+template <typename E>
+ExprFunction<E> makeFunction(const expr::Expr<E> &e)
+{
+    return ExprFunction<E>(e.self());
+}
+
+// Exposes a static surface through the virtual Surface interface so it
+// works with the existing optimizers and Visualizer
+template <typename F>
+class SurfaceAdapter : public Surface
+{
+private:
+    F function;
+
+public:
+    explicit SurfaceAdapter(const F &f) : function(f) {}
+
+    double evaluate(double x, double y) const override
+    {
+        return function.evaluate(x, y);
+    }
+
+    double partialX(double x, double y) const override
+    {
+        double gx, gy;
+        function.gradient(x, y, gx, gy);
+        return gx;
+    }
+
+    double partialY(double x, double y) const override
+    {
+        double gx, gy;
+        function.gradient(x, y, gx, gy);
+        return gy;
+    }
+
+    // Both partials from one pass
+    Point3D gradient(double x, double y) const override
+    {
+        double gx, gy;
+        function.gradient(x, y, gx, gy);
+        return Point3D(gx, gy, 0);
+    }
+
+    void hessian(double x, double y, double &fxx, double &fxy, double &fyy) const override
+    {
+        function.hessian(x, y, fxx, fxy, fyy);
+    }
+
+    void evaluateBatch(const double *x, const double *y, double *z, size_t count) const override
+    {
+        for (size_t k = 0; k < count; ++k)
+            z[k] = function.evaluateScalar(x[k], y[k]);
+    }
+
+    void evaluateBatch(const float *x, const float *y, float *z, size_t count) const override
+    {
+        for (size_t k = 0; k < count; ++k)
+            z[k] = function.evaluateScalar(x[k], y[k]);
+    }
+
+    void gradientBatch(const double *x, const double *y,
+                       double *gx, double *gy, size_t count) const override
+    {
+        for (size_t k = 0; k < count; ++k)
+            function.gradient(x[k], y[k], gx[k], gy[k]);
+    }
+
+    void gradientBatch(const float *x, const float *y,
+                       float *gx, float *gy, size_t count) const override
+    {
+        for (size_t k = 0; k < count; ++k)
+        {
+            double dx, dy;
+            function.gradient(x[k], y[k], dx, dy);
+            gx[k] = static_cast<float>(dx);
+            gy[k] = static_cast<float>(dy);
+        }
+    }
+
+    const F &getFunction() const { return function; }
+};
+
+template <typename E>
+SurfaceAdapter<ExprFunction<E>> makeSurface(const expr::Expr<E> &e)
+{
+    return SurfaceAdapter<ExprFunction<E>>(ExprFunction<E>(e.self()));
+}
+
+// Built-in surfaces without virtual calls
+using StaticParaboloid = ExprFunction<expr::Add<expr::Mul<expr::VarX, expr::VarX>,
+                                                expr::Mul<expr::VarY, expr::VarY>>>;
+using StaticSaddle = ExprFunction<expr::Sub<expr::Mul<expr::VarX, expr::VarX>,
+                                            expr::Mul<expr::VarY, expr::VarY>>>;
+
+inline StaticParaboloid makeParaboloid()
+{
+    using namespace expr;
+    return makeFunction(X * X + Y * Y);
+}
+
+inline StaticSaddle makeSaddle()
+{
+    using namespace expr;
+    return makeFunction(X * X - Y * Y);
+}
+
+#endif
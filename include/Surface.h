@@ -2,15 +2,28 @@
 #define SURFACE_H
 
 #include "Point3D.h"
+#include "HeightField.h"
+#include "SurfaceExpr.h"
+#include "Objective.h"
+#include <cstddef>
 #include <functional>
 #include <vector>
 
-// Abstract base class for surfaces
-class Surface
+// Abstract base class for surfaces: the two-variable Objective, with
+// point (x, y) as the vector {x, y}
+class Surface : public Objective
 {
 public:
     virtual ~Surface() {}
 
+    // Objective interface, forwarding to evaluate/gradient and the batch paths
+    size_t dimension() const override { return 2; }
+    double value(const double *p) const override { return evaluate(p[0], p[1]); }
+    double valueAndGradient(const double *p, double *grad) const override;
+    void valueBatch(const double *points, size_t count, double *values) const override;
+    void valueAndGradientBatch(const double *points, size_t count,
+                               double *values, double *grads) const override;
+
     // Pure virtual: Calculate z = f(x, y)
     virtual double evaluate(double x, double y) const = 0;
 
@@ -20,13 +33,46 @@ public:
     // Calculate partial derivative with respect to y
     virtual double partialY(double x, double y) const;
 
-    // Calculate gradient vector at (x, y)
-    Point3D gradient(double x, double y) const;
+    // Calculate gradient vector at (x, y); override to compute both partials in one pass
+    virtual Point3D gradient(double x, double y) const;
+
+    // Second partial derivatives; the defaults difference partialX/partialY
+    virtual double partialXX(double x, double y) const;
+    virtual double partialYY(double x, double y) const;
+    virtual double partialXY(double x, double y) const;
+
+    // Hessian [[fxx, fxy], [fxy, fyy]] at (x, y); override to compute it in one pass.
+    // The default differences each first partial once per entry: 12 evaluations
+    // when the partials are finite differences too.
+    virtual void hessian(double x, double y, double &fxx, double &fxy, double &fyy) const;
+
+    // Batch evaluation: z[k] = f(x[k], y[k]). Override with plain loops the
+    // compiler can vectorize; the float overloads keep previews in single
+    // precision end to end. Overriding one overload hides the others, so
+    // subclasses override all of them or add "using Surface::evaluateBatch".
+    virtual void evaluateBatch(const double *x, const double *y, double *z, size_t count) const;
+    virtual void evaluateBatch(const float *x, const float *y, float *z, size_t count) const;
+    virtual void gradientBatch(const double *x, const double *y,
+                               double *gx, double *gy, size_t count) const;
+    virtual void gradientBatch(const float *x, const float *y,
+                               float *gx, float *gy, size_t count) const;
 
     // Generate mesh points for visualization
     std::vector<Point3D> generateMesh(double xMin, double xMax,
                                       double yMin, double yMax,
                                       int resolution) const;
+
+    // Sample heights (and optionally unit normals) on a (resolution + 1)^2 grid
+    // through the batch path in the given precision (float or double)
+    template <typename Scalar>
+    HeightFieldT<Scalar> sampleHeights(double xMin, double xMax,
+                                       double yMin, double yMax,
+                                       int resolution, bool withNormals = false) const;
+
+    // Single-precision height field for rendering
+    HeightField sampleHeightField(double xMin, double xMax,
+                                  double yMin, double yMax,
+                                  int resolution, bool withNormals = false) const;
 };
 
 // Concrete implementation: Paraboloid z = x^2 + y^2
@@ -36,6 +82,16 @@ public:
     double evaluate(double x, double y) const override;
     double partialX(double x, double y) const override;
     double partialY(double x, double y) const override;
+    double partialXX(double x, double y) const override;
+    double partialYY(double x, double y) const override;
+    double partialXY(double x, double y) const override;
+
+    void evaluateBatch(const double *x, const double *y, double *z, size_t count) const override;
+    void evaluateBatch(const float *x, const float *y, float *z, size_t count) const override;
+    void gradientBatch(const double *x, const double *y,
+                       double *gx, double *gy, size_t count) const override;
+    void gradientBatch(const float *x, const float *y,
+                       float *gx, float *gy, size_t count) const override;
 };
 
 // Saddle surface z = x^2 - y^2
@@ -45,17 +101,41 @@ public:
     double evaluate(double x, double y) const override;
     double partialX(double x, double y) const override;
     double partialY(double x, double y) const override;
+    double partialXX(double x, double y) const override;
+    double partialYY(double x, double y) const override;
+    double partialXY(double x, double y) const override;
+
+    void evaluateBatch(const double *x, const double *y, double *z, size_t count) const override;
+    void evaluateBatch(const float *x, const float *y, float *z, size_t count) const override;
+    void gradientBatch(const double *x, const double *y,
+                       double *gx, double *gy, size_t count) const override;
+    void gradientBatch(const float *x, const float *y,
+                       float *gx, float *gy, size_t count) const override;
 };
 
 // Custom function surface (uses lambda/function)
 class CustomSurface : public Surface
 {
+public:
+    // Value, gradient and Hessian at (x, y), e.g. CompiledEquation::evaluateDerivatives
+    typedef std::function<expr::Dual2(double, double)> DerivativeFunction;
+
 private:
     std::function<double(double, double)> func;
+    DerivativeFunction derivatives; // Null: finite differences
 
 public:
-    CustomSurface(std::function<double(double, double)> f) : func(f) {}
+    CustomSurface(std::function<double(double, double)> f, DerivativeFunction d = nullptr)
+        : func(f), derivatives(d) {}
     double evaluate(double x, double y) const override;
+
+    double partialX(double x, double y) const override;
+    double partialY(double x, double y) const override;
+    Point3D gradient(double x, double y) const override;
+    double partialXX(double x, double y) const override;
+    double partialYY(double x, double y) const override;
+    double partialXY(double x, double y) const override;
+    void hessian(double x, double y, double &fxx, double &fxy, double &fyy) const override;
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,286 @@
+#ifndef SURFACE_EXPR_H
+#define SURFACE_EXPR_H
+
+#include <cmath>
+
+// Compile-time expression DSL for surfaces z = f(x, y).
+//
+//     using namespace expr;
+//     auto f = sin(X) * cos(Y) + X * X;
+//
+// builds an expression type whose eval() is instantiated for plain doubles
+// (value), Dual1 (value + gradient) and Dual2 (value + gradient + Hessian).
+// Derivatives come from forward-mode differentiation, so everything inlines
+// and no derivative has to be written by hand.
+namespace expr
+{
+    // Value and first partial derivatives
+    struct Dual1
+    {
+        double v, dx, dy;
+
+        Dual1(double value = 0.0) : v(value), dx(0.0), dy(0.0) {}
+        Dual1(double value, double dx, double dy) : v(value), dx(dx), dy(dy) {}
+
+        // Apply a scalar function with derivatives f1, f2 at v
+        Dual1 chain(double f0, double f1, double) const { return Dual1(f0, f1 * dx, f1 * dy); }
+    };
+
+    // Value, first and second partial derivatives
+    struct Dual2
+    {
+        double v, dx, dy, dxx, dxy, dyy;
+
+        Dual2(double value = 0.0) : v(value), dx(0.0), dy(0.0), dxx(0.0), dxy(0.0), dyy(0.0) {}
+        Dual2(double value, double dx, double dy, double dxx, double dxy, double dyy)
+            : v(value), dx(dx), dy(dy), dxx(dxx), dxy(dxy), dyy(dyy) {}
+
+        Dual2 chain(double f0, double f1, double f2) const
+        {
+            return Dual2(f0, f1 * dx, f1 * dy,
+                         f2 * dx * dx + f1 * dxx,
+                         f2 * dx * dy + f1 * dxy,
+                         f2 * dy * dy + f1 * dyy);
+        }
+    };
+
+    // Dual arithmetic
+    inline Dual1 operator+(const Dual1 &a, const Dual1 &b) { return Dual1(a.v + b.v, a.dx + b.dx, a.dy + b.dy); }
+    inline Dual1 operator-(const Dual1 &a, const Dual1 &b) { return Dual1(a.v - b.v, a.dx - b.dx, a.dy - b.dy); }
+    inline Dual1 operator-(const Dual1 &a) { return Dual1(-a.v, -a.dx, -a.dy); }
+    inline Dual1 operator*(const Dual1 &a, const Dual1 &b)
+    {
+        return Dual1(a.v * b.v, a.dx * b.v + a.v * b.dx, a.dy * b.v + a.v * b.dy);
+    }
+    inline Dual1 operator/(const Dual1 &a, const Dual1 &b)
+    {
+        double inv = 1.0 / b.v;
+        return a * b.chain(inv, -inv * inv, 2.0 * inv * inv * inv);
+    }
+
+    inline Dual2 operator+(const Dual2 &a, const Dual2 &b)
+    {
+        return Dual2(a.v + b.v, a.dx + b.dx, a.dy + b.dy, a.dxx + b.dxx, a.dxy + b.dxy, a.dyy + b.dyy);
+    }
+    inline Dual2 operator-(const Dual2 &a, const Dual2 &b)
+    {
+        return Dual2(a.v - b.v, a.dx - b.dx, a.dy - b.dy, a.dxx - b.dxx, a.dxy - b.dxy, a.dyy - b.dyy);
+    }
+    inline Dual2 operator-(const Dual2 &a) { return Dual2(-a.v, -a.dx, -a.dy, -a.dxx, -a.dxy, -a.dyy); }
+    inline Dual2 operator*(const Dual2 &a, const Dual2 &b)
+    {
+        return Dual2(a.v * b.v,
+                     a.dx * b.v + a.v * b.dx,
+                     a.dy * b.v + a.v * b.dy,
+                     a.dxx * b.v + 2.0 * a.dx * b.dx + a.v * b.dxx,
+                     a.dxy * b.v + a.dx * b.dy + a.dy * b.dx + a.v * b.dxy,
+                     a.dyy * b.v + 2.0 * a.dy * b.dy + a.v * b.dyy);
+    }
+    inline Dual2 operator/(const Dual2 &a, const Dual2 &b)
+    {
+        double inv = 1.0 / b.v;
+        return a * b.chain(inv, -inv * inv, 2.0 * inv * inv * inv);
+    }
+
+    // Elementary functions on duals (found by ADL from the expression nodes)
+    template <typename D>
+    D dualSin(const D &u) { return u.chain(std::sin(u.v), std::cos(u.v), -std::sin(u.v)); }
+    template <typename D>
+    D dualCos(const D &u) { return u.chain(std::cos(u.v), -std::sin(u.v), -std::cos(u.v)); }
+    template <typename D>
+    D dualTan(const D &u)
+    {
+        double t = std::tan(u.v);
+        double sec2 = 1.0 + t * t;
+        return u.chain(t, sec2, 2.0 * t * sec2);
+    }
+    template <typename D>
+    D dualExp(const D &u)
+    {
+        double e = std::exp(u.v);
+        return u.chain(e, e, e);
+    }
+    template <typename D>
+    D dualLog(const D &u) { return u.chain(std::log(u.v), 1.0 / u.v, -1.0 / (u.v * u.v)); }
+    template <typename D>
+    D dualSqrt(const D &u)
+    {
+        double s = std::sqrt(u.v);
+        return u.chain(s, 0.5 / s, -0.25 / (s * u.v));
+    }
+    template <typename D>
+    D dualAbs(const D &u) { return u.chain(std::abs(u.v), u.v < 0 ? -1.0 : 1.0, 0.0); }
+    template <typename D>
+    D dualPow(const D &u, double n)
+    {
+        return u.chain(std::pow(u.v, n), n * std::pow(u.v, n - 1.0), n * (n - 1.0) * std::pow(u.v, n - 2.0));
+    }
+
+#define SURFACE_EXPR_DUAL_FUNCTION(name, impl)                  \
+    inline Dual1 name(const Dual1 &u) { return impl(u); }       \
+    inline Dual2 name(const Dual2 &u) { return impl(u); }
+
+    SURFACE_EXPR_DUAL_FUNCTION(sin, dualSin)
+    SURFACE_EXPR_DUAL_FUNCTION(cos, dualCos)
+    SURFACE_EXPR_DUAL_FUNCTION(tan, dualTan)
+    SURFACE_EXPR_DUAL_FUNCTION(exp, dualExp)
+    SURFACE_EXPR_DUAL_FUNCTION(log, dualLog)
+    SURFACE_EXPR_DUAL_FUNCTION(sqrt, dualSqrt)
+    SURFACE_EXPR_DUAL_FUNCTION(abs, dualAbs)
+
+#undef SURFACE_EXPR_DUAL_FUNCTION
+
+    inline Dual1 pow(const Dual1 &u, double n) { return dualPow(u, n); }
+    inline Dual2 pow(const Dual2 &u, double n) { return dualPow(u, n); }
+
+    // Base of all expression nodes
+    template <typename Derived>
+    struct Expr
+    {
+        const Derived &self() const { return static_cast<const Derived &>(*this); }
+    };
+
+    struct VarX : Expr<VarX>
+    {
+        template <typename T>
+        T eval(const T &x, const T &) const { return x; }
+    };
+
+    struct VarY : Expr<VarY>
+    {
+        template <typename T>
+        T eval(const T &, const T &y) const { return y; }
+    };
+
+    struct Constant : Expr<Constant>
+    {
+        double value;
+        explicit Constant(double v) : value(v) {}
+
+        template <typename T>
+        T eval(const T &, const T &) const { return T(value); }
+    };
+
+    // Coordinate placeholders
+    inline constexpr VarX X{};
+    inline constexpr VarY Y{};
+
+#define SURFACE_EXPR_BINARY_NODE(Node, op)                                          \
+    template <typename L, typename R>                                               \
+    struct Node : Expr<Node<L, R>>                                                  \
+    {                                                                               \
+        L left;                                                                     \
+        R right;                                                                    \
+        Node(const L &l, const R &r) : left(l), right(r) {}                         \
+                                                                                    \
+        template <typename T>                                                       \
+        T eval(const T &x, const T &y) const                                        \
+        {                                                                           \
+            return left.eval(x, y) op right.eval(x, y);                             \
+        }                                                                           \
+    };                                                                              \
+                                                                                    \
+    template <typename L, typename R>                                               \
+    Node<L, R> operator op(const Expr<L> &l, const Expr<R> &r)                      \
+    {                                                                               \
+        return Node<L, R>(l.self(), r.self());                                      \
+    }                                                                               \
+    template <typename L>                                                           \
+    Node<L, Constant> operator op(const Expr<L> &l, double r)                       \
+    {                                                                               \
+        return Node<L, Constant>(l.self(), Constant(r));                            \
+    }                                                                               \
+    template <typename R>                                                           \
+    Node<Constant, R> operator op(double l, const Expr<R> &r)                       \
+    {                                                                               \
+        return Node<Constant, R>(Constant(l), r.self());                            \
+    }
+
+    SURFACE_EXPR_BINARY_NODE(Add, +)
+    SURFACE_EXPR_BINARY_NODE(Sub, -)
+    SURFACE_EXPR_BINARY_NODE(Mul, *)
+    SURFACE_EXPR_BINARY_NODE(Div, /)
+
+#undef SURFACE_EXPR_BINARY_NODE
+
+    template <typename E>
+    struct Negate : Expr<Negate<E>>
+    {
+        E arg;
+        explicit Negate(const E &e) : arg(e) {}
+
+        template <typename T>
+        T eval(const T &x, const T &y) const { return -arg.eval(x, y); }
+    };
+
+    template <typename E>
+    Negate<E> operator-(const Expr<E> &e) { return Negate<E>(e.self()); }
+
+#define SURFACE_EXPR_UNARY_FUNCTION(Node, name)                                     \
+    template <typename E>                                                           \
+    struct Node : Expr<Node<E>>                                                     \
+    {                                                                               \
+        E arg;                                                                      \
+        explicit Node(const E &e) : arg(e) {}                                       \
+                                                                                    \
+        template <typename T>                                                       \
+        T eval(const T &x, const T &y) const                                        \
+        {                                                                           \
+            using std::name;                                                        \
+            return name(arg.eval(x, y));                                            \
+        }                                                                           \
+    };                                                                              \
+                                                                                    \
+    template <typename E>                                                           \
+    Node<E> name(const Expr<E> &e) { return Node<E>(e.self()); }
+
+    SURFACE_EXPR_UNARY_FUNCTION(Sin, sin)
+    SURFACE_EXPR_UNARY_FUNCTION(Cos, cos)
+    SURFACE_EXPR_UNARY_FUNCTION(Tan, tan)
+    SURFACE_EXPR_UNARY_FUNCTION(Exp, exp)
+    SURFACE_EXPR_UNARY_FUNCTION(Log, log)
+    SURFACE_EXPR_UNARY_FUNCTION(Sqrt, sqrt)
+    SURFACE_EXPR_UNARY_FUNCTION(Abs, abs)
+
+#undef SURFACE_EXPR_UNARY_FUNCTION
+
+    // Power with a constant exponent
+    template <typename E>
+    struct Pow : Expr<Pow<E>>
+    {
+        E arg;
+        double exponent;
+        Pow(const E &e, double n) : arg(e), exponent(n) {}
+
+        template <typename T>
+        T eval(const T &x, const T &y) const
+        {
+            using std::pow;
+            return pow(arg.eval(x, y), exponent);
+        }
+    };
+
+    template <typename E>
+    Pow<E> pow(const Expr<E> &e, double n) { return Pow<E>(e.self(), n); }
+
+    // Value, gradient and Hessian of an expression at a point
+    template <typename E>
+    inline double value(const Expr<E> &e, double x, double y)
+    {
+        return e.self().eval(x, y);
+    }
+
+    template <typename E>
+    inline Dual1 gradient(const Expr<E> &e, double x, double y)
+    {
+        return e.self().eval(Dual1(x, 1.0, 0.0), Dual1(y, 0.0, 1.0));
+    }
+
+    template <typename E>
+    inline Dual2 hessian(const Expr<E> &e, double x, double y)
+    {
+        return e.self().eval(Dual2(x, 1.0, 0.0, 0.0, 0.0, 0.0), Dual2(y, 0.0, 1.0, 0.0, 0.0, 0.0));
+    }
+}
+
+#endif
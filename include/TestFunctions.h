@@ -0,0 +1,122 @@
+#ifndef TEST_FUNCTIONS_H
+#define TEST_FUNCTIONS_H
+
+#include "Surface.h"
+#include <memory>
+#include <string>
+#include <vector>
+
+// Standard optimization test functions with analytic gradients.
+// Each lists its usual start point and global minimum.
+
+// Rosenbrock: (1 - x)^2 + 100 (y - x^2)^2
+// Narrow curved valley; start (-1.2, 1), minimum 0 at (1, 1)
+class RosenbrockSurface : public Surface
+{
+public:
+    double evaluate(double x, double y) const override;
+    double partialX(double x, double y) const override;
+    double partialY(double x, double y) const override;
+    Point3D gradient(double x, double y) const override;
+    void hessian(double x, double y, double &fxx, double &fxy, double &fyy) const override;
+};
+
+// Himmelblau: (x^2 + y - 11)^2 + (x + y^2 - 7)^2
+// Four minima of value 0, e.g. (3, 2); start (0, 0)
+class HimmelblauSurface : public Surface
+{
+public:
+    double evaluate(double x, double y) const override;
+    double partialX(double x, double y) const override;
+    double partialY(double x, double y) const override;
+    Point3D gradient(double x, double y) const override;
+    void hessian(double x, double y, double &fxx, double &fxy, double &fyy) const override;
+};
+
+// Beale: (1.5 - x + xy)^2 + (2.25 - x + xy^2)^2 + (2.625 - x + xy^3)^2
+// Flat plateaus and steep ridges; start (1, 1), minimum 0 at (3, 0.5)
+class BealeSurface : public Surface
+{
+public:
+    double evaluate(double x, double y) const override;
+    double partialX(double x, double y) const override;
+    double partialY(double x, double y) const override;
+    Point3D gradient(double x, double y) const override;
+    void hessian(double x, double y, double &fxx, double &fxy, double &fyy) const override;
+};
+
+// Booth: (x + 2y - 7)^2 + (2x + y - 5)^2
+// Convex quadratic; start (0, 0), minimum 0 at (1, 3)
+class BoothSurface : public Surface
+{
+public:
+    double evaluate(double x, double y) const override;
+    double partialX(double x, double y) const override;
+    double partialY(double x, double y) const override;
+    Point3D gradient(double x, double y) const override;
+    void hessian(double x, double y, double &fxx, double &fxy, double &fyy) const override;
+};
+
+// Rastrigin: 20 + x^2 - 10 cos(2 pi x) + y^2 - 10 cos(2 pi y)
+// Regular grid of local minima; start (3, 3), minimum 0 at (0, 0)
+class RastriginSurface : public Surface
+{
+public:
+    double evaluate(double x, double y) const override;
+    double partialX(double x, double y) const override;
+    double partialY(double x, double y) const override;
+    Point3D gradient(double x, double y) const override;
+    void hessian(double x, double y, double &fxx, double &fxy, double &fyy) const override;
+};
+
+// Ackley: -20 exp(-0.2 sqrt((x^2 + y^2) / 2)) - exp((cos 2 pi x + cos 2 pi y) / 2) + e + 20
+// Nearly flat outer region with many shallow pits; start (2.5, 2.5),
+// minimum 0 at (0, 0), where it is not differentiable
+class AckleySurface : public Surface
+{
+public:
+    double evaluate(double x, double y) const override;
+    double partialX(double x, double y) const override;
+    double partialY(double x, double y) const override;
+    Point3D gradient(double x, double y) const override;
+    void hessian(double x, double y, double &fxx, double &fxy, double &fyy) const override;
+};
+
+// Six-hump camel: (4 - 2.1 x^2 + x^4 / 3) x^2 + xy + (4 y^2 - 4) y^2
+// Six minima, two global of value -1.0316 at (0.0898, -0.7126) and
+// (-0.0898, 0.7126); start (-1.5, 1)
+class SixHumpCamelSurface : public Surface
+{
+public:
+    double evaluate(double x, double y) const override;
+    double partialX(double x, double y) const override;
+    double partialY(double x, double y) const override;
+    Point3D gradient(double x, double y) const override;
+    void hessian(double x, double y, double &fxx, double &fxy, double &fyy) const override;
+};
+
+// Extended Rosenbrock in n variables:
+// sum over i of 100 (x[i+1] - x[i]^2)^2 + (1 - x[i])^2
+// Start (-1.2, 1, -1.2, 1, ...), minimum 0 at (1, ..., 1)
+class ExtendedRosenbrock : public Objective
+{
+private:
+    size_t n;
+
+public:
+    explicit ExtendedRosenbrock(size_t n) : n(n) {}
+
+    size_t dimension() const override { return n; }
+    double value(const double *x) const override;
+    double valueAndGradient(const double *x, double *grad) const override;
+};
+
+// Surface for a command-line name: any of surfaceNames(). Throws
+// std::runtime_error for other names.
+std::unique_ptr<Surface> namedSurface(const std::string &name);
+std::vector<std::string> surfaceNames();
+
+// Items of a comma-separated command-line list, empty items dropped
+std::vector<std::string> splitList(const std::string &text);
+
+#endif
@@ -0,0 +1,60 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed-size pool of worker threads with a FIFO task queue.
+class ThreadPool
+{
+private:
+    std::vector<std::thread> workers;
+    std::deque<std::function<void()>> tasks;
+    std::mutex mutex;
+    std::condition_variable available;
+    bool stopping;
+
+    void workerLoop(unsigned index);
+    void enqueue(std::function<void()> task);
+
+public:
+    // threadCount = 0 uses one worker per hardware thread
+    explicit ThreadPool(unsigned threadCount = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    unsigned size() const { return static_cast<unsigned>(workers.size()); }
+
+    // Queue a task; the future carries its result or exception
+    template <typename F>
+    auto submit(F &&task) -> std::future<decltype(task())>
+    {
+        using Result = decltype(task());
+        auto packaged = std::make_shared<std::packaged_task<Result()>>(std::forward<F>(task));
+        std::future<Result> result = packaged->get_future();
+        enqueue([packaged]()
+                { (*packaged)(); });
+        return result;
+    }
+
+    // Run body(chunkBegin, chunkEnd) over [begin, end) in chunks of about
+    // grain items and wait for all of them. The calling thread takes part,
+    // so nested calls from inside a task cannot deadlock. The first
+    // exception thrown by body is rethrown here.
+    void parallelFor(size_t begin, size_t end, size_t grain,
+                     const std::function<void(size_t, size_t)> &body);
+
+    // Process-wide pool sized to the hardware
+    static ThreadPool &shared();
+};
+
+#endif
@@ -0,0 +1,85 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include "Instrumentation.h"
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+// Trace-event recording, written as the JSON format read by chrome://tracing
+// and Perfetto. Every thread appends to its own buffer without locking, so
+// tracing a parallel run does not serialize it; writeJson merges the
+// buffers into one track per thread. Events are only recorded between
+// start() and stop(), and nothing is compiled in without
+// SURFACE_INSTRUMENTATION.
+//
+// Names and categories must be string literals (they are stored as
+// pointers).
+
+namespace tracing
+{
+    extern std::atomic<bool> recording;
+
+    inline bool active()
+    {
+        return SURFACE_INSTRUMENTATION && recording.load(std::memory_order_relaxed);
+    }
+
+    // Clears earlier events and starts recording
+    void start();
+    void stop();
+
+    // Starts recording if the SURFACE_TRACE environment variable names a
+    // file, and writes that file at exit; returns whether it did
+    bool startFromEnvironment();
+
+    // Writes the recorded events; throws std::runtime_error on I/O errors.
+    // Events still being recorded by other threads may be left out.
+    void writeJson(const std::string &path);
+
+    // Track name for the calling thread (default "thread N")
+    void setThreadName(const std::string &name);
+
+    // Nanoseconds on the trace clock (steady_clock)
+    inline uint64_t now() { return instrumentation::clockNanoseconds(); }
+
+    // A complete event [begin, end) on the calling thread's track, with an
+    // optional integer argument shown as "value"
+    void complete(const char *category, const char *name, uint64_t begin, uint64_t end,
+                  int64_t value = 0, bool hasValue = false);
+
+    // Records the lifetime of the scope when tracing is active
+    class Scope
+    {
+    private:
+        const char *category;
+        const char *name;
+        uint64_t begin;
+        int64_t value;
+        bool hasValue;
+
+    public:
+        Scope(const char *category, const char *name)
+            : category(category), name(name), begin(active() ? now() : 0), value(0), hasValue(false) {}
+        Scope(const char *category, const char *name, int64_t value)
+            : category(category), name(name), begin(active() ? now() : 0), value(value), hasValue(true) {}
+        ~Scope()
+        {
+            if (begin != 0 && active())
+                complete(category, name, begin, now(), value, hasValue);
+        }
+
+        Scope(const Scope &) = delete;
+        Scope &operator=(const Scope &) = delete;
+    };
+}
+
+#if SURFACE_INSTRUMENTATION
+// SURFACE_TRACE_SCOPE("category", "name"[, value])
+#define SURFACE_TRACE_SCOPE(...) \
+    ::tracing::Scope SURFACE_INSTRUMENT_CONCAT(surfaceTrace, __LINE__)(__VA_ARGS__)
+#else
+#define SURFACE_TRACE_SCOPE(...) ((void)0)
+#endif
+
+#endif
@@ -0,0 +1,36 @@
+#ifndef TRUST_REGION_H
+#define TRUST_REGION_H
+
+#include "Optimizer.h"
+
+// Trust-region Newton method. Each iteration minimizes the quadratic model
+//     m(p) = f + g.p + 1/2 p^T H p   subject to |p| <= radius
+// with the surface's Hessian (Surface::hessian, analytic where the surface
+// provides it). The 2x2 subproblem is solved exactly in the eigenbasis of
+// H: the Newton step when H is positive definite and the step fits,
+// otherwise the boundary step -(H + mu I)^-1 g with mu >= max(0, -lambda_min),
+// i.e. a Levenberg-Marquardt shift. Indefinite and singular Hessians
+// therefore still give descent steps, where NewtonOptimizer stops.
+//
+// The radius grows after steps whose actual reduction matches the model and
+// shrinks after poor ones; steps that increase f are rejected.
+class TrustRegionNewton : public Optimizer
+{
+private:
+    double maxRadius;
+
+public:
+    // lr is the initial trust radius
+    TrustRegionNewton(const Surface *surf, double lr = 1.0, int maxIter = 1000,
+                      double tol = 1e-6, double maxRadius = 100.0);
+
+    OptimizationResult optimize(double startX, double startY) override;
+
+    // Minimizer (px, py) of g.p + 1/2 p^T H p over |p| <= radius; returns
+    // the model decrease -m(p) - f >= 0
+    static double solveSubproblem(double gx, double gy,
+                                  double fxx, double fxy, double fyy,
+                                  double radius, double &px, double &py);
+};
+
+#endif
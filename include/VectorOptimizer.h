@@ -0,0 +1,82 @@
+#ifndef VECTOR_OPTIMIZER_H
+#define VECTOR_OPTIMIZER_H
+
+#include "Objective.h"
+#include "LineSearch.h"
+#include <memory>
+#include <vector>
+
+struct VectorOptimizationResult
+{
+    std::vector<double> x; // Best point found
+    double value = 0;
+    int iterations = 0;
+    bool converged = false;
+    int functionEvaluations = 0; // Objective calls (each yields f)
+    int gradientEvaluations = 0; // Calls that also computed the gradient
+};
+
+// Optimizers over an N-dimensional Objective. The working vectors are
+// allocated once per minimize() call and reused by every iteration, so the
+// cost per step is the objective plus O(n) (O(n^2) for Nelder-Mead). A
+// Surface is an Objective of dimension 2, so these also run on surfaces.
+class VectorOptimizer
+{
+protected:
+    const Objective *objective;
+    double learningRate;
+    int maxIterations;
+    double tolerance;
+
+public:
+    VectorOptimizer(const Objective *objective, double lr, int maxIter, double tol)
+        : objective(objective), learningRate(lr), maxIterations(maxIter), tolerance(tol) {}
+    virtual ~VectorOptimizer() {}
+
+    // start must have objective->dimension() entries
+    virtual VectorOptimizationResult minimize(const std::vector<double> &start) = 0;
+};
+
+// Fixed-step gradient descent: x -= lr * grad, until |grad| < tol
+class VectorGradientDescent : public VectorOptimizer
+{
+public:
+    VectorGradientDescent(const Objective *objective, double lr = 0.01,
+                          int maxIter = 1000, double tol = 1e-6)
+        : VectorOptimizer(objective, lr, maxIter, tol) {}
+
+    VectorOptimizationResult minimize(const std::vector<double> &start) override;
+};
+
+// L-BFGS with a strong Wolfe line search (QuasiNewton); lr is the first trial step
+class VectorLBFGS : public VectorOptimizer
+{
+private:
+    int memory;
+    std::shared_ptr<const LineSearch> lineSearch;
+
+public:
+    VectorLBFGS(const Objective *objective, int memory = 8, double lr = 1.0,
+                int maxIter = 1000, double tol = 1e-6)
+        : VectorOptimizer(objective, lr, maxIter, tol), memory(memory) {}
+
+    void setLineSearch(std::shared_ptr<const LineSearch> search) { lineSearch = search; }
+
+    VectorOptimizationResult minimize(const std::vector<double> &start) override;
+};
+
+// Nelder-Mead on n + 1 vertices with the dimension-adaptive coefficients of
+// Gao and Han, which keep the simplex from collapsing in high dimensions.
+// lr is the initial edge length; stops when the simplex and its values are
+// both within tol of the best vertex.
+class VectorNelderMead : public VectorOptimizer
+{
+public:
+    VectorNelderMead(const Objective *objective, double lr = 1.0,
+                     int maxIter = 10000, double tol = 1e-6)
+        : VectorOptimizer(objective, lr, maxIter, tol) {}
+
+    VectorOptimizationResult minimize(const std::vector<double> &start) override;
+};
+
+#endif
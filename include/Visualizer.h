@@ -3,13 +3,24 @@
 
 #include "Surface.h"
 #include "Optimizer.h"
+#include "HeightField.h"
+#include "HeightPyramid.h"
+#include "MeshBuilder.h"
 #include <GL/glut.h>
+#include <functional>
+#include <string>
+#include <vector>
+
+struct BasinMap;
 
 class Visualizer
 {
 private:
     const Surface *surface;
     OptimizationResult *optResult;
+    const HeightField *heightField; // Pre-sampled mesh, e.g. from MeshCache
+    HeightPyramid pyramid;          // Per-tile LOD and picking over heightField
+    GridMeshF fieldMesh;            // Vertices and normals of heightField
 
     // View parameters
     float rotationX, rotationY;
@@ -19,11 +30,57 @@ private:
     double xMin, xMax, yMin, yMax;
     int resolution;
 
+    // Camera state of the last frame, used to unproject mouse clicks
+    GLdouble modelviewMatrix[16];
+    GLdouble projectionMatrix[16];
+    GLint viewport[4];
+
+    // Last picked surface point
+    bool hasPick;
+    Point3D pickPoint;
+
+    // Overlay line, e.g. progress of a running optimization
+    std::string statusText;
+    std::function<void()> cancelHandler;
+
+    // Optional colouring by basin of attraction or by iterations to converge
+    enum BasinColouring
+    {
+        PLAIN,
+        BASINS,
+        ITERATIONS
+    };
+    const BasinMap *basinMap;
+    BasinColouring basinColouring;
+    int basinMaxIterations;
+
+    // Display lists of the surface, compiled on first draw so that rotation
+    // and zoom only replay them. Cleared when the height field or the
+    // colouring changes; the surface, domain and resolution are fixed.
+    GLuint surfaceList;
+    std::vector<GLuint> tileLists; // Per LOD tile and level
+    bool meshListsValid;
+
 public:
     Visualizer(const Surface *surf, double xMin = -5, double xMax = 5,
                double yMin = -5, double yMax = 5, int res = 50);
 
     void setOptimizationResult(OptimizationResult *result);
+
+    // Draw from pre-sampled heights instead of evaluating the surface;
+    // the field's own bounds and resolution replace the constructor's
+    void setHeightField(const HeightField *field);
+
+    // Colour the surface by the minimum each point descends to; 'b' cycles
+    // through basins, an iteration-count heat map and the plain surface
+    void setBasinMap(const BasinMap *map);
+
+    // Text drawn in the lower-left corner; empty hides it
+    void setStatusText(const std::string &text);
+
+    // Called when 'c' is pressed, e.g. to cancel a running optimization
+    void setCancelHandler(std::function<void()> handler);
+
     void initialize(int argc, char **argv);
     void run();
 
@@ -31,12 +88,22 @@ public:
     static void displayCallback();
     static void reshapeCallback(int w, int h);
     static void keyboardCallback(unsigned char key, int x, int y);
+    static void mouseCallback(int button, int state, int x, int y);
 
 private:
     void display();
     void drawSurface();
+    void drawHeightField();
+    void drawTile(int i0, int j0, int i1, int j1, int stride, float skirtDepth, GLuint &list);
+    void releaseMeshLists();
+    void emitFieldVertex(int i, int j, float zOffset = 0.0f);
+    void drawPick();
+    void pick(int x, int y);
     void drawOptimizationPath();
     void drawAxes();
+    void drawStatus();
+    void applyBasinColour(double x, double y);
+    bool basinColour(double x, double y, float *rgb) const; // False, rgb unset, when plain
 
     static Visualizer *instance;
 };
@@ -4,32 +4,143 @@
 #include "Surface.h"
 #include "Optimizer.h"
 #include "Visualizer.h"
+#include "SampledSurface.h"
+#include "MultiStartOptimizer.h"
+#include "BatchGradientDescent.h"
+#include "QuasiNewton.h"
+#include "TrustRegion.h"
+#include "DerivativeFree.h"
+#include "PopulationOptimizer.h"
+#include "AsyncOptimizer.h"
+#include "BasinMap.h"
+#include "Instrumentation.h"
+#include "MeshBuilder.h"
+#include "TestFunctions.h"
+#include "Trace.h"
+#include "VectorOptimizer.h"
+#include <chrono>
+#include <cstdlib>
+#include <memory>
+#include <thread>
 
 void printOptimizationResult(const OptimizationResult &result)
 {
     std::cout << "\n===== Optimization Results =====" << std::endl;
     std::cout << "Converged: " << (result.converged ? "Yes" : "No") << std::endl;
     std::cout << "Iterations: " << result.iterations << std::endl;
+    std::cout << "Evaluations: " << result.functionEvaluations << " function, "
+              << result.gradientEvaluations << " gradient, "
+              << result.hessianEvaluations << " Hessian" << std::endl;
     std::cout << "Minimum point: ";
     result.minimumPoint.print();
     std::cout << "Minimum value: " << std::fixed << std::setprecision(6)
               << result.minimumValue << std::endl;
 
     std::cout << "\nOptimization path (showing every 10th step):" << std::endl;
-    int stepSize = std::max(1, (int)result.path.size() / 10);
-    for (size_t i = 0; i < result.path.size(); i += stepSize)
+    int stepSize = std::max(1, (int)result.pathSize() / 10);
+    for (size_t i = 0; i < result.pathSize(); i += stepSize)
     {
         std::cout << "Step " << std::setw(4) << i << ": ";
-        result.path[i].print();
+        result.pathPoint(i).print();
     }
 }
 
+void printMultiStartResult(const MultiStartResult &result)
+{
+    std::cout << "\n===== Multi-Start Results =====" << std::endl;
+    std::cout << "Runs: " << result.runs.size() << " (" << result.convergedRuns << " converged)" << std::endl;
+    std::cout << "Distinct minima: " << result.minima.size() << std::endl;
+    for (size_t i = 0; i < result.minima.size(); ++i)
+    {
+        const LocalMinimum &minimum = result.minima[i];
+        std::cout << std::setw(4) << i + 1 << ": value " << std::fixed << std::setprecision(6)
+                  << minimum.value << " hits " << std::setw(3) << minimum.hits << " at ";
+        minimum.point.print();
+    }
+    std::cout << "Iterations: " << result.totalIterations << std::endl;
+    std::cout << "Function evaluations: " << result.functionEvaluations << std::endl;
+    std::cout << "Gradient evaluations: " << result.gradientEvaluations << std::endl;
+    std::cout << "Wall time: " << std::setprecision(3) << result.wallSeconds * 1000.0
+              << " ms (" << result.runSeconds * 1000.0 << " ms summed over runs)" << std::endl;
+}
+
+// Optimize and visualize a memory-mapped grid file:
+// optimizer_demo <file.grid> [--obj mesh.obj] [--stl mesh.stl]
+int runSampledSurface(const std::string &path, int argc, char **argv)
+{
+    std::unique_ptr<SampledSurface> terrain;
+    try
+    {
+        terrain = std::make_unique<SampledSurface>(path);
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+
+    std::cout << "Sampled surface: " << path << std::endl;
+    std::cout << "Grid: " << terrain->getColumns() << " x " << terrain->getRows()
+              << " samples over [" << terrain->getXMin() << ", " << terrain->getXMax()
+              << "] x [" << terrain->getYMin() << ", " << terrain->getYMax() << "]" << std::endl;
+
+    // Start from the centre of the grid
+    double startX = 0.5 * (terrain->getXMin() + terrain->getXMax());
+    double startY = 0.5 * (terrain->getYMin() + terrain->getYMax());
+
+    std::cout << "\n--- Gradient Descent ---" << std::endl;
+    GradientDescent gd(terrain.get(), 0.01, 1000, 1e-6);
+    OptimizationResult result = gd.optimize(startX, startY);
+    printOptimizationResult(result);
+
+    // --obj FILE / --stl FILE export the grid as a triangle mesh
+    for (int k = 2; k + 1 < argc; ++k)
+    {
+        std::string flag = argv[k];
+        if (flag != "--obj" && flag != "--stl")
+            continue;
+        try
+        {
+            int resolution = static_cast<int>(terrain->getColumns()) - 1;
+            GridMeshF mesh = buildGridMesh(terrain->sampleHeightField(
+                terrain->getXMin(), terrain->getXMax(), terrain->getYMin(), terrain->getYMax(), resolution));
+            if (flag == "--obj")
+                writeObj(mesh, argv[k + 1]);
+            else
+                writeStl(mesh, argv[k + 1]);
+            std::cout << "Wrote " << mesh.triangleCount() << " triangles to " << argv[k + 1] << std::endl;
+        }
+        catch (const std::exception &e)
+        {
+            std::cerr << "Error: " << e.what() << std::endl;
+            return 1;
+        }
+    }
+
+    Visualizer viz(terrain.get(), terrain->getXMin(), terrain->getXMax(),
+                   terrain->getYMin(), terrain->getYMax(), 100);
+    viz.setOptimizationResult(&result);
+    viz.initialize(argc, argv);
+    viz.run();
+
+    return 0;
+}
+
 int main(int argc, char **argv)
 {
     std::cout << "=== 3D Surface Visualizer and Optimizer ===" << std::endl;
     std::cout << "=========================================\n"
               << std::endl;
 
+    // SURFACE_TRACE=trace.json records a trace of the whole run
+    if (tracing::startFromEnvironment())
+        std::cout << "Recording trace to " << std::getenv("SURFACE_TRACE") << std::endl;
+
+    if (argc > 1 && argv[1][0] != '-')
+    {
+        return runSampledSurface(argv[1], argc, argv);
+    }
+
     // Create Paraboloid surface: z = x^2 + y^2
     std::cout << "Testing Paraboloid Surface: z = x^2 + y^2" << std::endl;
     Paraboloid paraboloid;
@@ -49,6 +160,204 @@ int main(int argc, char **argv)
     OptimizationResult gdResult = gd.optimize(5.0, 5.0);
     printOptimizationResult(gdResult);
 
+    // Ill-conditioned valley: Rosenbrock's function from the classic start
+    std::cout << "\n--- Rosenbrock: fixed steps vs line searches ---" << std::endl;
+    CustomSurface rosenbrock([](double x, double y)
+                             { return (1 - x) * (1 - x) + 100 * (y - x * x) * (y - x * x); });
+    std::vector<std::pair<std::string, std::unique_ptr<Optimizer>>> contenders;
+    contenders.emplace_back("Gradient Descent", std::make_unique<GradientDescent>(&rosenbrock, 0.001, 100000, 1e-4));
+    contenders.emplace_back("GD + Armijo", std::make_unique<GradientDescent>(&rosenbrock, 1.0, 100000, 1e-4));
+    contenders.back().second->setLineSearch(LineSearch::create(LineSearchMethod::ARMIJO));
+    contenders.emplace_back("GD + More-Thuente", std::make_unique<GradientDescent>(&rosenbrock, 1.0, 100000, 1e-4));
+    contenders.back().second->setLineSearch(LineSearch::create(LineSearchMethod::MORE_THUENTE));
+    contenders.emplace_back("Newton", std::make_unique<NewtonOptimizer>(&rosenbrock, 1.0, 1000, 1e-4));
+    contenders.emplace_back("Newton + Wolfe", std::make_unique<NewtonOptimizer>(&rosenbrock, 1.0, 1000, 1e-4));
+    contenders.back().second->setLineSearch(LineSearch::create(LineSearchMethod::STRONG_WOLFE));
+    contenders.emplace_back("Trust region", std::make_unique<TrustRegionNewton>(&rosenbrock, 1.0, 1000, 1e-4));
+    contenders.emplace_back("L-BFGS", std::make_unique<LBFGSOptimizer>(&rosenbrock, 8, 1.0, 1000, 1e-4));
+    contenders.emplace_back("BFGS", std::make_unique<LBFGSOptimizer>(&rosenbrock, 0, 1.0, 1000, 1e-4));
+    for (auto &contender : contenders)
+    {
+        OptimizationResult r = contender.second->optimize(-1.2, 1.0);
+        std::cout << std::setw(18) << contender.first << ": " << (r.converged ? "converged" : "stopped")
+                  << " after " << std::setw(6) << r.iterations << " iterations, "
+                  << std::setw(6) << r.functionEvaluations << " f / "
+                  << std::setw(6) << r.gradientEvaluations << " grad, at ";
+        r.minimumPoint.print();
+    }
+
+    // Newton stops at the saddle's stationary point; the trust region
+    // follows the negative curvature away from it
+    std::cout << "\n--- Saddle from (1, 0): Newton vs trust region ---" << std::endl;
+    SaddleSurface saddle;
+    NewtonOptimizer saddleNewton(&saddle, 1.0, 20, 1e-6);
+    TrustRegionNewton saddleTrust(&saddle, 1.0, 20, 1e-6);
+    OptimizationResult newtonSaddle = saddleNewton.optimize(1.0, 0.0);
+    OptimizationResult trustSaddle = saddleTrust.optimize(1.0, 0.0);
+    std::cout << "Newton:       z = " << newtonSaddle.minimumValue << " after "
+              << newtonSaddle.iterations << " iterations" << std::endl;
+    std::cout << "Trust region: z = " << trustSaddle.minimumValue << " after "
+              << trustSaddle.iterations << " iterations (unbounded below)" << std::endl;
+
+    // A kinked surface: finite-difference gradients flip sign across the
+    // kinks, so only the derivative-free methods settle
+    std::cout << "\n--- Non-smooth |x - 1| + 2|y + 2|: evaluations per run ---" << std::endl;
+    CustomSurface kinked([](double x, double y)
+                         { return std::abs(x - 1) + 2 * std::abs(y + 2); });
+    std::vector<std::pair<std::string, std::unique_ptr<Optimizer>>> kinkedContenders;
+    kinkedContenders.emplace_back("Gradient Descent", std::make_unique<GradientDescent>(&kinked, 0.01, 5000, 1e-6));
+    kinkedContenders.emplace_back("Nelder-Mead", std::make_unique<NelderMead>(&kinked, 1.0, 5000, 1e-6));
+    kinkedContenders.emplace_back("Pattern Search", std::make_unique<PatternSearch>(&kinked, 1.0, 5000, 1e-6));
+    for (auto &contender : kinkedContenders)
+    {
+        OptimizationResult r = contender.second->optimize(-1.2, 1.0);
+        std::cout << std::setw(18) << contender.first << ": " << (r.converged ? "converged" : "stopped")
+                  << " after " << std::setw(6) << r.functionEvaluations << " f / "
+                  << std::setw(6) << r.gradientEvaluations << " grad, at ";
+        r.minimumPoint.print();
+    }
+
+    // Rastrigin: a 10 x 10 grid of local minima around the global one at 0
+    std::cout << "\n--- Rastrigin from (3, 3): population methods ---" << std::endl;
+    CustomSurface rastrigin([](double x, double y)
+                            { return 20 + x * x - 10 * std::cos(2 * 3.14159265358979323846 * x) +
+                                     y * y - 10 * std::cos(2 * 3.14159265358979323846 * y); });
+    std::vector<std::pair<std::string, std::unique_ptr<Optimizer>>> populations;
+    populations.emplace_back("Gradient Descent", std::make_unique<GradientDescent>(&rastrigin, 0.001, 5000, 1e-6));
+    populations.emplace_back("Particle Swarm", std::make_unique<ParticleSwarm>(&rastrigin, 5.0, 2000, 1e-6, 64));
+    populations.emplace_back("Diff. Evolution", std::make_unique<DifferentialEvolution>(&rastrigin, 5.0, 2000, 1e-6, 64));
+    populations.emplace_back("CMA-ES", std::make_unique<CMAES>(&rastrigin, 5.0, 2000, 1e-6, 64));
+    for (auto &contender : populations)
+    {
+        OptimizationResult r = contender.second->optimize(3.0, 3.0);
+        std::cout << std::setw(18) << contender.first << ": " << (r.converged ? "converged" : "stopped")
+                  << " after " << std::setw(6) << r.iterations << " iterations, "
+                  << std::setw(6) << r.functionEvaluations << " f, at ";
+        r.minimumPoint.print();
+    }
+
+    // Rosenbrock's chain in 10 and 100 dimensions, from (-1.2, 1, -1.2, 1, ...)
+    for (size_t n : {size_t(10), size_t(100)})
+    {
+        std::cout << "\n--- Extended Rosenbrock, " << n << " dimensions ---" << std::endl;
+        ExtendedRosenbrock chain(n);
+        std::vector<double> chainStart(n);
+        for (size_t i = 0; i < n; ++i)
+            chainStart[i] = i % 2 == 0 ? -1.2 : 1.0;
+        std::vector<std::pair<std::string, std::unique_ptr<VectorOptimizer>>> vectorContenders;
+        vectorContenders.emplace_back("Gradient Descent", std::make_unique<VectorGradientDescent>(&chain, 0.001, 100000, 1e-4));
+        vectorContenders.emplace_back("L-BFGS", std::make_unique<VectorLBFGS>(&chain, 8, 1.0, 10000, 1e-4));
+        vectorContenders.emplace_back("Nelder-Mead", std::make_unique<VectorNelderMead>(&chain, 1.0, 50000, 1e-8));
+        for (auto &contender : vectorContenders)
+        {
+            auto runStart = std::chrono::steady_clock::now();
+            VectorOptimizationResult r = contender.second->minimize(chainStart);
+            double ms = 1000.0 * std::chrono::duration<double>(std::chrono::steady_clock::now() - runStart).count();
+            std::cout << std::setw(18) << contender.first << ": " << (r.converged ? "converged" : "stopped")
+                      << " after " << std::setw(6) << r.iterations << " iterations, "
+                      << std::setw(7) << r.functionEvaluations << " f, f = " << std::scientific
+                      << std::setprecision(2) << r.value << std::fixed << " in " << ms << " ms"
+                      << std::setprecision(6) << std::endl;
+        }
+    }
+
+    // Background run with an evaluation budget; the iterates stream through
+    // the monitor while the optimizer works
+    std::cout << "\n--- Asynchronous Gradient Descent (Rastrigin, 500 evaluations) ---" << std::endl;
+    OptimizationBudget budget;
+    budget.evaluations = 500;
+    AsyncOptimization background(std::make_unique<GradientDescent>(&rastrigin, 0.0001, 100000, 1e-9),
+                                 3.0, 3.0, budget);
+    std::vector<Point3D> streamed;
+    while (!background.finished())
+    {
+        background.drainPath(streamed);
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    const OptimizationResult &backgroundResult = background.wait();
+    background.drainPath(streamed);
+    std::cout << "Stopped by evaluation budget: "
+              << (backgroundResult.stopReason == StopReason::EVALUATION_BUDGET ? "yes" : "no")
+              << ", " << backgroundResult.functionEvaluations + backgroundResult.gradientEvaluations
+              << " evaluations, " << streamed.size() << " iterates streamed" << std::endl;
+
+    // Multi-start search on Himmelblau's function, which has four minima
+    std::cout << "\n--- Multi-Start Gradient Descent (Himmelblau) ---" << std::endl;
+    CustomSurface himmelblau([](double x, double y)
+                             {
+        double a = x * x + y - 11;
+        double b = x + y * y - 7;
+        return a * a + b * b; });
+    MultiStartOptions multiOptions;
+    multiOptions.starts = 64;
+    multiOptions.mergeTolerance = 1e-2;
+    multiOptions.pathRecording = PathRecording::none(); // Only the minima are printed
+    MultiStartOptimizer multiStart(&himmelblau, MultiStartOptimizer::gradientDescent(0.01, 5000, 1e-6),
+                                   multiOptions);
+    printMultiStartResult(multiStart.optimize(-5, 5, -5, 5));
+
+    // Which of Himmelblau's minima gradient descent reaches from every vertex
+    std::cout << "\n--- Basins of Attraction (Himmelblau, 512 x 512) ---" << std::endl;
+    BasinMapOptions basinOptions;
+    basinOptions.resolution = 512;
+    basinOptions.mergeTolerance = 1e-2;
+    BasinMapper basinMapper(&himmelblau, MultiStartOptimizer::gradientDescent(0.01, 5000, 1e-6), basinOptions);
+    BasinMap basins = basinMapper.compute(-5, 5, -5, 5);
+    for (const LocalMinimum &minimum : basins.minima)
+    {
+        std::cout << "(" << minimum.point.getX() << ", " << minimum.point.getY() << "): "
+                  << minimum.hits << " cells" << std::endl;
+    }
+    std::cout << "Cells stopped early on a labelled cell: " << basins.absorbedCells << " of "
+              << basins.labels.size() << ", " << basins.iterationsRun << " iterations run in "
+              << basins.wallSeconds * 1000.0 << " ms" << std::endl;
+
+    // Lockstep descents over packs of start points versus one at a time
+    std::cout << "\n--- Batched Gradient Descent (Paraboloid) ---" << std::endl;
+    std::vector<Point3D> packStarts = MultiStartOptimizer::generateStarts(
+        StartPattern::SOBOL, 4096, 1, -10, 10, -10, 10);
+    BatchGradientDescent batchGd(&paraboloid, 0.01, 1000, 1e-6, 8);
+    batchGd.setPathRecording(PathRecording::none());
+    BatchOptimizationResult batchResult = batchGd.optimize(packStarts);
+
+    auto sequentialStart = std::chrono::steady_clock::now();
+    int mismatches = 0;
+    for (size_t k = 0; k < packStarts.size(); ++k)
+    {
+        OptimizationResult single = gd.optimize(packStarts[k].getX(), packStarts[k].getY());
+        const OptimizationResult &lane = batchResult.runs[k];
+        if (single.iterations != lane.iterations || single.minimumValue != lane.minimumValue ||
+            single.minimumPoint.getX() != lane.minimumPoint.getX() ||
+            single.minimumPoint.getY() != lane.minimumPoint.getY())
+            mismatches++;
+    }
+    double sequentialSeconds = std::chrono::duration<double>(
+                                   std::chrono::steady_clock::now() - sequentialStart)
+                                   .count();
+
+    std::cout << "Descents: " << packStarts.size() << " in packs of " << batchGd.getLanes()
+              << " (lane utilization " << std::setprecision(1)
+              << 100.0 * batchResult.laneUtilization(batchGd.getLanes()) << "%)" << std::endl;
+    std::cout << "Batched:    " << std::setprecision(0) << batchResult.descentsPerSecond()
+              << " descents/sec" << std::endl;
+    std::cout << "Sequential: " << packStarts.size() / sequentialSeconds
+              << " descents/sec (with paths)" << std::endl;
+    std::cout << "Lanes differing from GradientDescent: " << mismatches << std::endl;
+
+    // Per-iteration trace of one run, then the totals of everything above
+    std::cout << "\n--- Instrumentation ---" << std::endl;
+    GradientDescent traced(&paraboloid, 0.1, 1000, 1e-6);
+    traced.setTracing(true);
+    OptimizationResult tracedResult = traced.optimize(5.0, 5.0);
+    for (size_t i = 0; i < tracedResult.trace.size(); i += 20)
+    {
+        const IterationTrace &sample = tracedResult.trace[i];
+        std::cout << "iteration " << std::setw(3) << i << ": z = " << std::scientific << std::setprecision(3)
+                  << sample.z << ", " << sample.evaluations << " evaluations, " << std::fixed
+                  << std::setprecision(1) << sample.seconds * 1e6 << " us" << std::endl;
+    }
+    instrumentation::print(std::cout, instrumentation::snapshot());
+
     std::cout << "\n\n========================================" << std::endl;
     std::cout << "Opening 3D Visualization Window..." << std::endl;
     std::cout << "========================================" << std::endl;
@@ -1,10 +1,16 @@
 #include "GUIManager.h"
+#include "Trace.h"
+#include <cstdlib>
 #include <iostream>
 
 int main(int argc, char **argv)
 {
     std::cout << "=== 3D Surface Equation Visualizer ===" << std::endl;
     std::cout << "======================================" << std::endl;
+
+    // SURFACE_TRACE=trace.json records a trace until the program exits
+    if (tracing::startFromEnvironment())
+        std::cout << "Recording trace to " << std::getenv("SURFACE_TRACE") << std::endl;
     std::cout << "\nStarting GUI interface..." << std::endl;
     std::cout << "\nThis program allows you to:" << std::endl;
     std::cout << "  1. Enter any mathematical equation with variables x, y, z" << std::endl;
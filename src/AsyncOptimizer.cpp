@@ -0,0 +1,73 @@
+#include "AsyncOptimizer.h"
+
+// Optimization monitor
+OptimizationMonitor::OptimizationMonitor(const OptimizationBudget &budget, size_t queueCapacity)
+    : cancelled(false), budget(budget), startTime(std::chrono::steady_clock::now()),
+      points(queueCapacity), iterations(0), evaluations(0), droppedPoints(0) {}
+
+void OptimizationMonitor::start()
+{
+    startTime = std::chrono::steady_clock::now();
+    iterations.store(0, std::memory_order_relaxed);
+    evaluations.store(0, std::memory_order_relaxed);
+}
+
+double OptimizationMonitor::elapsedSeconds() const
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+}
+
+StopReason OptimizationMonitor::publish(double x, double y, double z, long long evaluationsSoFar)
+{
+    if (!points.push(Point3D(x, y, z)))
+        droppedPoints.fetch_add(1, std::memory_order_relaxed);
+    iterations.fetch_add(1, std::memory_order_relaxed);
+    evaluations.store(evaluationsSoFar, std::memory_order_relaxed);
+
+    if (isCancelled())
+        return StopReason::CANCELLED;
+    if (budget.evaluations > 0 && evaluationsSoFar >= budget.evaluations)
+        return StopReason::EVALUATION_BUDGET;
+    if (budget.seconds > 0 && elapsedSeconds() >= budget.seconds)
+        return StopReason::TIME_BUDGET;
+    return StopReason::NONE;
+}
+
+// Asynchronous optimization
+AsyncOptimization::AsyncOptimization(std::unique_ptr<Optimizer> optimizer, double startX, double startY,
+                                     const OptimizationBudget &budget, size_t queueCapacity)
+    : optimizer(std::move(optimizer)), monitor(budget, queueCapacity), done(false)
+{
+    this->optimizer->setMonitor(&monitor);
+    monitor.start();
+    worker = std::thread([this, startX, startY]()
+                         {
+        result = this->optimizer->optimize(startX, startY);
+        done.store(true, std::memory_order_release); });
+}
+
+AsyncOptimization::~AsyncOptimization()
+{
+    monitor.cancel();
+    if (worker.joinable())
+        worker.join();
+}
+
+size_t AsyncOptimization::drainPath(std::vector<Point3D> &path)
+{
+    size_t count = 0;
+    Point3D point;
+    while (monitor.popPoint(point))
+    {
+        path.push_back(point);
+        count++;
+    }
+    return count;
+}
+
+const OptimizationResult &AsyncOptimization::wait()
+{
+    if (worker.joinable())
+        worker.join();
+    return result;
+}
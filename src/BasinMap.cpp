@@ -0,0 +1,243 @@
+#include "BasinMap.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <numeric>
+#include <stdexcept>
+
+namespace
+{
+    // Spacing of the coarsest pass: the largest power of two that still
+    // leaves about eight cells per side
+    int topStride(int resolution)
+    {
+        int stride = 1;
+        while ((resolution - 1) / (stride * 2) >= 8)
+            stride *= 2;
+        return stride;
+    }
+
+    // Pass of vertex (i, j): the largest power of two dividing both
+    // indices, capped at the coarsest spacing
+    int strideOf(int i, int j, int top)
+    {
+        int bits = i | j;
+        if (bits == 0)
+            return top;
+        return std::min(bits & -bits, top);
+    }
+
+    // Stops a trajectory once it enters the cell of a vertex that an
+    // earlier pass has labelled with a minimum
+    class CellObserver : public IterationObserver
+    {
+    private:
+        const BasinMap &map;
+        int top;
+        int passStride;
+        size_t startCell;
+
+    public:
+        int absorbedBy = -1;
+
+        CellObserver(const BasinMap &map, int top, int passStride, size_t startCell)
+            : map(map), top(top), passStride(passStride), startCell(startCell) {}
+
+        StopReason publish(double x, double y, double, long long) override
+        {
+            int i, j;
+            if (!map.cellAt(x, y, i, j))
+                return StopReason::NONE;
+
+            size_t cell = static_cast<size_t>(j) * map.resolution + i;
+            if (cell == startCell || strideOf(i, j, top) <= passStride)
+                return StopReason::NONE;
+            if (map.labels[cell] == BasinMap::NO_MINIMUM)
+                return StopReason::NONE;
+
+            absorbedBy = static_cast<int>(cell);
+            return StopReason::ABSORBED;
+        }
+    };
+
+    // Outcome of one vertex within a pass
+    struct CellRun
+    {
+        Point3D end;
+        double value = 0;
+        int iterations = 0;
+        bool converged = false;
+        int absorbedBy = -1;
+    };
+}
+
+bool BasinMap::cellAt(double x, double y, int &i, int &j) const
+{
+    if (resolution < 2)
+        return false;
+
+    // Also rejects NaN
+    double u = (x - xMin) / (xMax - xMin) * (resolution - 1);
+    double v = (y - yMin) / (yMax - yMin) * (resolution - 1);
+    if (!(u > -0.5 && u < resolution - 0.5 && v > -0.5 && v < resolution - 0.5))
+        return false;
+
+    i = static_cast<int>(std::lround(u));
+    j = static_cast<int>(std::lround(v));
+    return true;
+}
+
+int BasinMap::labelAt(double x, double y) const
+{
+    int i, j;
+    return cellAt(x, y, i, j) ? label(i, j) : NO_MINIMUM;
+}
+
+int BasinMap::iterationsAt(double x, double y) const
+{
+    int i, j;
+    return cellAt(x, y, i, j) ? iterations[static_cast<size_t>(j) * resolution + i] : 0;
+}
+
+BasinMapper::BasinMapper(const Surface *surf, MultiStartOptimizer::OptimizerFactory factory,
+                         const BasinMapOptions &options)
+    : surface(surf), factory(factory), options(options)
+{
+    if (!this->factory)
+        this->factory = MultiStartOptimizer::gradientDescent();
+    if (options.resolution < 2)
+        throw std::runtime_error("Basin map needs at least 2 vertices per side");
+}
+
+BasinMap BasinMapper::compute(double xMin, double xMax, double yMin, double yMax) const
+{
+    auto wallStart = std::chrono::steady_clock::now();
+
+    const int n = options.resolution;
+    BasinMap map;
+    map.resolution = n;
+    map.xMin = xMin;
+    map.xMax = xMax;
+    map.yMin = yMin;
+    map.yMax = yMax;
+    map.labels.assign(static_cast<size_t>(n) * n, BasinMap::NO_MINIMUM);
+    map.iterations.assign(map.labels.size(), 0);
+
+    const int top = topStride(n);
+    const double tol2 = options.mergeTolerance * options.mergeTolerance;
+    ThreadPool &pool = options.pool ? *options.pool : ThreadPool::shared();
+
+    std::vector<size_t> cells;
+    std::vector<CellRun> runs;
+    for (int stride = top; stride >= 1; stride /= 2)
+    {
+        cells.clear();
+        for (int j = 0; j < n; j += stride)
+            for (int i = 0; i < n; i += stride)
+                if (strideOf(i, j, top) == stride)
+                    cells.push_back(static_cast<size_t>(j) * n + i);
+        runs.assign(cells.size(), CellRun());
+
+        // Labels only change between passes, so every run sees the same map
+        pool.parallelFor(0, cells.size(), 16, [&](size_t begin, size_t end)
+                         {
+            std::unique_ptr<Optimizer> optimizer = factory(surface);
+            optimizer->setPathRecording(PathRecording::none());
+
+            for (size_t k = begin; k < end; ++k)
+            {
+                size_t cell = cells[k];
+                int i = static_cast<int>(cell % n), j = static_cast<int>(cell / n);
+
+                CellObserver observer(map, top, stride, cell);
+                optimizer->setMonitor(options.earlyTermination ? &observer : nullptr);
+                OptimizationResult result = optimizer->optimize(map.xAt(i), map.yAt(j));
+
+                CellRun &run = runs[k];
+                run.end = result.minimumPoint;
+                run.value = result.minimumValue;
+                run.iterations = result.iterations;
+                run.converged = result.converged && std::isfinite(result.minimumValue);
+                run.absorbedBy = result.stopReason == StopReason::ABSORBED ? observer.absorbedBy : -1;
+            } });
+
+        // Label in cell order so the outcome is deterministic
+        for (size_t k = 0; k < cells.size(); ++k)
+        {
+            size_t cell = cells[k];
+            const CellRun &run = runs[k];
+            map.iterationsRun += run.iterations;
+
+            if (run.absorbedBy >= 0)
+            {
+                map.labels[cell] = map.labels[run.absorbedBy];
+                map.iterations[cell] = run.iterations + map.iterations[run.absorbedBy];
+                map.minima[map.labels[cell]].hits++;
+                map.absorbedCells++;
+                continue;
+            }
+
+            map.iterations[cell] = run.iterations;
+            if (!run.converged)
+                continue;
+
+            int match = BasinMap::NO_MINIMUM;
+            for (size_t m = 0; m < map.minima.size(); ++m)
+            {
+                double dx = map.minima[m].point.getX() - run.end.getX();
+                double dy = map.minima[m].point.getY() - run.end.getY();
+                if (dx * dx + dy * dy <= tol2)
+                {
+                    match = static_cast<int>(m);
+                    break;
+                }
+            }
+
+            if (match == BasinMap::NO_MINIMUM)
+            {
+                LocalMinimum minimum;
+                minimum.point = run.end;
+                minimum.value = run.value;
+                minimum.hits = 1;
+                minimum.bestRun = static_cast<int>(cell);
+                map.minima.push_back(minimum);
+                match = static_cast<int>(map.minima.size()) - 1;
+            }
+            else
+            {
+                LocalMinimum &minimum = map.minima[match];
+                minimum.hits++;
+                if (run.value < minimum.value)
+                {
+                    minimum.point = run.end;
+                    minimum.value = run.value;
+                    minimum.bestRun = static_cast<int>(cell);
+                }
+            }
+            map.labels[cell] = match;
+        }
+    }
+
+    // Rank the minima by value and renumber the labels to match
+    std::vector<int> order(map.minima.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&](int a, int b)
+                     { return map.minima[a].value < map.minima[b].value; });
+
+    std::vector<int> rank(order.size());
+    std::vector<LocalMinimum> ranked;
+    ranked.reserve(order.size());
+    for (size_t r = 0; r < order.size(); ++r)
+    {
+        rank[order[r]] = static_cast<int>(r);
+        ranked.push_back(map.minima[order[r]]);
+    }
+    map.minima.swap(ranked);
+    for (int &label : map.labels)
+        if (label != BasinMap::NO_MINIMUM)
+            label = rank[label];
+
+    map.wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart).count();
+    return map;
+}
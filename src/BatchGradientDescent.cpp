@@ -0,0 +1,147 @@
+#include "BatchGradientDescent.h"
+#include "Instrumentation.h"
+#include <chrono>
+#include <cmath>
+#include <memory>
+#include <stdexcept>
+
+BatchGradientDescent::BatchGradientDescent(const Surface *surf, double lr,
+                                           int maxIter, double tol, int lanes)
+    : surface(surf), learningRate(lr), maxIterations(maxIter), tolerance(tol),
+      lanes(lanes)
+{
+    if (lanes < 1 || lanes > MAX_LANES)
+        throw std::runtime_error("Batch gradient descent supports 1 to 16 lanes");
+}
+
+BatchOptimizationResult BatchGradientDescent::optimize(const std::vector<Point3D> &starts) const
+{
+    SURFACE_TIME_SCOPE(OPTIMIZE);
+    auto startTime = std::chrono::steady_clock::now();
+
+    BatchOptimizationResult batch;
+    batch.runs.resize(starts.size());
+    batch.packedSteps = 0;
+    batch.laneSteps = 0;
+
+    // Lane state in structure-of-arrays form; lanes [0, live) are running
+    alignas(64) double x[MAX_LANES], y[MAX_LANES], z[MAX_LANES];
+    alignas(64) double gx[MAX_LANES], gy[MAX_LANES];
+    int iteration[MAX_LANES];
+    size_t run[MAX_LANES];
+    int live = 0;
+    size_t nextStart = 0;
+
+    // Path recorders of the runs currently in a lane
+    const bool recordPaths = pathRecording.mode != PathRecording::NONE;
+    std::vector<std::unique_ptr<PathRecorder>> recorders(recordPaths ? starts.size() : 0);
+
+    // Retire lane k and move the last live lane into its slot
+    auto retire = [&](int k)
+    {
+        --live;
+        x[k] = x[live];
+        y[k] = y[live];
+        z[k] = z[live];
+        gx[k] = gx[live];
+        gy[k] = gy[live];
+        iteration[k] = iteration[live];
+        run[k] = run[live];
+    };
+
+    auto finish = [&](int k, double value, bool converged, int iterations)
+    {
+        OptimizationResult &result = batch.runs[run[k]];
+        result.converged = converged;
+        result.iterations = iterations;
+        result.minimumPoint = Point3D(x[k], y[k], value);
+        result.minimumValue = value;
+        result.functionEvaluations = iteration[k] + 1;
+        result.gradientEvaluations = converged ? iteration[k] + 1 : iteration[k];
+
+        if (recordPaths)
+        {
+            recorders[run[k]]->finish();
+            recorders[run[k]].reset();
+        }
+    };
+
+    for (;;)
+    {
+        // Refill empty lanes with the next start points
+        while (live < lanes && nextStart < starts.size())
+        {
+            x[live] = starts[nextStart].getX();
+            y[live] = starts[nextStart].getY();
+            iteration[live] = 0;
+            run[live] = nextStart;
+            batch.runs[nextStart].converged = false;
+            batch.runs[nextStart].iterations = 0;
+            if (recordPaths)
+                recorders[nextStart] = std::make_unique<PathRecorder>(
+                    pathRecording, batch.runs[nextStart].path, batch.runs[nextStart].compactPath, maxIterations);
+            ++nextStart;
+            ++live;
+        }
+        if (live == 0)
+            break;
+
+        surface->evaluateBatch(x, y, z, live);
+        batch.packedSteps++;
+
+        // Lanes out of iterations end here; z is their final value
+        for (int k = live - 1; k >= 0; --k)
+        {
+            if (iteration[k] >= maxIterations)
+            {
+                finish(k, z[k], false, maxIterations);
+                retire(k);
+            }
+        }
+        if (live == 0)
+            continue;
+
+        if (recordPaths)
+        {
+            for (int k = 0; k < live; ++k)
+                recorders[run[k]]->record(x[k], y[k], z[k]);
+        }
+
+        surface->gradientBatch(x, y, gx, gy, live);
+        batch.laneSteps += live;
+
+        // Converged lanes stop at the current point
+        for (int k = live - 1; k >= 0; --k)
+        {
+            double gradMag = std::sqrt(gx[k] * gx[k] + gy[k] * gy[k]);
+            if (gradMag < tolerance)
+            {
+                finish(k, z[k], true, iteration[k]);
+                retire(k);
+            }
+        }
+
+        // Step all remaining lanes
+        for (int k = 0; k < live; ++k)
+        {
+            x[k] = x[k] - learningRate * gx[k];
+            y[k] = y[k] - learningRate * gy[k];
+            iteration[k]++;
+        }
+    }
+
+    batch.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+
+#if SURFACE_INSTRUMENTATION
+    uint64_t evaluations = 0, gradients = 0;
+    for (const OptimizationResult &result : batch.runs)
+    {
+        evaluations += result.functionEvaluations;
+        gradients += result.gradientEvaluations;
+    }
+    SURFACE_COUNT(EVALUATIONS, evaluations);
+    SURFACE_COUNT(GRADIENTS, gradients);
+    SURFACE_COUNT(OPTIMIZER_RUNS, batch.runs.size());
+#endif
+    return batch;
+}
@@ -0,0 +1,177 @@
+#include "DerivativeFree.h"
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+    struct Vertex
+    {
+        double x, y, z;
+    };
+
+    bool lower(const Vertex &a, const Vertex &b) { return a.z < b.z; }
+}
+
+// Nelder-Mead Implementation
+NelderMead::NelderMead(const Surface *surf, double lr, int maxIter, double tol)
+    : Optimizer(surf, lr, maxIter, tol) {}
+
+OptimizationResult NelderMead::optimize(double startX, double startY)
+{
+    OptimizationResult result;
+    result.converged = false;
+    result.iterations = 0;
+    resetCounters();
+
+    PathRecorder recorder(pathRecording, result.path, result.compactPath, maxIterations);
+
+    // Standard coefficients: reflection, expansion, contraction, shrink
+    const double alpha = 1.0, gamma = 2.0, rho = 0.5, sigma = 0.5;
+
+    auto vertexAt = [this](double x, double y)
+    { return Vertex{x, y, evaluateSurface(x, y)}; };
+
+    Vertex simplex[3] = {vertexAt(startX, startY),
+                         vertexAt(startX + learningRate, startY),
+                         vertexAt(startX, startY + learningRate)};
+
+    for (int iter = 0; iter < maxIterations; ++iter)
+    {
+        std::sort(simplex, simplex + 3, lower);
+        const Vertex &best = simplex[0];
+        recorder.record(best.x, best.y, best.z);
+        if (!keepGoing(best.x, best.y, best.z))
+            break;
+
+        // Diverged (unbounded below or overflow); the sizes are meaningless
+        if (!std::isfinite(best.z))
+            break;
+
+        // Converged once the simplex is small in both x and f
+        double size = 0, spread = 0;
+        for (int k = 1; k < 3; ++k)
+        {
+            size = std::max(size, std::max(std::abs(simplex[k].x - best.x), std::abs(simplex[k].y - best.y)));
+            spread = std::max(spread, std::abs(simplex[k].z - best.z));
+        }
+        if (size < tolerance && spread < tolerance)
+        {
+            result.converged = true;
+            result.iterations = iter;
+            break;
+        }
+
+        // Centroid of the two best vertices
+        double cx = 0.5 * (simplex[0].x + simplex[1].x);
+        double cy = 0.5 * (simplex[0].y + simplex[1].y);
+        Vertex &worst = simplex[2];
+
+        Vertex reflected = vertexAt(cx + alpha * (cx - worst.x), cy + alpha * (cy - worst.y));
+        if (reflected.z < simplex[0].z)
+        {
+            Vertex expanded = vertexAt(cx + gamma * (reflected.x - cx), cy + gamma * (reflected.y - cy));
+            worst = expanded.z < reflected.z ? expanded : reflected;
+        }
+        else if (reflected.z < simplex[1].z)
+        {
+            worst = reflected;
+        }
+        else
+        {
+            // Contract toward the better of the reflected and worst points
+            bool outside = reflected.z < worst.z;
+            const Vertex &anchor = outside ? reflected : worst;
+            Vertex contracted = vertexAt(cx + rho * (anchor.x - cx), cy + rho * (anchor.y - cy));
+            if (contracted.z < anchor.z)
+            {
+                worst = contracted;
+            }
+            else
+            {
+                for (int k = 1; k < 3; ++k)
+                    simplex[k] = vertexAt(simplex[0].x + sigma * (simplex[k].x - simplex[0].x),
+                                          simplex[0].y + sigma * (simplex[k].y - simplex[0].y));
+            }
+        }
+
+        result.iterations = iter + 1;
+    }
+
+    if (result.iterations == maxIterations)
+    {
+        std::sort(simplex, simplex + 3, lower);
+        recorder.record(simplex[0].x, simplex[0].y, simplex[0].z);
+    }
+
+    recorder.finish();
+    result.minimumValue = simplex[0].z;
+    result.minimumPoint = Point3D(simplex[0].x, simplex[0].y, simplex[0].z);
+    recordCounters(result);
+
+    return result;
+}
+
+// Pattern Search Implementation
+PatternSearch::PatternSearch(const Surface *surf, double lr, int maxIter, double tol)
+    : Optimizer(surf, lr, maxIter, tol) {}
+
+OptimizationResult PatternSearch::optimize(double startX, double startY)
+{
+    OptimizationResult result;
+    result.converged = false;
+    result.iterations = 0;
+    resetCounters();
+
+    PathRecorder recorder(pathRecording, result.path, result.compactPath, maxIterations);
+
+    static const double directions[4][2] = {{1, 0}, {0, 1}, {-1, 0}, {0, -1}};
+
+    double x = startX, y = startY;
+    double z = evaluateSurface(x, y);
+    double step = learningRate;
+    int first = 0; // Poll the last successful direction first
+
+    for (int iter = 0; iter < maxIterations; ++iter)
+    {
+        recorder.record(x, y, z);
+        if (!keepGoing(x, y, z))
+            break;
+
+        if (step < tolerance)
+        {
+            result.converged = true;
+            result.iterations = iter;
+            break;
+        }
+
+        bool improved = false;
+        for (int k = 0; k < 4; ++k)
+        {
+            int d = (first + k) % 4;
+            double xTrial = x + step * directions[d][0];
+            double yTrial = y + step * directions[d][1];
+            double zTrial = evaluateSurface(xTrial, yTrial);
+            if (zTrial < z)
+            {
+                x = xTrial;
+                y = yTrial;
+                z = zTrial;
+                first = d;
+                improved = true;
+                break;
+            }
+        }
+
+        if (!improved)
+            step *= 0.5;
+
+        result.iterations = iter + 1;
+    }
+
+    recorder.finish();
+    result.minimumValue = z;
+    result.minimumPoint = Point3D(x, y, z);
+    recordCounters(result);
+
+    return result;
+}
@@ -0,0 +1,333 @@
+#include "HeightPyramid.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+HeightPyramid::HeightPyramid() {}
+
+HeightPyramid::HeightPyramid(const HeightField &field, ThreadPool *pool)
+    : field(field)
+{
+    if (field.empty())
+        return;
+
+    ThreadPool &workers = pool ? *pool : ThreadPool::shared();
+
+    buildBaseLevel(workers);
+    while (levels.back().columns > 1 || levels.back().rows > 1)
+        buildLevel(static_cast<int>(levels.size()), workers);
+}
+
+// Rows per parallel chunk so each chunk touches a few thousand cells
+static size_t rowGrain(int columns)
+{
+    return std::max<size_t>(1, 4096 / std::max(1, columns));
+}
+
+void HeightPyramid::buildBaseLevel(ThreadPool &pool)
+{
+    Level base;
+    base.columns = field.getColumns() - 1;
+    base.rows = field.getRows() - 1;
+    size_t cells = static_cast<size_t>(base.columns) * base.rows;
+    base.minHeights.resize(cells);
+    base.maxHeights.resize(cells);
+    base.meanHeights.resize(cells);
+
+    pool.parallelFor(0, base.rows, rowGrain(base.columns), [&](size_t rowBegin, size_t rowEnd)
+                     {
+        for (int j = static_cast<int>(rowBegin); j < static_cast<int>(rowEnd); ++j)
+        {
+            for (int i = 0; i < base.columns; ++i)
+            {
+                float h00 = field.height(i, j), h10 = field.height(i + 1, j);
+                float h01 = field.height(i, j + 1), h11 = field.height(i + 1, j + 1);
+                size_t index = base.index(i, j);
+                base.minHeights[index] = std::min(std::min(h00, h10), std::min(h01, h11));
+                base.maxHeights[index] = std::max(std::max(h00, h10), std::max(h01, h11));
+                base.meanHeights[index] = 0.25f * (h00 + h10 + h01 + h11);
+            }
+        } });
+
+    levels.push_back(std::move(base));
+}
+
+void HeightPyramid::buildLevel(int levelIndex, ThreadPool &pool)
+{
+    const Level &below = levels[levelIndex - 1];
+
+    Level level;
+    level.columns = (below.columns + 1) / 2;
+    level.rows = (below.rows + 1) / 2;
+    size_t cells = static_cast<size_t>(level.columns) * level.rows;
+    level.minHeights.resize(cells);
+    level.maxHeights.resize(cells);
+    level.meanHeights.resize(cells);
+
+    pool.parallelFor(0, level.rows, rowGrain(level.columns), [&](size_t rowBegin, size_t rowEnd)
+                     {
+        for (int j = static_cast<int>(rowBegin); j < static_cast<int>(rowEnd); ++j)
+        {
+            for (int i = 0; i < level.columns; ++i)
+            {
+                float low = std::numeric_limits<float>::max();
+                float high = std::numeric_limits<float>::lowest();
+                float sum = 0.0f;
+                int children = 0;
+
+                // Edge cells may have fewer than four children
+                for (int cj = 2 * j; cj < std::min(2 * j + 2, below.rows); ++cj)
+                {
+                    for (int ci = 2 * i; ci < std::min(2 * i + 2, below.columns); ++ci)
+                    {
+                        low = std::min(low, below.minAt(ci, cj));
+                        high = std::max(high, below.maxAt(ci, cj));
+                        sum += below.meanAt(ci, cj);
+                        ++children;
+                    }
+                }
+
+                size_t index = level.index(i, j);
+                level.minHeights[index] = low;
+                level.maxHeights[index] = high;
+                level.meanHeights[index] = sum / children;
+            }
+        } });
+
+    levels.push_back(std::move(level));
+}
+
+float HeightPyramid::maxError(int levelIndex, int i0, int j0, int i1, int j1) const
+{
+    if (levelIndex <= 0 || levels.empty())
+        return 0.0f;
+
+    const Level &level = levels[std::min(levelIndex, levelCount() - 1)];
+    int shift = std::min(levelIndex, levelCount() - 1);
+
+    float error = 0.0f;
+    for (int j = j0 >> shift; j <= (j1 - 1) >> shift && j < level.rows; ++j)
+    {
+        for (int i = i0 >> shift; i <= (i1 - 1) >> shift && i < level.columns; ++i)
+        {
+            error = std::max(error, level.maxAt(i, j) - level.minAt(i, j));
+        }
+    }
+    return error;
+}
+
+void HeightPyramid::rangeQueryCell(int levelIndex, int i, int j, int i0, int j0, int i1, int j1,
+                                   float &low, float &high) const
+{
+    const Level &level = levels[levelIndex];
+
+    // Base cells covered by this cell
+    int ci0 = i << levelIndex, cj0 = j << levelIndex;
+    int ci1 = std::min((i + 1) << levelIndex, levels[0].columns);
+    int cj1 = std::min((j + 1) << levelIndex, levels[0].rows);
+
+    if (ci1 <= i0 || ci0 >= i1 || cj1 <= j0 || cj0 >= j1)
+        return;
+
+    bool contained = ci0 >= i0 && ci1 <= i1 && cj0 >= j0 && cj1 <= j1;
+    if (contained || levelIndex == 0)
+    {
+        low = std::min(low, level.minAt(i, j));
+        high = std::max(high, level.maxAt(i, j));
+        return;
+    }
+
+    const Level &below = levels[levelIndex - 1];
+    for (int cj = 2 * j; cj < std::min(2 * j + 2, below.rows); ++cj)
+        for (int ci = 2 * i; ci < std::min(2 * i + 2, below.columns); ++ci)
+            rangeQueryCell(levelIndex - 1, ci, cj, i0, j0, i1, j1, low, high);
+}
+
+bool HeightPyramid::rangeQuery(double xMin, double xMax, double yMin, double yMax,
+                               float &low, float &high) const
+{
+    if (levels.empty() || xMax < field.getXMin() || xMin > field.getXMax() ||
+        yMax < field.getYMin() || yMin > field.getYMax())
+        return false;
+
+    // Base cells touching the rectangle, clamped to the grid
+    const Level &base = levels[0];
+    auto cellIndex = [](double coordinate, double origin, double step, int cells)
+    {
+        int index = static_cast<int>(std::floor((coordinate - origin) / step));
+        return std::min(std::max(index, 0), cells - 1);
+    };
+    int i0 = cellIndex(xMin, field.getXMin(), field.xStep(), base.columns);
+    int i1 = cellIndex(xMax, field.getXMin(), field.xStep(), base.columns) + 1;
+    int j0 = cellIndex(yMin, field.getYMin(), field.yStep(), base.rows);
+    int j1 = cellIndex(yMax, field.getYMin(), field.yStep(), base.rows) + 1;
+
+    low = std::numeric_limits<float>::max();
+    high = std::numeric_limits<float>::lowest();
+    rangeQueryCell(levelCount() - 1, 0, 0, i0, j0, i1, j1, low, high);
+    return true;
+}
+
+// Ray parameter where the ray enters an axis-aligned box, if it hits it at t >= 0
+static bool rayBoxEntry(const double origin[3], const double invDirection[3],
+                        const double boxMin[3], const double boxMax[3], double &tEnter)
+{
+    double tNear = 0.0;
+    double tFar = std::numeric_limits<double>::infinity();
+
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        double t1 = (boxMin[axis] - origin[axis]) * invDirection[axis];
+        double t2 = (boxMax[axis] - origin[axis]) * invDirection[axis];
+        if (t1 > t2)
+            std::swap(t1, t2);
+        // NaN from 0 * inf (ray parallel to a face plane) leaves the bounds unchanged
+        if (t1 > tNear)
+            tNear = t1;
+        if (t2 < tFar)
+            tFar = t2;
+        if (tNear > tFar)
+            return false;
+    }
+
+    tEnter = tNear;
+    return true;
+}
+
+// Moller-Trumbore ray/triangle test
+static bool rayTriangle(const double origin[3], const double direction[3],
+                        const double a[3], const double b[3], const double c[3], double &t)
+{
+    double e1[3] = {b[0] - a[0], b[1] - a[1], b[2] - a[2]};
+    double e2[3] = {c[0] - a[0], c[1] - a[1], c[2] - a[2]};
+    double p[3] = {direction[1] * e2[2] - direction[2] * e2[1],
+                   direction[2] * e2[0] - direction[0] * e2[2],
+                   direction[0] * e2[1] - direction[1] * e2[0]};
+    double det = e1[0] * p[0] + e1[1] * p[1] + e1[2] * p[2];
+    if (std::abs(det) < 1e-14)
+        return false;
+
+    double invDet = 1.0 / det;
+    double s[3] = {origin[0] - a[0], origin[1] - a[1], origin[2] - a[2]};
+    double u = (s[0] * p[0] + s[1] * p[1] + s[2] * p[2]) * invDet;
+    if (u < 0.0 || u > 1.0)
+        return false;
+
+    double q[3] = {s[1] * e1[2] - s[2] * e1[1],
+                   s[2] * e1[0] - s[0] * e1[2],
+                   s[0] * e1[1] - s[1] * e1[0]};
+    double v = (direction[0] * q[0] + direction[1] * q[1] + direction[2] * q[2]) * invDet;
+    if (v < 0.0 || u + v > 1.0)
+        return false;
+
+    t = (e2[0] * q[0] + e2[1] * q[1] + e2[2] * q[2]) * invDet;
+    return t >= 0.0;
+}
+
+bool HeightPyramid::intersectCell(int levelIndex, int i, int j, const Point3D &originPoint,
+                                  const Point3D &directionPoint, double &tBest) const
+{
+    double origin[3] = {originPoint.getX(), originPoint.getY(), originPoint.getZ()};
+    double direction[3] = {directionPoint.getX(), directionPoint.getY(), directionPoint.getZ()};
+
+    if (levelIndex == 0)
+    {
+        // Same triangulation as the rendered strips
+        double x0 = field.xAt(i), x1 = field.xAt(i + 1);
+        double y0 = field.yAt(j), y1 = field.yAt(j + 1);
+        double v00[3] = {x0, y0, field.height(i, j)};
+        double v10[3] = {x1, y0, field.height(i + 1, j)};
+        double v01[3] = {x0, y1, field.height(i, j + 1)};
+        double v11[3] = {x1, y1, field.height(i + 1, j + 1)};
+
+        bool hit = false;
+        double t;
+        if (rayTriangle(origin, direction, v00, v10, v01, t) && t < tBest)
+        {
+            tBest = t;
+            hit = true;
+        }
+        if (rayTriangle(origin, direction, v10, v01, v11, t) && t < tBest)
+        {
+            tBest = t;
+            hit = true;
+        }
+        return hit;
+    }
+
+    double invDirection[3] = {1.0 / direction[0], 1.0 / direction[1], 1.0 / direction[2]};
+    const Level &below = levels[levelIndex - 1];
+    int childLevel = levelIndex - 1;
+
+    // Visit overlapping children front to back so the first hit prunes the rest
+    struct Child
+    {
+        int i, j;
+        double tEnter;
+    };
+    Child children[4];
+    int childCount = 0;
+
+    for (int cj = 2 * j; cj < std::min(2 * j + 2, below.rows); ++cj)
+    {
+        for (int ci = 2 * i; ci < std::min(2 * i + 2, below.columns); ++ci)
+        {
+            int bi0 = ci << childLevel, bj0 = cj << childLevel;
+            int bi1 = std::min((ci + 1) << childLevel, levels[0].columns);
+            int bj1 = std::min((cj + 1) << childLevel, levels[0].rows);
+            double boxMin[3] = {field.xAt(bi0), field.yAt(bj0), below.minAt(ci, cj)};
+            double boxMax[3] = {field.xAt(bi1), field.yAt(bj1), below.maxAt(ci, cj)};
+
+            double tEnter;
+            if (!rayBoxEntry(origin, invDirection, boxMin, boxMax, tEnter) || tEnter > tBest)
+                continue;
+
+            // Insertion sort by entry distance
+            int slot = childCount++;
+            while (slot > 0 && children[slot - 1].tEnter > tEnter)
+            {
+                children[slot] = children[slot - 1];
+                --slot;
+            }
+            children[slot] = {ci, cj, tEnter};
+        }
+    }
+
+    bool hit = false;
+    for (int k = 0; k < childCount; ++k)
+    {
+        if (children[k].tEnter > tBest)
+            break;
+        if (intersectCell(childLevel, children[k].i, children[k].j, originPoint, directionPoint, tBest))
+            hit = true;
+    }
+    return hit;
+}
+
+bool HeightPyramid::intersectRay(const Point3D &origin, const Point3D &direction,
+                                 Point3D &hit, double *tHit) const
+{
+    if (levels.empty())
+        return false;
+
+    // Test the root box, then descend
+    double o[3] = {origin.getX(), origin.getY(), origin.getZ()};
+    double invDirection[3] = {1.0 / direction.getX(), 1.0 / direction.getY(), 1.0 / direction.getZ()};
+    const Level &top = levels.back();
+    double boxMin[3] = {field.getXMin(), field.getYMin(), top.minAt(0, 0)};
+    double boxMax[3] = {field.getXMax(), field.getYMax(), top.maxAt(0, 0)};
+
+    double tEnter;
+    if (!rayBoxEntry(o, invDirection, boxMin, boxMax, tEnter))
+        return false;
+
+    double tBest = std::numeric_limits<double>::infinity();
+    if (!intersectCell(levelCount() - 1, 0, 0, origin, direction, tBest))
+        return false;
+
+    hit = origin + direction * tBest;
+    if (tHit)
+        *tHit = tBest;
+    return true;
+}
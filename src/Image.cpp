@@ -0,0 +1,257 @@
+#include "Image.h"
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <fstream>
+#include <stdexcept>
+
+namespace
+{
+    void writeFile(const std::string &path, const std::vector<uint8_t> &bytes)
+    {
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        if (!out)
+            throw std::runtime_error("Cannot open image file " + path);
+        out.write(reinterpret_cast<const char *>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+        if (!out)
+            throw std::runtime_error("Error writing image file " + path);
+    }
+
+    void appendBigEndian(std::vector<uint8_t> &out, uint32_t value)
+    {
+        for (int shift = 24; shift >= 0; shift -= 8)
+            out.push_back(static_cast<uint8_t>(value >> shift));
+    }
+
+    uint32_t crc32(const uint8_t *data, size_t size, uint32_t crc = 0)
+    {
+        static const std::array<uint32_t, 256> table = []()
+        {
+            std::array<uint32_t, 256> entries;
+            for (uint32_t n = 0; n < 256; ++n)
+            {
+                uint32_t c = n;
+                for (int k = 0; k < 8; ++k)
+                    c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+                entries[n] = c;
+            }
+            return entries;
+        }();
+
+        crc = ~crc;
+        for (size_t i = 0; i < size; ++i)
+            crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+        return ~crc;
+    }
+
+    uint32_t adler32(const std::vector<uint8_t> &data)
+    {
+        uint32_t a = 1, b = 0;
+        for (size_t i = 0; i < data.size();)
+        {
+            // 5552 bytes is the longest run that cannot overflow b
+            size_t end = std::min(data.size(), i + 5552);
+            for (; i < end; ++i)
+            {
+                a += data[i];
+                b += a;
+            }
+            a %= 65521;
+            b %= 65521;
+        }
+        return (b << 16) | a;
+    }
+
+    // Deflate bit stream: values LSB first, Huffman codes MSB first
+    class BitWriter
+    {
+    private:
+        std::vector<uint8_t> &out;
+        uint64_t buffer = 0;
+        int count = 0;
+
+    public:
+        explicit BitWriter(std::vector<uint8_t> &out) : out(out) {}
+
+        void bits(uint32_t value, int length)
+        {
+            buffer |= static_cast<uint64_t>(value) << count;
+            count += length;
+            while (count >= 8)
+            {
+                out.push_back(static_cast<uint8_t>(buffer));
+                buffer >>= 8;
+                count -= 8;
+            }
+        }
+
+        void code(uint32_t code, int length)
+        {
+            uint32_t reversed = 0;
+            for (int k = 0; k < length; ++k)
+                reversed |= ((code >> k) & 1) << (length - 1 - k);
+            bits(reversed, length);
+        }
+
+        void flush()
+        {
+            if (count > 0)
+                out.push_back(static_cast<uint8_t>(buffer));
+            buffer = 0;
+            count = 0;
+        }
+    };
+
+    // Literal/length symbol with the fixed Huffman code of RFC 1951 3.2.6
+    void fixedSymbol(BitWriter &writer, int symbol)
+    {
+        if (symbol < 144)
+            writer.code(0x30 + symbol, 8);
+        else if (symbol < 256)
+            writer.code(0x190 + symbol - 144, 9);
+        else if (symbol < 280)
+            writer.code(symbol - 256, 7);
+        else
+            writer.code(0xC0 + symbol - 280, 8);
+    }
+
+    const int LENGTH_BASE[29] = {3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27,
+                                 31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+    const int LENGTH_EXTRA[29] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2,
+                                  2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+    const int DISTANCE_BASE[30] = {1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129,
+                                   193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097,
+                                   6145, 8193, 12289, 16385, 24577};
+    const int DISTANCE_EXTRA[30] = {0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6,
+                                    6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13};
+
+    void writeMatch(BitWriter &writer, int length, int distance)
+    {
+        int l = 28;
+        while (LENGTH_BASE[l] > length)
+            --l;
+        fixedSymbol(writer, 257 + l);
+        writer.bits(length - LENGTH_BASE[l], LENGTH_EXTRA[l]);
+
+        int d = 29;
+        while (DISTANCE_BASE[d] > distance)
+            --d;
+        writer.code(d, 5);
+        writer.bits(distance - DISTANCE_BASE[d], DISTANCE_EXTRA[d]);
+    }
+
+    // zlib stream with one fixed-Huffman block and greedy LZ77 matching
+    // against the most recent position of each 3-byte hash. Rendered
+    // images are mostly flat background and smooth shading, which this
+    // compresses well at a fraction of the cost of a full deflate.
+    std::vector<uint8_t> zlibCompress(const std::vector<uint8_t> &data)
+    {
+        const int WINDOW = 32768, MAX_MATCH = 258, HASH_BITS = 15;
+        std::vector<uint8_t> out = {0x78, 0x01};
+        BitWriter writer(out);
+        writer.bits(1, 1); // Final block
+        writer.bits(1, 2); // Fixed Huffman codes
+
+        std::vector<int> head(size_t(1) << HASH_BITS, -WINDOW - 1);
+        auto hash = [&](size_t i)
+        {
+            uint32_t v = data[i] | (data[i + 1] << 8) | (data[i + 2] << 16);
+            return (v * 2654435761u) >> (32 - HASH_BITS);
+        };
+
+        size_t size = data.size();
+        size_t i = 0;
+        while (i < size)
+        {
+            int length = 0, distance = 0;
+            if (i + 3 <= size)
+            {
+                uint32_t h = hash(i);
+                int candidate = head[h];
+                head[h] = static_cast<int>(i);
+                if (static_cast<int>(i) - candidate <= WINDOW)
+                {
+                    size_t limit = std::min<size_t>(MAX_MATCH, size - i);
+                    size_t n = 0;
+                    while (n < limit && data[candidate + n] == data[i + n])
+                        ++n;
+                    if (n >= 3)
+                    {
+                        length = static_cast<int>(n);
+                        distance = static_cast<int>(i) - candidate;
+                    }
+                }
+            }
+
+            if (length == 0)
+            {
+                fixedSymbol(writer, data[i]);
+                ++i;
+                continue;
+            }
+
+            writeMatch(writer, length, distance);
+            for (size_t k = i + 1; k < i + length && k + 3 <= size; ++k)
+                head[hash(k)] = static_cast<int>(k);
+            i += length;
+        }
+
+        fixedSymbol(writer, 256);
+        writer.flush();
+        appendBigEndian(out, adler32(data));
+        return out;
+    }
+
+    void appendChunk(std::vector<uint8_t> &png, const char *type, const std::vector<uint8_t> &data)
+    {
+        appendBigEndian(png, static_cast<uint32_t>(data.size()));
+        size_t start = png.size();
+        png.insert(png.end(), type, type + 4);
+        png.insert(png.end(), data.begin(), data.end());
+        appendBigEndian(png, crc32(png.data() + start, png.size() - start));
+    }
+}
+
+void writePpm(const Image &image, const std::string &path)
+{
+    std::string header = "P6\n" + std::to_string(image.width) + " " + std::to_string(image.height) + "\n255\n";
+    std::vector<uint8_t> bytes(header.begin(), header.end());
+    bytes.insert(bytes.end(), image.pixels.begin(), image.pixels.end());
+    writeFile(path, bytes);
+}
+
+void writePng(const Image &image, const std::string &path)
+{
+    // Each scanline starts with its filter type; Sub (1) stores the
+    // difference to the pixel on the left, which is zero on flat areas
+    size_t stride = 3 * static_cast<size_t>(image.width);
+    std::vector<uint8_t> raw;
+    raw.reserve((stride + 1) * image.height);
+    for (int y = 0; y < image.height; ++y)
+    {
+        const uint8_t *row = image.pixel(0, y);
+        raw.push_back(1);
+        for (size_t k = 0; k < stride; ++k)
+            raw.push_back(static_cast<uint8_t>(row[k] - (k >= 3 ? row[k - 3] : 0)));
+    }
+
+    std::vector<uint8_t> png = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+    std::vector<uint8_t> header;
+    appendBigEndian(header, static_cast<uint32_t>(image.width));
+    appendBigEndian(header, static_cast<uint32_t>(image.height));
+    header.insert(header.end(), {8, 2, 0, 0, 0}); // 8-bit RGB, no interlace
+    appendChunk(png, "IHDR", header);
+    appendChunk(png, "IDAT", zlibCompress(raw));
+    appendChunk(png, "IEND", {});
+    writeFile(path, png);
+}
+
+void writeImage(const Image &image, const std::string &path)
+{
+    std::string extension = path.size() >= 4 ? path.substr(path.size() - 4) : "";
+    std::transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
+    if (extension == ".png")
+        writePng(image, path);
+    else
+        writePpm(image, path);
+}
@@ -0,0 +1,179 @@
+#include "Instrumentation.h"
+#include "Trace.h"
+#include <algorithm>
+#include <atomic>
+#include <iomanip>
+#include <mutex>
+#include <vector>
+
+namespace instrumentation
+{
+    const char *counterName(Counter c)
+    {
+        static const char *names[COUNTER_COUNT] = {"evaluations", "gradients", "hessians", "optimizer runs"};
+        return c >= 0 && c < COUNTER_COUNT ? names[c] : "unknown";
+    }
+
+    const char *phaseName(Phase p)
+    {
+        static const char *names[PHASE_COUNT] = {"parse", "compile", "mesh", "optimize", "render"};
+        return p >= 0 && p < PHASE_COUNT ? names[p] : "unknown";
+    }
+
+    void print(std::ostream &out, const Stats &stats)
+    {
+        if (!enabled())
+        {
+            out << "Instrumentation disabled (SURFACE_INSTRUMENTATION=OFF)" << std::endl;
+            return;
+        }
+
+        std::ios::fmtflags flags = out.flags();
+        std::streamsize precision = out.precision();
+        for (int c = 0; c < COUNTER_COUNT; ++c)
+        {
+            if (stats.counters[c] > 0)
+                out << "  " << std::left << std::setw(16) << counterName(Counter(c)) << std::right
+                    << std::setw(14) << stats.counters[c] << std::endl;
+        }
+        for (int p = 0; p < PHASE_COUNT; ++p)
+        {
+            const PhaseTotal &phase = stats.phases[p];
+            if (phase.calls > 0)
+                out << "  " << std::left << std::setw(16) << phaseName(Phase(p)) << std::right
+                    << std::setw(11) << std::fixed << std::setprecision(3) << phase.milliseconds() << " ms in "
+                    << phase.calls << (phase.calls == 1 ? " call" : " calls") << std::endl;
+        }
+        out.flags(flags);
+        out.precision(precision);
+    }
+
+#if SURFACE_INSTRUMENTATION
+
+    namespace
+    {
+        // Written only by its thread; relaxed atomics let snapshot() read
+        // it concurrently at the price of a plain add
+        struct ThreadBlock
+        {
+            std::atomic<uint64_t> counters[COUNTER_COUNT];
+            std::atomic<uint64_t> calls[PHASE_COUNT];
+            std::atomic<uint64_t> nanoseconds[PHASE_COUNT];
+
+            ThreadBlock()
+            {
+                clear();
+            }
+
+            void clear()
+            {
+                for (auto &value : counters)
+                    value.store(0, std::memory_order_relaxed);
+                for (int p = 0; p < PHASE_COUNT; ++p)
+                {
+                    calls[p].store(0, std::memory_order_relaxed);
+                    nanoseconds[p].store(0, std::memory_order_relaxed);
+                }
+            }
+
+            void addTo(Stats &stats) const
+            {
+                for (int c = 0; c < COUNTER_COUNT; ++c)
+                    stats.counters[c] += counters[c].load(std::memory_order_relaxed);
+                for (int p = 0; p < PHASE_COUNT; ++p)
+                {
+                    stats.phases[p].calls += calls[p].load(std::memory_order_relaxed);
+                    stats.phases[p].nanoseconds += nanoseconds[p].load(std::memory_order_relaxed);
+                }
+            }
+        };
+
+        inline void bump(std::atomic<uint64_t> &value, uint64_t n)
+        {
+            value.store(value.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+        }
+
+        // Blocks of live threads, and the totals of threads that have exited
+        struct Registry
+        {
+            std::mutex mutex;
+            std::vector<ThreadBlock *> live;
+            Stats retired;
+        };
+
+        Registry &registry()
+        {
+            static Registry instance;
+            return instance;
+        }
+
+        struct ThreadRegistration
+        {
+            ThreadBlock block;
+
+            ThreadRegistration()
+            {
+                Registry &r = registry();
+                std::lock_guard<std::mutex> lock(r.mutex);
+                r.live.push_back(&block);
+            }
+
+            ~ThreadRegistration()
+            {
+                Registry &r = registry();
+                std::lock_guard<std::mutex> lock(r.mutex);
+                block.addTo(r.retired);
+                r.live.erase(std::find(r.live.begin(), r.live.end(), &block));
+            }
+        };
+
+        ThreadBlock &threadBlock()
+        {
+            thread_local ThreadRegistration registration;
+            return registration.block;
+        }
+    }
+
+    void add(Counter c, uint64_t n)
+    {
+        bump(threadBlock().counters[c], n);
+    }
+
+    void addPhase(Phase p, uint64_t begin, uint64_t end, int64_t value, bool hasValue)
+    {
+        ThreadBlock &block = threadBlock();
+        bump(block.calls[p], 1);
+        bump(block.nanoseconds[p], end - begin);
+        if (tracing::active())
+            tracing::complete("phase", phaseName(p), begin, end, value, hasValue);
+    }
+
+    Stats snapshot()
+    {
+        Registry &r = registry();
+        std::lock_guard<std::mutex> lock(r.mutex);
+        Stats stats = r.retired;
+        for (const ThreadBlock *block : r.live)
+            block->addTo(stats);
+        return stats;
+    }
+
+    void reset()
+    {
+        // Adds racing with a reset may land on either side of it
+        Registry &r = registry();
+        std::lock_guard<std::mutex> lock(r.mutex);
+        r.retired = Stats();
+        for (ThreadBlock *block : r.live)
+            block->clear();
+    }
+
+#else
+
+    void add(Counter, uint64_t) {}
+    void addPhase(Phase, uint64_t, uint64_t, int64_t, bool) {}
+    Stats snapshot() { return Stats(); }
+    void reset() {}
+
+#endif
+}
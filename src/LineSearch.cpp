@@ -0,0 +1,508 @@
+#include "LineSearch.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+namespace
+{
+    double dot(const std::vector<double> &a, const std::vector<double> &b)
+    {
+        double sum = 0.0;
+        for (size_t i = 0; i < a.size(); ++i)
+            sum += a[i] * b[i];
+        return sum;
+    }
+}
+
+// ---- CombinedLineObjective ----
+
+double CombinedLineObjective::value(const std::vector<double> &x)
+{
+    lastX = x;
+    lastGradient.resize(x.size());
+    lastValue = objective(x, lastGradient);
+    calls++;
+    return lastValue;
+}
+
+void CombinedLineObjective::gradient(const std::vector<double> &x, std::vector<double> &grad)
+{
+    if (x != lastX)
+        value(x);
+    grad = lastGradient;
+}
+
+double CombinedLineObjective::valueAndGradient(const std::vector<double> &x, std::vector<double> &grad)
+{
+    double f = value(x);
+    grad = lastGradient;
+    return f;
+}
+
+// ---- LineSearch ----
+
+void LineSearch::moveTo(const std::vector<double> &x, const std::vector<double> &d,
+                        double alpha, LineSearchPoint &point)
+{
+    point.alpha = alpha;
+    point.x.resize(x.size());
+    for (size_t i = 0; i < x.size(); ++i)
+        point.x[i] = x[i] + alpha * d[i];
+}
+
+std::shared_ptr<const LineSearch> LineSearch::create(LineSearchMethod method,
+                                                     const LineSearchOptions &options)
+{
+    switch (method)
+    {
+    case LineSearchMethod::FIXED:
+        return std::make_shared<FixedStep>(options);
+    case LineSearchMethod::ARMIJO:
+        return std::make_shared<ArmijoBacktracking>(options);
+    case LineSearchMethod::STRONG_WOLFE:
+        return std::make_shared<StrongWolfe>(options);
+    case LineSearchMethod::MORE_THUENTE:
+        return std::make_shared<MoreThuente>(options);
+    }
+    throw std::runtime_error("Unknown line search method");
+}
+
+// ---- Fixed step ----
+
+bool FixedStep::search(LineObjective &objective, const std::vector<double> &x,
+                       double, const std::vector<double> &,
+                       const std::vector<double> &d, double initialStep,
+                       LineSearchPoint &accepted) const
+{
+    moveTo(x, d, initialStep, accepted);
+    accepted.f = objective.value(accepted.x);
+    accepted.hasGradient = false;
+    return true;
+}
+
+// ---- Armijo backtracking ----
+
+bool ArmijoBacktracking::search(LineObjective &objective, const std::vector<double> &x,
+                                double f, const std::vector<double> &g,
+                                const std::vector<double> &d, double initialStep,
+                                LineSearchPoint &accepted) const
+{
+    const double slope0 = dot(g, d);
+    if (!(slope0 < 0))
+        return false;
+
+    double alpha = initialStep;
+    double previousAlpha = 0.0, previousF = f;
+
+    for (int step = 0; step < options.maxSteps && alpha >= options.minStep; ++step)
+    {
+        moveTo(x, d, alpha, accepted);
+        double trialF = objective.value(accepted.x);
+
+        if (std::isfinite(trialF) && trialF <= f + options.c1 * alpha * slope0)
+        {
+            accepted.f = trialF;
+            accepted.hasGradient = false;
+            return true;
+        }
+
+        // Minimize an interpolant of the values seen so far (N&W 3.5)
+        double next;
+        if (!std::isfinite(trialF))
+        {
+            next = 0.5 * alpha;
+        }
+        else if (step == 0)
+        {
+            // Quadratic through f, slope0 and the trial
+            next = -slope0 * alpha * alpha / (2.0 * (trialF - f - slope0 * alpha));
+        }
+        else
+        {
+            // Cubic through f, slope0 and the last two trials
+            double r1 = trialF - f - slope0 * alpha;
+            double r0 = previousF - f - slope0 * previousAlpha;
+            double denom = alpha * alpha * previousAlpha * previousAlpha * (alpha - previousAlpha);
+            double a = (previousAlpha * previousAlpha * r1 - alpha * alpha * r0) / denom;
+            double b = (-previousAlpha * previousAlpha * previousAlpha * r1 + alpha * alpha * alpha * r0) / denom;
+            if (a == 0.0)
+                next = -slope0 / (2.0 * b);
+            else
+                next = (-b + std::sqrt(std::max(0.0, b * b - 3.0 * a * slope0))) / (3.0 * a);
+        }
+
+        // Safeguard: shrink by a factor between 2 and 10
+        if (!std::isfinite(next))
+            next = 0.5 * alpha;
+        next = std::min(std::max(next, 0.1 * alpha), 0.5 * alpha);
+
+        previousAlpha = alpha;
+        previousF = trialF;
+        alpha = next;
+    }
+
+    return false;
+}
+
+// ---- Strong Wolfe ----
+
+namespace
+{
+    // Minimizer of the cubic through two trials, or the midpoint when the
+    // cubic has no usable minimum or lands too close to an end
+    double interpolate(const LineSearchPoint &lo, const LineSearchPoint &hi)
+    {
+        double a = lo.alpha, b = hi.alpha;
+        double d1 = lo.slope + hi.slope - 3.0 * (lo.f - hi.f) / (a - b);
+        double disc = d1 * d1 - lo.slope * hi.slope;
+        double mid = 0.5 * (a + b);
+        if (!(disc >= 0.0))
+            return mid;
+
+        double d2 = (b > a ? 1.0 : -1.0) * std::sqrt(disc);
+        double t = b - (b - a) * (hi.slope + d2 - d1) / (hi.slope - lo.slope + 2.0 * d2);
+        double low = std::min(a, b), high = std::max(a, b), margin = 0.1 * (high - low);
+        if (!std::isfinite(t) || t < low + margin || t > high - margin)
+            return mid;
+        return t;
+    }
+
+    void evaluateWithGradient(LineObjective &objective, const std::vector<double> &d,
+                              LineSearchPoint &point)
+    {
+        point.g.resize(point.x.size());
+        point.f = objective.valueAndGradient(point.x, point.g);
+        point.slope = dot(point.g, d);
+        point.hasGradient = true;
+    }
+}
+
+bool StrongWolfe::search(LineObjective &objective, const std::vector<double> &x,
+                         double f, const std::vector<double> &g,
+                         const std::vector<double> &d, double initialStep,
+                         LineSearchPoint &accepted) const
+{
+    const double slope0 = dot(g, d);
+    if (!(slope0 < 0))
+        return false;
+
+    auto sufficientDecrease = [&](const LineSearchPoint &p)
+    { return p.f <= f + options.c1 * p.alpha * slope0; };
+    auto curvature = [&](const LineSearchPoint &p)
+    { return std::abs(p.slope) <= -options.c2 * slope0; };
+
+    // Zoom into [lo, hi], where lo has the lower value
+    auto zoom = [&](LineSearchPoint lo, LineSearchPoint hi, int stepsLeft)
+    {
+        LineSearchPoint trial;
+        for (int step = 0; step < stepsLeft; ++step)
+        {
+            if (std::abs(hi.alpha - lo.alpha) <= std::numeric_limits<double>::epsilon() * lo.alpha)
+                break;
+
+            moveTo(x, d, interpolate(lo, hi), trial);
+            evaluateWithGradient(objective, d, trial);
+
+            if (!std::isfinite(trial.f) || !sufficientDecrease(trial) || trial.f >= lo.f)
+            {
+                hi = trial;
+            }
+            else
+            {
+                if (curvature(trial))
+                {
+                    accepted = trial;
+                    return true;
+                }
+                if (trial.slope * (hi.alpha - lo.alpha) >= 0)
+                    hi = lo;
+                lo = trial;
+            }
+        }
+
+        // Fall back to the best point with sufficient decrease
+        if (lo.alpha > 0)
+        {
+            accepted = lo;
+            return true;
+        }
+        return false;
+    };
+
+    LineSearchPoint previous{0.0, f, slope0, x, g, true};
+    LineSearchPoint current;
+    double alpha = std::min(initialStep, options.maxStep);
+
+    for (int step = 0; step < options.maxSteps; ++step)
+    {
+        moveTo(x, d, alpha, current);
+        evaluateWithGradient(objective, d, current);
+
+        // Overflow: back off towards the last good step
+        if (!std::isfinite(current.f))
+        {
+            alpha = 0.5 * (previous.alpha + alpha);
+            continue;
+        }
+
+        if (!sufficientDecrease(current) || (step > 0 && current.f >= previous.f))
+            return zoom(previous, current, options.maxSteps - step);
+
+        if (curvature(current))
+        {
+            accepted = current;
+            return true;
+        }
+
+        if (current.slope >= 0)
+            return zoom(current, previous, options.maxSteps - step);
+
+        previous = current;
+        alpha = std::min(2.0 * alpha, options.maxStep);
+    }
+
+    if (previous.alpha > 0)
+    {
+        accepted = previous;
+        return true;
+    }
+    return false;
+}
+
+// ---- More-Thuente ----
+
+namespace
+{
+    // Safeguarded step of More & Thuente (MINPACK-2 dcstep): updates the
+    // interval [stx, sty] that contains a step satisfying the Wolfe
+    // conditions and returns the next trial step in stp
+    void moreThuenteStep(double &stx, double &fx, double &dx,
+                         double &sty, double &fy, double &dy,
+                         double &stp, double fp, double dp,
+                         bool &bracketed, double stpmin, double stpmax)
+    {
+        const double sgnd = dp * (dx / std::abs(dx));
+        double stpf;
+
+        if (fp > fx)
+        {
+            // Higher value: the minimum is bracketed
+            double theta = 3.0 * (fx - fp) / (stp - stx) + dx + dp;
+            double s = std::max(std::abs(theta), std::max(std::abs(dx), std::abs(dp)));
+            double gamma = s * std::sqrt(std::max(0.0, (theta / s) * (theta / s) - (dx / s) * (dp / s)));
+            if (stp < stx)
+                gamma = -gamma;
+            double p = (gamma - dx) + theta;
+            double q = ((gamma - dx) + gamma) + dp;
+            double stpc = stx + (p / q) * (stp - stx);
+            double stpq = stx + ((dx / ((fx - fp) / (stp - stx) + dx)) / 2.0) * (stp - stx);
+            stpf = std::abs(stpc - stx) < std::abs(stpq - stx) ? stpc : stpc + (stpq - stpc) / 2.0;
+            bracketed = true;
+        }
+        else if (sgnd < 0.0)
+        {
+            // Derivatives of opposite sign: the minimum is bracketed
+            double theta = 3.0 * (fx - fp) / (stp - stx) + dx + dp;
+            double s = std::max(std::abs(theta), std::max(std::abs(dx), std::abs(dp)));
+            double gamma = s * std::sqrt(std::max(0.0, (theta / s) * (theta / s) - (dx / s) * (dp / s)));
+            if (stp > stx)
+                gamma = -gamma;
+            double p = (gamma - dp) + theta;
+            double q = ((gamma - dp) + gamma) + dx;
+            double stpc = stp + (p / q) * (stx - stp);
+            double stpq = stp + (dp / (dp - dx)) * (stx - stp);
+            stpf = std::abs(stpc - stp) > std::abs(stpq - stp) ? stpc : stpq;
+            bracketed = true;
+        }
+        else if (std::abs(dp) < std::abs(dx))
+        {
+            // Lower value, same sign, smaller derivative
+            double theta = 3.0 * (fx - fp) / (stp - stx) + dx + dp;
+            double s = std::max(std::abs(theta), std::max(std::abs(dx), std::abs(dp)));
+            double gamma = s * std::sqrt(std::max(0.0, (theta / s) * (theta / s) - (dx / s) * (dp / s)));
+            if (stp > stx)
+                gamma = -gamma;
+            double p = (gamma - dp) + theta;
+            double q = (gamma + (dx - dp)) + gamma;
+            double r = p / q;
+            double stpc;
+            if (r < 0.0 && gamma != 0.0)
+                stpc = stp + r * (stx - stp);
+            else if (stp > stx)
+                stpc = stpmax;
+            else
+                stpc = stpmin;
+            double stpq = stp + (dp / (dp - dx)) * (stx - stp);
+
+            if (bracketed)
+            {
+                stpf = std::abs(stpc - stp) < std::abs(stpq - stp) ? stpc : stpq;
+                if (stp > stx)
+                    stpf = std::min(stp + 0.66 * (sty - stp), stpf);
+                else
+                    stpf = std::max(stp + 0.66 * (sty - stp), stpf);
+            }
+            else
+            {
+                stpf = std::abs(stpc - stp) > std::abs(stpq - stp) ? stpc : stpq;
+                stpf = std::max(stpmin, std::min(stpmax, stpf));
+            }
+        }
+        else
+        {
+            // Lower value, same sign, derivative not decreasing
+            if (bracketed)
+            {
+                double theta = 3.0 * (fp - fy) / (sty - stp) + dy + dp;
+                double s = std::max(std::abs(theta), std::max(std::abs(dy), std::abs(dp)));
+                double gamma = s * std::sqrt(std::max(0.0, (theta / s) * (theta / s) - (dy / s) * (dp / s)));
+                if (stp > sty)
+                    gamma = -gamma;
+                double p = (gamma - dp) + theta;
+                double q = ((gamma - dp) + gamma) + dy;
+                stpf = stp + (p / q) * (sty - stp);
+            }
+            else
+            {
+                stpf = stp > stx ? stpmax : stpmin;
+            }
+        }
+
+        // Update the interval
+        if (fp > fx)
+        {
+            sty = stp;
+            fy = fp;
+            dy = dp;
+        }
+        else
+        {
+            if (sgnd < 0.0)
+            {
+                sty = stx;
+                fy = fx;
+                dy = dx;
+            }
+            stx = stp;
+            fx = fp;
+            dx = dp;
+        }
+
+        stp = stpf;
+    }
+}
+
+bool MoreThuente::search(LineObjective &objective, const std::vector<double> &x,
+                         double f, const std::vector<double> &g,
+                         const std::vector<double> &d, double initialStep,
+                         LineSearchPoint &accepted) const
+{
+    const double xtol = 1e-10;
+    const double extrapolateLower = 1.1, extrapolateUpper = 4.0;
+
+    const double finit = f;
+    const double ginit = dot(g, d);
+    if (!(ginit < 0))
+        return false;
+    const double gtest = options.c1 * ginit;
+
+    double stp = std::min(std::max(initialStep, options.minStep), options.maxStep);
+    double width = options.maxStep - options.minStep;
+    double width1 = 2.0 * width;
+
+    double stx = 0.0, fx = finit, gx = ginit;
+    double sty = 0.0, fy = finit, gy = ginit;
+    double stmin = 0.0, stmax = stp + extrapolateUpper * stp;
+    bool bracketed = false;
+    bool stage1 = true;
+
+    // Lowest point with sufficient decrease, returned if the search stalls
+    LineSearchPoint trial, best;
+    best.alpha = 0.0;
+    best.f = finit;
+
+    for (int step = 0; step < options.maxSteps; ++step)
+    {
+        moveTo(x, d, stp, trial);
+        evaluateWithGradient(objective, d, trial);
+
+        // Overflow: shrink towards the best step so far
+        if (!std::isfinite(trial.f))
+        {
+            bracketed = true;
+            sty = stp;
+            fy = std::numeric_limits<double>::max();
+            stmax = stp;
+            stp = stx + 0.5 * (stp - stx);
+            continue;
+        }
+
+        double fp = trial.f, dp = trial.slope;
+        double ftest = finit + stp * gtest;
+
+        if (fp <= ftest && (best.alpha == 0.0 || fp < best.f))
+            best = trial;
+
+        if (stage1 && fp <= ftest && dp >= 0.0)
+            stage1 = false;
+
+        // Converged: sufficient decrease and strong curvature
+        if (fp <= ftest && std::abs(dp) <= -options.c2 * ginit)
+        {
+            accepted = trial;
+            return true;
+        }
+
+        // No further progress possible
+        if ((bracketed && (stp <= stmin || stp >= stmax)) ||
+            (bracketed && stmax - stmin <= xtol * stmax) ||
+            (stp == options.maxStep && fp <= ftest && dp <= gtest) ||
+            (stp == options.minStep && (fp > ftest || dp >= gtest)))
+            break;
+
+        if (stage1 && fp <= fx && fp > ftest)
+        {
+            // Work with the modified function psi(a) = f(a) - f(0) - c1 a f'(0)
+            double fm = fp - stp * gtest, fxm = fx - stx * gtest, fym = fy - sty * gtest;
+            double gm = dp - gtest, gxm = gx - gtest, gym = gy - gtest;
+            moreThuenteStep(stx, fxm, gxm, sty, fym, gym, stp, fm, gm, bracketed, stmin, stmax);
+            fx = fxm + stx * gtest;
+            fy = fym + sty * gtest;
+            gx = gxm + gtest;
+            gy = gym + gtest;
+        }
+        else
+        {
+            moreThuenteStep(stx, fx, gx, sty, fy, gy, stp, fp, dp, bracketed, stmin, stmax);
+        }
+
+        // Force sufficient shrinkage of the interval
+        if (bracketed)
+        {
+            if (std::abs(sty - stx) >= 0.66 * width1)
+                stp = stx + 0.5 * (sty - stx);
+            width1 = width;
+            width = std::abs(sty - stx);
+            stmin = std::min(stx, sty);
+            stmax = std::max(stx, sty);
+        }
+        else
+        {
+            stmin = stp + extrapolateLower * (stp - stx);
+            stmax = stp + extrapolateUpper * (stp - stx);
+        }
+
+        stp = std::min(std::max(stp, options.minStep), options.maxStep);
+        if ((bracketed && (stp <= stmin || stp >= stmax)) ||
+            (bracketed && stmax - stmin <= xtol * stmax))
+            stp = stx;
+    }
+
+    if (best.alpha > 0.0)
+    {
+        accepted = best;
+        return true;
+    }
+    return false;
+}
@@ -0,0 +1,166 @@
+#include "MappedFile.h"
+#include <stdexcept>
+#include <utility>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+
+MappedFile::MappedFile()
+    : bytes(nullptr), length(0), fileHandle(nullptr), mappingHandle(nullptr) {}
+
+MappedFile::MappedFile(const std::string &path)
+    : bytes(nullptr), length(0), path(path), fileHandle(nullptr), mappingHandle(nullptr)
+{
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                              OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+        throw std::runtime_error("Cannot open file: " + path);
+    fileHandle = file;
+
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0)
+    {
+        close();
+        throw std::runtime_error("Cannot map empty file: " + path);
+    }
+    length = static_cast<size_t>(fileSize.QuadPart);
+
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!mapping)
+    {
+        close();
+        throw std::runtime_error("Cannot create file mapping: " + path);
+    }
+    mappingHandle = mapping;
+
+    bytes = static_cast<const unsigned char *>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+    if (!bytes)
+    {
+        close();
+        throw std::runtime_error("Cannot map file: " + path);
+    }
+}
+
+void MappedFile::close()
+{
+    if (bytes)
+        UnmapViewOfFile(bytes);
+    if (mappingHandle)
+        CloseHandle(static_cast<HANDLE>(mappingHandle));
+    if (fileHandle)
+        CloseHandle(static_cast<HANDLE>(fileHandle));
+    bytes = nullptr;
+    length = 0;
+    mappingHandle = nullptr;
+    fileHandle = nullptr;
+}
+
+MappedFile::MappedFile(MappedFile &&other) noexcept
+    : bytes(other.bytes), length(other.length), path(std::move(other.path)),
+      fileHandle(other.fileHandle), mappingHandle(other.mappingHandle)
+{
+    other.bytes = nullptr;
+    other.length = 0;
+    other.fileHandle = nullptr;
+    other.mappingHandle = nullptr;
+}
+
+MappedFile &MappedFile::operator=(MappedFile &&other) noexcept
+{
+    if (this != &other)
+    {
+        close();
+        bytes = other.bytes;
+        length = other.length;
+        path = std::move(other.path);
+        fileHandle = other.fileHandle;
+        mappingHandle = other.mappingHandle;
+        other.bytes = nullptr;
+        other.length = 0;
+        other.fileHandle = nullptr;
+        other.mappingHandle = nullptr;
+    }
+    return *this;
+}
+
+#else
+
+MappedFile::MappedFile() : bytes(nullptr), length(0), fileDescriptor(-1) {}
+
+MappedFile::MappedFile(const std::string &path)
+    : bytes(nullptr), length(0), path(path), fileDescriptor(-1)
+{
+    fileDescriptor = ::open(path.c_str(), O_RDONLY);
+    if (fileDescriptor < 0)
+        throw std::runtime_error("Cannot open file: " + path);
+
+    struct stat info;
+    if (::fstat(fileDescriptor, &info) != 0 || info.st_size == 0)
+    {
+        close();
+        throw std::runtime_error("Cannot map empty file: " + path);
+    }
+    length = static_cast<size_t>(info.st_size);
+
+    void *address = ::mmap(nullptr, length, PROT_READ, MAP_SHARED, fileDescriptor, 0);
+    if (address == MAP_FAILED)
+    {
+        close();
+        throw std::runtime_error("Cannot map file: " + path);
+    }
+    bytes = static_cast<const unsigned char *>(address);
+}
+
+void MappedFile::close()
+{
+    if (bytes)
+        ::munmap(const_cast<unsigned char *>(bytes), length);
+    if (fileDescriptor >= 0)
+        ::close(fileDescriptor);
+    bytes = nullptr;
+    length = 0;
+    fileDescriptor = -1;
+}
+
+MappedFile::MappedFile(MappedFile &&other) noexcept
+    : bytes(other.bytes), length(other.length), path(std::move(other.path)),
+      fileDescriptor(other.fileDescriptor)
+{
+    other.bytes = nullptr;
+    other.length = 0;
+    other.fileDescriptor = -1;
+}
+
+MappedFile &MappedFile::operator=(MappedFile &&other) noexcept
+{
+    if (this != &other)
+    {
+        close();
+        bytes = other.bytes;
+        length = other.length;
+        path = std::move(other.path);
+        fileDescriptor = other.fileDescriptor;
+        other.bytes = nullptr;
+        other.length = 0;
+        other.fileDescriptor = -1;
+    }
+    return *this;
+}
+
+#endif
+
+MappedFile::~MappedFile()
+{
+    close();
+}
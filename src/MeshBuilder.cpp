@@ -0,0 +1,79 @@
+#include "MeshBuilder.h"
+#include "ByteOrder.h"
+#include <cstring>
+#include <fstream>
+
+void writeObj(const GridMeshF &mesh, const std::string &path)
+{
+    std::ofstream out(path);
+    if (!out)
+        throw std::runtime_error("Cannot open mesh file " + path);
+
+    out << "# " << mesh.vertexCount() << " vertices, " << mesh.triangleCount() << " triangles\n";
+    for (size_t v = 0; v < mesh.vertexCount(); ++v)
+        out << "v " << mesh.positions[3 * v] << ' ' << mesh.positions[3 * v + 1] << ' '
+            << mesh.positions[3 * v + 2] << '\n';
+    for (size_t v = 0; v < mesh.vertexCount(); ++v)
+        out << "vn " << mesh.normals[3 * v] << ' ' << mesh.normals[3 * v + 1] << ' '
+            << mesh.normals[3 * v + 2] << '\n';
+
+    // OBJ indices start at 1; each vertex has the normal of the same index
+    for (size_t t = 0; t < mesh.triangleCount(); ++t)
+    {
+        out << 'f';
+        for (int k = 0; k < 3; ++k)
+        {
+            uint32_t index = mesh.indices[3 * t + k] + 1;
+            out << ' ' << index << "//" << index;
+        }
+        out << '\n';
+    }
+
+    if (!out)
+        throw std::runtime_error("Error writing mesh file " + path);
+}
+
+void writeStl(const GridMeshF &mesh, const std::string &path)
+{
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out)
+        throw std::runtime_error("Cannot open mesh file " + path);
+
+    // 80-byte header, little-endian triangle count, then 50 bytes per
+    // triangle: facet normal, three corners and an unused attribute word
+    char header[80] = {};
+    std::strncpy(header, "surface mesh", sizeof(header));
+    out.write(header, sizeof(header));
+    uint32_t count = static_cast<uint32_t>(mesh.triangleCount());
+    uint32_t countBytes = littleEndian(count);
+    out.write(reinterpret_cast<const char *>(&countBytes), sizeof(countBytes));
+
+    std::vector<char> records(50 * static_cast<size_t>(count));
+    for (size_t t = 0; t < count; ++t)
+    {
+        const float *a = &mesh.positions[3 * mesh.indices[3 * t]];
+        const float *b = &mesh.positions[3 * mesh.indices[3 * t + 1]];
+        const float *c = &mesh.positions[3 * mesh.indices[3 * t + 2]];
+
+        float e1[3] = {b[0] - a[0], b[1] - a[1], b[2] - a[2]};
+        float e2[3] = {c[0] - a[0], c[1] - a[1], c[2] - a[2]};
+        float facet[12] = {e1[1] * e2[2] - e1[2] * e2[1],
+                           e1[2] * e2[0] - e1[0] * e2[2],
+                           e1[0] * e2[1] - e1[1] * e2[0],
+                           a[0], a[1], a[2], b[0], b[1], b[2], c[0], c[1], c[2]};
+        float length = std::sqrt(facet[0] * facet[0] + facet[1] * facet[1] + facet[2] * facet[2]);
+        if (length > 0.0f)
+            for (int k = 0; k < 3; ++k)
+                facet[k] /= length;
+
+        littleEndianArray(facet, 12);
+
+        char *record = records.data() + 50 * t;
+        std::memcpy(record, facet, sizeof(facet));
+        std::memset(record + sizeof(facet), 0, 2);
+    }
+    out.write(records.data(), static_cast<std::streamsize>(records.size()));
+
+    if (!out)
+        throw std::runtime_error("Error writing mesh file " + path);
+}
@@ -0,0 +1,319 @@
+#include "MeshCache.h"
+#include "ByteOrder.h"
+#include "MappedFile.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <stdexcept>
+#include <thread>
+
+namespace fs = std::filesystem;
+
+static_assert(sizeof(MeshCacheHeader) == 88, "MeshCacheHeader must match the on-disk layout");
+
+static const char MESH_MAGIC[8] = {'S', 'O', 'M', 'E', 'S', 'H', '\0', '\0'};
+
+static const uint64_t FNV_OFFSET = 14695981039346656037ull;
+static const uint64_t FNV_PRIME = 1099511628211ull;
+
+// FNV-1a style checksum over 8-byte words, fed in arbitrary chunks
+class PayloadChecksum
+{
+private:
+    uint64_t hash;
+    unsigned char pending[8];
+    size_t pendingBytes;
+
+    void mix(uint64_t word)
+    {
+        hash = (hash ^ word) * FNV_PRIME;
+        hash ^= hash >> 32;
+    }
+
+public:
+    PayloadChecksum() : hash(FNV_OFFSET), pendingBytes(0) {}
+
+    void update(const void *data, size_t size)
+    {
+        const unsigned char *bytes = static_cast<const unsigned char *>(data);
+
+        if (pendingBytes > 0)
+        {
+            size_t take = std::min(size, sizeof(pending) - pendingBytes);
+            std::memcpy(pending + pendingBytes, bytes, take);
+            pendingBytes += take;
+            bytes += take;
+            size -= take;
+            if (pendingBytes < sizeof(pending))
+                return;
+
+            uint64_t word;
+            std::memcpy(&word, pending, 8);
+            mix(word);
+            pendingBytes = 0;
+        }
+
+        for (; size >= 8; bytes += 8, size -= 8)
+        {
+            uint64_t word;
+            std::memcpy(&word, bytes, 8);
+            mix(word);
+        }
+
+        std::memcpy(pending, bytes, size);
+        pendingBytes = size;
+    }
+
+    uint64_t finish()
+    {
+        if (pendingBytes > 0)
+        {
+            uint64_t word = 0;
+            std::memcpy(&word, pending, pendingBytes);
+            mix(word ^ (static_cast<uint64_t>(pendingBytes) << 56));
+            pendingBytes = 0;
+        }
+        return hash;
+    }
+};
+
+static uint64_t fnv1a(const void *data, size_t size, uint64_t hash = FNV_OFFSET)
+{
+    const unsigned char *bytes = static_cast<const unsigned char *>(data);
+    for (size_t i = 0; i < size; ++i)
+        hash = (hash ^ bytes[i]) * FNV_PRIME;
+    return hash;
+}
+
+static uint64_t alignTo8(uint64_t offset)
+{
+    return (offset + 7) & ~uint64_t(7);
+}
+
+MeshCache::MeshCache() : directory(defaultDirectory()) {}
+
+MeshCache::MeshCache(const std::string &dir) : directory(dir) {}
+
+std::string MeshCache::defaultDirectory()
+{
+    if (const char *custom = std::getenv("SURFACE_OPTIMIZER_CACHE"))
+        return custom;
+
+#ifdef _WIN32
+    if (const char *localAppData = std::getenv("LOCALAPPDATA"))
+        return (fs::path(localAppData) / "SurfaceOptimizer" / "cache").string();
+#else
+    if (const char *xdgCache = std::getenv("XDG_CACHE_HOME"))
+        return (fs::path(xdgCache) / "surface-optimizer").string();
+    if (const char *home = std::getenv("HOME"))
+        return (fs::path(home) / ".cache" / "surface-optimizer").string();
+#endif
+
+    std::error_code error;
+    fs::path temp = fs::temp_directory_path(error);
+    return ((error ? fs::path(".") : temp) / "surface-optimizer-cache").string();
+}
+
+uint64_t MeshCache::hashEquation(const std::string &equation)
+{
+    return fnv1a(equation.data(), equation.size());
+}
+
+std::string MeshCache::pathFor(uint64_t equationHash,
+                               double xMin, double xMax, double yMin, double yMax,
+                               int resolution, bool withNormals) const
+{
+    uint64_t key = fnv1a(&equationHash, sizeof(equationHash));
+    double bounds[4] = {xMin, xMax, yMin, yMax};
+    key = fnv1a(bounds, sizeof(bounds), key);
+    key = fnv1a(&resolution, sizeof(resolution), key);
+    key = fnv1a(&withNormals, sizeof(withNormals), key);
+
+    char name[32];
+    std::snprintf(name, sizeof(name), "mesh-%016llx.smc", static_cast<unsigned long long>(key));
+    return (fs::path(directory) / name).string();
+}
+
+bool MeshCache::load(uint64_t equationHash,
+                     double xMin, double xMax, double yMin, double yMax,
+                     int resolution, bool withNormals, HeightField &field) const
+{
+    std::string path = pathFor(equationHash, xMin, xMax, yMin, yMax, resolution, withNormals);
+
+    std::error_code error;
+    if (!fs::exists(path, error))
+        return false;
+
+    try
+    {
+        MeshCacheHeader header;
+        HeightField cached = readFile(path, &header);
+
+        // The file name is only a hash; confirm the full key
+        if (header.equationHash != equationHash ||
+            header.xMin != xMin || header.xMax != xMax ||
+            header.yMin != yMin || header.yMax != yMax ||
+            header.columns != static_cast<uint32_t>(resolution + 1) ||
+            header.rows != static_cast<uint32_t>(resolution + 1) ||
+            (withNormals && !cached.hasNormals()))
+            return false;
+
+        field = cached;
+        return true;
+    }
+    catch (const std::exception &)
+    {
+        // Corrupt or stale entries are treated as misses and overwritten
+        return false;
+    }
+}
+
+bool MeshCache::store(uint64_t equationHash, const HeightField &field) const
+{
+    int resolution = field.getColumns() - 1;
+    std::string path = pathFor(equationHash, field.getXMin(), field.getXMax(),
+                               field.getYMin(), field.getYMax(), resolution, field.hasNormals());
+
+    static std::atomic<unsigned> counter(0);
+    std::string tempPath = path + ".tmp" +
+                           std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id())) +
+                           "-" + std::to_string(counter++);
+
+    std::error_code error;
+    fs::create_directories(directory, error);
+
+    try
+    {
+        writeFile(tempPath, equationHash, field);
+    }
+    catch (const std::exception &)
+    {
+        fs::remove(tempPath, error);
+        return false;
+    }
+
+    // Readers only ever see complete files
+    fs::rename(tempPath, path, error);
+    if (error)
+    {
+        fs::remove(tempPath, error);
+        return false;
+    }
+    return true;
+}
+
+HeightField MeshCache::getOrCreate(uint64_t equationHash, const Surface &surface,
+                                   double xMin, double xMax, double yMin, double yMax,
+                                   int resolution, bool withNormals) const
+{
+    HeightField field;
+    if (load(equationHash, xMin, xMax, yMin, yMax, resolution, withNormals, field))
+        return field;
+
+    field = surface.sampleHeightField(xMin, xMax, yMin, yMax, resolution, withNormals);
+    store(equationHash, field);
+    return field;
+}
+
+void MeshCache::writeFile(const std::string &path, uint64_t equationHash,
+                          const HeightField &field)
+{
+    if (field.empty())
+        throw std::runtime_error("Cannot cache an empty height field");
+
+    size_t count = field.sampleCount();
+
+    MeshCacheHeader header;
+    std::memcpy(header.magic, MESH_MAGIC, sizeof(MESH_MAGIC));
+    header.version = MESH_CACHE_VERSION;
+    header.flags = field.hasNormals() ? FLAG_NORMALS : 0;
+    header.equationHash = equationHash;
+    header.xMin = field.getXMin();
+    header.xMax = field.getXMax();
+    header.yMin = field.getYMin();
+    header.yMax = field.getYMax();
+    header.columns = static_cast<uint32_t>(field.getColumns());
+    header.rows = static_cast<uint32_t>(field.getRows());
+    header.heightOffset = sizeof(MeshCacheHeader);
+    header.normalOffset = field.hasNormals() ? alignTo8(header.heightOffset + count * sizeof(float)) : 0;
+
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out)
+        throw std::runtime_error("Cannot write mesh cache: " + path);
+
+    // Header is rewritten once the checksum is known
+    header.checksum = 0;
+    out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+
+    PayloadChecksum checksum;
+    auto writePayload = [&](const void *data, size_t size)
+    {
+        out.write(static_cast<const char *>(data), size);
+        checksum.update(data, size);
+    };
+
+    writePayload(field.getHeights(), count * sizeof(float));
+    if (field.hasNormals())
+    {
+        static const char padding[8] = {};
+        writePayload(padding, header.normalOffset - (header.heightOffset + count * sizeof(float)));
+        writePayload(field.getNormals(), 3 * count * sizeof(float));
+    }
+
+    header.checksum = checksum.finish();
+    out.seekp(0);
+    out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+
+    if (!out)
+        throw std::runtime_error("Failed writing mesh cache: " + path);
+}
+
+HeightField MeshCache::readFile(const std::string &path, MeshCacheHeader *headerOut)
+{
+    auto file = std::make_shared<MappedFile>(path);
+    if (file->size() < sizeof(MeshCacheHeader))
+        throw std::runtime_error("Mesh cache too small: " + path);
+
+    MeshCacheHeader header;
+    std::memcpy(&header, file->data(), sizeof(header));
+
+    if (std::memcmp(header.magic, MESH_MAGIC, sizeof(MESH_MAGIC)) != 0)
+        throw std::runtime_error("Not a mesh cache file: " + path);
+    if (header.version == byteSwapped(MESH_CACHE_VERSION))
+        throw std::runtime_error("Mesh cache was written with the other byte order: " + path);
+    if (header.version != MESH_CACHE_VERSION)
+        throw std::runtime_error("Unsupported mesh cache version: " + path);
+    if (header.columns < 2 || header.rows < 2 || header.heightOffset != sizeof(MeshCacheHeader))
+        throw std::runtime_error("Malformed mesh cache: " + path);
+
+    uint64_t count = static_cast<uint64_t>(header.columns) * header.rows;
+    uint64_t end = header.heightOffset + count * sizeof(float);
+    bool withNormals = (header.flags & FLAG_NORMALS) != 0;
+    if (withNormals)
+    {
+        if (header.normalOffset != alignTo8(end))
+            throw std::runtime_error("Malformed mesh cache: " + path);
+        end = header.normalOffset + 3 * count * sizeof(float);
+    }
+    if (end != file->size())
+        throw std::runtime_error("Mesh cache truncated: " + path);
+
+    PayloadChecksum checksum;
+    checksum.update(file->data() + sizeof(MeshCacheHeader), file->size() - sizeof(MeshCacheHeader));
+    if (checksum.finish() != header.checksum)
+        throw std::runtime_error("Mesh cache checksum mismatch: " + path);
+
+    if (headerOut)
+        *headerOut = header;
+
+    const float *heights = reinterpret_cast<const float *>(file->data() + header.heightOffset);
+    const float *normals = withNormals ? reinterpret_cast<const float *>(file->data() + header.normalOffset) : nullptr;
+    return HeightField(header.xMin, header.xMax, header.yMin, header.yMax,
+                       static_cast<int>(header.columns), static_cast<int>(header.rows),
+                       heights, normals, file);
+}
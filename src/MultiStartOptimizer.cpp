@@ -0,0 +1,250 @@
+#include "MultiStartOptimizer.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <stdexcept>
+
+namespace
+{
+    // Forwards to a surface and counts the calls one run makes
+    class CountingSurface : public Surface
+    {
+    private:
+        const Surface *inner;
+
+    public:
+        mutable long long functionCalls = 0;
+        mutable long long gradientCalls = 0;
+        mutable long long hessianCalls = 0;
+
+        explicit CountingSurface(const Surface *surf) : inner(surf) {}
+
+        double evaluate(double x, double y) const override
+        {
+            ++functionCalls;
+            return inner->evaluate(x, y);
+        }
+
+        double partialX(double x, double y) const override
+        {
+            ++gradientCalls;
+            return inner->partialX(x, y);
+        }
+
+        double partialY(double x, double y) const override
+        {
+            ++gradientCalls;
+            return inner->partialY(x, y);
+        }
+
+        Point3D gradient(double x, double y) const override
+        {
+            ++gradientCalls;
+            return inner->gradient(x, y);
+        }
+
+        void hessian(double x, double y, double &fxx, double &fxy, double &fyy) const override
+        {
+            ++hessianCalls;
+            inner->hessian(x, y, fxx, fxy, fyy);
+        }
+    };
+
+    double secondsSince(std::chrono::steady_clock::time_point start)
+    {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+}
+
+const OptimizationResult *MultiStartResult::best() const
+{
+    if (!minima.empty())
+        return &runs[minima.front().bestRun];
+
+    const OptimizationResult *lowest = nullptr;
+    for (const OptimizationResult &run : runs)
+        if (!lowest || run.minimumValue < lowest->minimumValue)
+            lowest = &run;
+    return lowest;
+}
+
+MultiStartOptimizer::MultiStartOptimizer(const Surface *surf, OptimizerFactory factory,
+                                         const MultiStartOptions &options)
+    : surface(surf), factory(factory), options(options)
+{
+    if (!this->factory)
+        this->factory = gradientDescent();
+    if (options.starts < 1)
+        throw std::runtime_error("Multi-start needs at least one start");
+}
+
+MultiStartOptimizer::OptimizerFactory MultiStartOptimizer::gradientDescent(double lr, int maxIter, double tol)
+{
+    return [lr, maxIter, tol](const Surface *surf)
+    {
+        return std::unique_ptr<Optimizer>(new GradientDescent(surf, lr, maxIter, tol));
+    };
+}
+
+std::vector<Point3D> MultiStartOptimizer::generateStarts(StartPattern pattern, int count, unsigned seed,
+                                                         double xMin, double xMax, double yMin, double yMax)
+{
+    std::vector<Point3D> starts;
+    starts.reserve(count);
+
+    double width = xMax - xMin;
+    double height = yMax - yMin;
+
+    switch (pattern)
+    {
+    case StartPattern::GRID:
+    {
+        int columns = static_cast<int>(std::ceil(std::sqrt(static_cast<double>(count))));
+        int rows = (count + columns - 1) / columns;
+        for (int k = 0; k < count; ++k)
+        {
+            int i = k % columns;
+            int j = k / columns;
+            starts.push_back(Point3D(xMin + (i + 0.5) * width / columns,
+                                     yMin + (j + 0.5) * height / rows, 0));
+        }
+        break;
+    }
+    case StartPattern::RANDOM:
+    {
+        std::mt19937 engine(seed);
+        std::uniform_real_distribution<double> unit(0.0, 1.0);
+        for (int k = 0; k < count; ++k)
+        {
+            double u = unit(engine);
+            double v = unit(engine);
+            starts.push_back(Point3D(xMin + u * width, yMin + v * height, 0));
+        }
+        break;
+    }
+    case StartPattern::SOBOL:
+    {
+        // Direction numbers: dimension 1 is van der Corput, dimension 2
+        // uses the primitive polynomial x + 1
+        uint32_t v1[32], v2[32];
+        for (int b = 0; b < 32; ++b)
+        {
+            v1[b] = 1u << (31 - b);
+            v2[b] = b == 0 ? 1u << 31 : v2[b - 1] ^ (v2[b - 1] >> 1);
+        }
+
+        // Gray-code order, skipping the corner point at index 0
+        uint32_t a = 0, c = 0;
+        for (uint32_t n = 1; n <= static_cast<uint32_t>(count); ++n)
+        {
+            int bit = 0;
+            while (!((n >> bit) & 1u))
+                ++bit;
+            a ^= v1[bit];
+            c ^= v2[bit];
+            starts.push_back(Point3D(xMin + a * (width / 4294967296.0),
+                                     yMin + c * (height / 4294967296.0), 0));
+        }
+        break;
+    }
+    }
+
+    return starts;
+}
+
+MultiStartResult MultiStartOptimizer::optimize(double xMin, double xMax, double yMin, double yMax) const
+{
+    auto wallStart = std::chrono::steady_clock::now();
+
+    MultiStartResult result;
+    result.starts = generateStarts(options.pattern, options.starts, options.seed, xMin, xMax, yMin, yMax);
+    result.runs.resize(result.starts.size());
+
+    std::vector<long long> functionCalls(result.starts.size(), 0);
+    std::vector<long long> gradientCalls(result.starts.size(), 0);
+    std::vector<long long> hessianCalls(result.starts.size(), 0);
+    std::vector<double> runTimes(result.starts.size(), 0.0);
+
+    ThreadPool &pool = options.pool ? *options.pool : ThreadPool::shared();
+    pool.parallelFor(0, result.starts.size(), 1, [&](size_t begin, size_t end)
+                     {
+        for (size_t k = begin; k < end; ++k)
+        {
+            auto runStart = std::chrono::steady_clock::now();
+
+            CountingSurface counted(surface);
+            std::unique_ptr<Optimizer> optimizer = factory(&counted);
+            optimizer->setPathRecording(options.pathRecording);
+            result.runs[k] = optimizer->optimize(result.starts[k].getX(), result.starts[k].getY());
+
+            functionCalls[k] = counted.functionCalls;
+            gradientCalls[k] = counted.gradientCalls;
+            hessianCalls[k] = counted.hessianCalls;
+            runTimes[k] = secondsSince(runStart);
+        } });
+
+    // Aggregate and merge in start order so the outcome is deterministic
+    result.convergedRuns = 0;
+    result.totalIterations = 0;
+    result.functionEvaluations = 0;
+    result.gradientEvaluations = 0;
+    result.hessianEvaluations = 0;
+    result.runSeconds = 0.0;
+
+    double tol2 = options.mergeTolerance * options.mergeTolerance;
+    for (size_t k = 0; k < result.runs.size(); ++k)
+    {
+        const OptimizationResult &run = result.runs[k];
+        result.totalIterations += run.iterations;
+        result.functionEvaluations += functionCalls[k];
+        result.gradientEvaluations += gradientCalls[k];
+        result.hessianEvaluations += hessianCalls[k];
+        result.runSeconds += runTimes[k];
+
+        if (!run.converged || !std::isfinite(run.minimumValue))
+            continue;
+        result.convergedRuns++;
+
+        LocalMinimum *match = nullptr;
+        for (LocalMinimum &minimum : result.minima)
+        {
+            double dx = minimum.point.getX() - run.minimumPoint.getX();
+            double dy = minimum.point.getY() - run.minimumPoint.getY();
+            if (dx * dx + dy * dy <= tol2)
+            {
+                match = &minimum;
+                break;
+            }
+        }
+
+        if (!match)
+        {
+            LocalMinimum minimum;
+            minimum.point = run.minimumPoint;
+            minimum.value = run.minimumValue;
+            minimum.hits = 1;
+            minimum.bestRun = static_cast<int>(k);
+            result.minima.push_back(minimum);
+        }
+        else
+        {
+            match->hits++;
+            if (run.minimumValue < match->value)
+            {
+                match->point = run.minimumPoint;
+                match->value = run.minimumValue;
+                match->bestRun = static_cast<int>(k);
+            }
+        }
+    }
+
+    std::stable_sort(result.minima.begin(), result.minima.end(),
+                     [](const LocalMinimum &a, const LocalMinimum &b)
+                     { return a.value < b.value; });
+
+    result.wallSeconds = secondsSince(wallStart);
+    return result;
+}
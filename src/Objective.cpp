@@ -0,0 +1,38 @@
+#include "Objective.h"
+#include <vector>
+
+double Objective::valueAndGradient(const double *x, double *grad) const
+{
+    // Central differences with the step Surface uses; the copy is reused
+    // across calls on the same thread
+    const double h = 0.0001;
+    const size_t n = dimension();
+    thread_local std::vector<double> probe;
+    probe.assign(x, x + n);
+
+    for (size_t i = 0; i < n; ++i)
+    {
+        probe[i] = x[i] + h;
+        double forward = value(probe.data());
+        probe[i] = x[i] - h;
+        double backward = value(probe.data());
+        probe[i] = x[i];
+        grad[i] = (forward - backward) / (2 * h);
+    }
+    return value(x);
+}
+
+void Objective::valueBatch(const double *points, size_t count, double *values) const
+{
+    const size_t n = dimension();
+    for (size_t k = 0; k < count; ++k)
+        values[k] = value(points + k * n);
+}
+
+void Objective::valueAndGradientBatch(const double *points, size_t count,
+                                      double *values, double *grads) const
+{
+    const size_t n = dimension();
+    for (size_t k = 0; k < count; ++k)
+        values[k] = valueAndGradient(points + k * n, grads + k * n);
+}
@@ -1,9 +1,120 @@
 #include "Optimizer.h"
+#include "Instrumentation.h"
 #include <cmath>
 #include <iostream>
 
 Optimizer::Optimizer(const Surface *surf, double lr, int maxIter, double tol)
-    : surface(surf), learningRate(lr), maxIterations(maxIter), tolerance(tol) {}
+    : surface(surf), learningRate(lr), maxIterations(maxIter), tolerance(tol),
+      functionEvaluations(0), gradientEvaluations(0), hessianEvaluations(0),
+      monitor(nullptr), stopReason(StopReason::NONE), tracing(false) {}
+
+double Optimizer::evaluateSurface(double x, double y)
+{
+    functionEvaluations++;
+    return surface->evaluate(x, y);
+}
+
+Point3D Optimizer::surfaceGradient(double x, double y)
+{
+    gradientEvaluations++;
+    return surface->gradient(x, y);
+}
+
+void Optimizer::surfaceHessian(double x, double y, double &fxx, double &fxy, double &fyy)
+{
+    hessianEvaluations++;
+    surface->hessian(x, y, fxx, fxy, fyy);
+}
+
+bool Optimizer::lineSearchStep(double &x, double &y, double &z, Point3D &grad, bool &haveGradient,
+                               double dx, double dy, double &step)
+{
+    // The surface along the search line, counted like any other call
+    class SurfaceLine : public LineObjective
+    {
+    private:
+        Optimizer &optimizer;
+
+    public:
+        explicit SurfaceLine(Optimizer &optimizer) : optimizer(optimizer) {}
+
+        double value(const std::vector<double> &p) override
+        {
+            return optimizer.evaluateSurface(p[0], p[1]);
+        }
+
+        void gradient(const std::vector<double> &p, std::vector<double> &g) override
+        {
+            Point3D d = optimizer.surfaceGradient(p[0], p[1]);
+            g[0] = d.getX();
+            g[1] = d.getY();
+        }
+    };
+
+    SurfaceLine line(*this);
+    LineSearchPoint accepted;
+    accepted.g.resize(2);
+    if (!lineSearch->search(line, {x, y}, z, {grad.getX(), grad.getY()}, {dx, dy},
+                            step, accepted))
+        return false;
+
+    step = accepted.alpha;
+    x = accepted.x[0];
+    y = accepted.x[1];
+    z = accepted.f;
+    haveGradient = accepted.hasGradient;
+    if (haveGradient)
+        grad = Point3D(accepted.g[0], accepted.g[1], 0);
+    return true;
+}
+
+void Optimizer::resetCounters()
+{
+    functionEvaluations = 0;
+    gradientEvaluations = 0;
+    hessianEvaluations = 0;
+    stopReason = StopReason::NONE;
+#if SURFACE_INSTRUMENTATION
+    trace.clear();
+    runStart = std::chrono::steady_clock::now();
+#endif
+}
+
+void Optimizer::recordCounters(OptimizationResult &result)
+{
+    result.functionEvaluations = functionEvaluations;
+    result.gradientEvaluations = gradientEvaluations;
+    result.hessianEvaluations = hessianEvaluations;
+    result.stopReason = stopReason;
+
+#if SURFACE_INSTRUMENTATION
+    result.trace.swap(trace);
+    trace.clear();
+    SURFACE_COUNT(EVALUATIONS, functionEvaluations);
+    SURFACE_COUNT(GRADIENTS, gradientEvaluations);
+    SURFACE_COUNT(HESSIANS, hessianEvaluations);
+    SURFACE_COUNT(OPTIMIZER_RUNS, 1);
+    uint64_t begin = static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(runStart.time_since_epoch()).count());
+    instrumentation::addPhase(instrumentation::OPTIMIZE, begin, instrumentation::clockNanoseconds(),
+                              result.iterations, true);
+#endif
+}
+
+bool Optimizer::keepGoing(double x, double y, double z)
+{
+#if SURFACE_INSTRUMENTATION
+    if (tracing)
+    {
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - runStart).count();
+        trace.push_back({x, y, z, functionEvaluations + gradientEvaluations + hessianEvaluations, seconds});
+    }
+#endif
+    if (!monitor)
+        return true;
+    stopReason = monitor->publish(x, y, z, functionEvaluations + gradientEvaluations + hessianEvaluations);
+    return stopReason == StopReason::NONE;
+}
 
 // Gradient Descent Implementation
 GradientDescent::GradientDescent(const Surface *surf, double lr,
@@ -14,17 +125,28 @@ OptimizationResult GradientDescent::optimize(double startX, double startY)
 {
     OptimizationResult result;
     result.converged = false;
+    result.iterations = 0;
+    resetCounters();
+
+    PathRecorder recorder(pathRecording, result.path, result.compactPath, maxIterations);
 
     double x = startX, y = startY;
+    double z = evaluateSurface(x, y);
+    Point3D grad;
+    bool haveGradient = false; // A line search may already have computed it
+    double step = learningRate;
+    double previousSlope = 0;
 
     for (int iter = 0; iter < maxIterations; ++iter)
     {
         // Store current position
-        double z = surface->evaluate(x, y);
-        result.path.push_back(Point3D(x, y, z));
+        recorder.record(x, y, z);
+        if (!keepGoing(x, y, z))
+            break;
 
         // Calculate gradient: ∇f = (∂f/∂x, ∂f/∂y)
-        Point3D grad = surface->gradient(x, y);
+        if (!haveGradient)
+            grad = surfaceGradient(x, y);
 
         // Check for convergence (gradient magnitude)
         double gradMag = std::sqrt(grad.getX() * grad.getX() +
@@ -37,15 +159,35 @@ OptimizationResult GradientDescent::optimize(double startX, double startY)
             break;
         }
 
-        // Update: x_new = x_old - learning_rate * ∂f/∂x
-        x = x - learningRate * grad.getX();
-        y = y - learningRate * grad.getY();
+        if (lineSearch)
+        {
+            // Search along -∇f. The first trial is the learning rate, later
+            // ones expect the same first-order decrease as the last step
+            double slope = gradMag * gradMag;
+            if (iter > 0)
+                step *= previousSlope / slope;
+            previousSlope = slope;
+
+            if (!lineSearchStep(x, y, z, grad, haveGradient,
+                                -grad.getX(), -grad.getY(), step))
+                break;
+        }
+        else
+        {
+            // Update: x_new = x_old - learning_rate * ∂f/∂x
+            x = x - learningRate * grad.getX();
+            y = y - learningRate * grad.getY();
+            z = evaluateSurface(x, y);
+            haveGradient = false;
+        }
 
         result.iterations = iter + 1;
     }
 
-    result.minimumPoint = Point3D(x, y, surface->evaluate(x, y));
-    result.minimumValue = surface->evaluate(x, y);
+    recorder.finish();
+    result.minimumValue = z;
+    result.minimumPoint = Point3D(x, y, z);
+    recordCounters(result);
 
     return result;
 }
@@ -55,40 +197,29 @@ NewtonOptimizer::NewtonOptimizer(const Surface *surf, double lr,
                                  int maxIter, double tol)
     : Optimizer(surf, lr, maxIter, tol) {}
 
-double NewtonOptimizer::partialXX(double x, double y) const
-{
-    const double h = 0.0001;
-    return (surface->partialX(x + h, y) - surface->partialX(x - h, y)) / (2 * h);
-}
-
-double NewtonOptimizer::partialYY(double x, double y) const
-{
-    const double h = 0.0001;
-    return (surface->partialY(x, y + h) - surface->partialY(x, y - h)) / (2 * h);
-}
-
-double NewtonOptimizer::partialXY(double x, double y) const
-{
-    const double h = 0.0001;
-    return (surface->partialX(x, y + h) - surface->partialX(x, y - h)) / (2 * h);
-}
-
 OptimizationResult NewtonOptimizer::optimize(double startX, double startY)
 {
     OptimizationResult result;
     result.converged = false;
+    result.iterations = 0;
+    resetCounters();
+
+    PathRecorder recorder(pathRecording, result.path, result.compactPath, maxIterations);
 
     double x = startX, y = startY;
+    double z = evaluateSurface(x, y);
+    Point3D grad;
+    bool haveGradient = false;
 
     for (int iter = 0; iter < maxIterations; ++iter)
     {
-        double z = surface->evaluate(x, y);
-        result.path.push_back(Point3D(x, y, z));
+        recorder.record(x, y, z);
+        if (!keepGoing(x, y, z))
+            break;
 
         // Hessian matrix: H = [[fxx, fxy], [fxy, fyy]]
-        double fxx = partialXX(x, y);
-        double fyy = partialYY(x, y);
-        double fxy = partialXY(x, y);
+        double fxx, fxy, fyy;
+        surfaceHessian(x, y, fxx, fxy, fyy);
 
         // Determinant of Hessian
         double det = fxx * fyy - fxy * fxy;
@@ -105,7 +236,8 @@ OptimizationResult NewtonOptimizer::optimize(double startX, double startY)
         double invH22 = fxx / det;
 
         // Gradient
-        Point3D grad = surface->gradient(x, y);
+        if (!haveGradient)
+            grad = surfaceGradient(x, y);
         double gx = grad.getX();
         double gy = grad.getY();
 
@@ -121,14 +253,34 @@ OptimizationResult NewtonOptimizer::optimize(double startX, double startY)
         double dx = invH11 * gx + invH12 * gy;
         double dy = invH12 * gx + invH22 * gy;
 
-        x = x - learningRate * dx;
-        y = y - learningRate * dy;
+        if (lineSearch)
+        {
+            // Away from a minimum the Newton direction may point uphill;
+            // search along -∇f there instead
+            if (dx * gx + dy * gy <= 0)
+            {
+                dx = gx;
+                dy = gy;
+            }
+            double step = learningRate;
+            if (!lineSearchStep(x, y, z, grad, haveGradient, -dx, -dy, step))
+                break;
+        }
+        else
+        {
+            x = x - learningRate * dx;
+            y = y - learningRate * dy;
+            z = evaluateSurface(x, y);
+            haveGradient = false;
+        }
 
         result.iterations = iter + 1;
     }
 
-    result.minimumPoint = Point3D(x, y, surface->evaluate(x, y));
-    result.minimumValue = surface->evaluate(x, y);
+    recorder.finish();
+    result.minimumValue = z;
+    result.minimumPoint = Point3D(x, y, z);
+    recordCounters(result);
 
     return result;
 }
\ No newline at end of file
@@ -0,0 +1,291 @@
+#include "ParameterSweep.h"
+#include "ByteOrder.h"
+#include "ThreadPool.h"
+#include "PolicyOptimizer.h"
+#include "QuasiNewton.h"
+#include "TrustRegion.h"
+#include "DerivativeFree.h"
+#include "PopulationOptimizer.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <ostream>
+#include <random>
+#include <set>
+#include <stdexcept>
+
+static_assert(sizeof(SweepFileHeader) == 24, "SweepFileHeader must match the on-disk layout");
+
+static const char SWEEP_MAGIC[8] = {'S', 'O', 'S', 'W', 'E', 'E', 'P', '\0'};
+
+static uint64_t alignTo8(uint64_t offset)
+{
+    return (offset + 7) & ~uint64_t(7);
+}
+
+// Calls f(column) for every column in file order
+template <typename Results, typename F>
+static void forEachColumn(Results &results, F f)
+{
+    f(results.optimizer);
+    f(results.learningRate);
+    f(results.tolerance);
+    f(results.maxIterations);
+    f(results.startX);
+    f(results.startY);
+    f(results.converged);
+    f(results.iterations);
+    f(results.functionEvaluations);
+    f(results.gradientEvaluations);
+    f(results.hessianEvaluations);
+    f(results.finalValue);
+    f(results.wallSeconds);
+}
+
+void SweepResults::resize(size_t rows)
+{
+    forEachColumn(*this, [rows](auto &column)
+                  { column.resize(rows); });
+}
+
+void SweepResults::writeCsv(std::ostream &out) const
+{
+    out << "optimizer,learning_rate,tolerance,max_iterations,start_x,start_y,converged,iterations,"
+           "function_evaluations,gradient_evaluations,hessian_evaluations,final_value,microseconds\n";
+
+    std::ios::fmtflags flags = out.flags();
+    std::streamsize precision = out.precision();
+    out << std::defaultfloat;
+    for (size_t row = 0; row < size(); ++row)
+    {
+        out << optimizerNames[optimizer[row]] << std::setprecision(9)
+            << "," << learningRate[row] << "," << tolerance[row] << "," << maxIterations[row]
+            << "," << startX[row] << "," << startY[row] << "," << int(converged[row])
+            << "," << iterations[row] << "," << functionEvaluations[row]
+            << "," << gradientEvaluations[row] << "," << hessianEvaluations[row]
+            << "," << finalValue[row] << "," << std::setprecision(6) << 1e6 * wallSeconds[row] << "\n";
+    }
+    out.flags(flags);
+    out.precision(precision);
+}
+
+void SweepResults::writeBinary(const std::string &path) const
+{
+    std::string names;
+    for (const std::string &name : optimizerNames)
+        names += name + "\n";
+
+    SweepFileHeader header;
+    std::memcpy(header.magic, SWEEP_MAGIC, sizeof(SWEEP_MAGIC));
+    header.version = littleEndian(SWEEP_FILE_VERSION);
+    header.nameBytes = littleEndian(static_cast<uint32_t>(names.size()));
+    header.rows = littleEndian(static_cast<uint64_t>(size()));
+
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out)
+        throw std::runtime_error("Cannot write sweep results: " + path);
+
+    static const char padding[8] = {};
+    auto writePadded = [&](const void *data, size_t bytes)
+    {
+        out.write(static_cast<const char *>(data), bytes);
+        out.write(padding, alignTo8(bytes) - bytes);
+    };
+
+    out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    writePadded(names.data(), names.size());
+    forEachColumn(*this, [&](const auto &column)
+                  {
+                      if (hostIsLittleEndian())
+                      {
+                          writePadded(column.data(), column.size() * sizeof(column[0]));
+                          return;
+                      }
+                      auto swapped = column;
+                      littleEndianArray(swapped.data(), swapped.size());
+                      writePadded(swapped.data(), swapped.size() * sizeof(swapped[0]));
+                  });
+
+    if (!out)
+        throw std::runtime_error("Failed writing sweep results: " + path);
+}
+
+SweepResults SweepResults::readBinary(const std::string &path)
+{
+    std::ifstream in(path, std::ios::binary);
+    if (!in)
+        throw std::runtime_error("Cannot open sweep results: " + path);
+
+    SweepFileHeader header;
+    if (!in.read(reinterpret_cast<char *>(&header), sizeof(header)))
+        throw std::runtime_error("Sweep results too small: " + path);
+    if (std::memcmp(header.magic, SWEEP_MAGIC, sizeof(SWEEP_MAGIC)) != 0)
+        throw std::runtime_error("Not a sweep results file: " + path);
+    header.version = littleEndian(header.version);
+    header.nameBytes = littleEndian(header.nameBytes);
+    header.rows = littleEndian(header.rows);
+    if (header.version != SWEEP_FILE_VERSION)
+        throw std::runtime_error("Unsupported sweep results version: " + path);
+
+    auto readPadded = [&](void *data, size_t bytes)
+    {
+        char padding[8];
+        if (!in.read(static_cast<char *>(data), bytes) ||
+            !in.read(padding, alignTo8(bytes) - bytes))
+            throw std::runtime_error("Sweep results truncated: " + path);
+    };
+
+    SweepResults results;
+    std::string names(header.nameBytes, '\0');
+    readPadded(&names[0], names.size());
+    size_t begin = 0;
+    for (size_t end; (end = names.find('\n', begin)) != std::string::npos; begin = end + 1)
+        results.optimizerNames.push_back(names.substr(begin, end - begin));
+
+    results.resize(header.rows);
+    forEachColumn(results, [&](auto &column)
+                  {
+                      readPadded(column.data(), column.size() * sizeof(column[0]));
+                      littleEndianArray(column.data(), column.size());
+                  });
+
+    for (uint8_t index : results.optimizer)
+        if (index >= results.optimizerNames.size())
+            throw std::runtime_error("Malformed sweep results: " + path);
+    return results;
+}
+
+ParameterSweep::ParameterSweep(const Surface *surf, const SweepSpace &space, const SweepOptions &options)
+    : surface(surf), space(space), options(options)
+{
+    if (space.optimizers.empty() || space.learningRates.empty() || space.tolerances.empty() ||
+        space.maxIterations.empty() || space.starts.empty())
+        throw std::runtime_error("Every sweep axis needs at least one value");
+    if (space.optimizers.size() > 256)
+        throw std::runtime_error("A sweep can compare at most 256 optimizers");
+
+    // Fail before any run starts
+    for (const std::string &name : space.optimizers)
+        createOptimizer(name, surf, space.learningRates[0], space.maxIterations[0], space.tolerances[0]);
+}
+
+size_t ParameterSweep::combinations() const
+{
+    return space.optimizers.size() * space.learningRates.size() * space.tolerances.size() *
+           space.maxIterations.size() * space.starts.size();
+}
+
+SweepResults ParameterSweep::run() const
+{
+    // Combination indices to run, in increasing order
+    size_t total = combinations();
+    std::vector<size_t> chosen;
+    if (options.samples == 0 || options.samples >= total)
+    {
+        chosen.resize(total);
+        for (size_t k = 0; k < total; ++k)
+            chosen[k] = k;
+    }
+    else
+    {
+        // Floyd's algorithm: a uniform subset without materializing the grid
+        std::mt19937_64 generator(options.seed);
+        std::set<size_t> subset;
+        for (size_t k = total - options.samples; k < total; ++k)
+        {
+            size_t pick = std::uniform_int_distribution<size_t>(0, k)(generator);
+            if (!subset.insert(pick).second)
+                subset.insert(k);
+        }
+        chosen.assign(subset.begin(), subset.end());
+    }
+
+    SweepResults results;
+    results.optimizerNames = space.optimizers;
+    results.resize(chosen.size());
+
+    ThreadPool &pool = options.pool ? *options.pool : ThreadPool::shared();
+    pool.parallelFor(0, chosen.size(), 1, [&](size_t begin, size_t end)
+                     {
+        for (size_t row = begin; row < end; ++row)
+        {
+            // Mixed-radix decode, starts varying fastest
+            size_t index = chosen[row];
+            size_t start = index % space.starts.size();
+            index /= space.starts.size();
+            size_t iterationLimit = index % space.maxIterations.size();
+            index /= space.maxIterations.size();
+            size_t tolerance = index % space.tolerances.size();
+            index /= space.tolerances.size();
+            size_t rate = index % space.learningRates.size();
+            size_t optimizer = index / space.learningRates.size();
+
+            auto runStart = std::chrono::steady_clock::now();
+            std::unique_ptr<Optimizer> instance = createOptimizer(
+                space.optimizers[optimizer], surface, space.learningRates[rate],
+                space.maxIterations[iterationLimit], space.tolerances[tolerance]);
+            instance->setPathRecording(PathRecording::none());
+            OptimizationResult result = instance->optimize(space.starts[start].getX(), space.starts[start].getY());
+
+            results.optimizer[row] = static_cast<uint8_t>(optimizer);
+            results.learningRate[row] = space.learningRates[rate];
+            results.tolerance[row] = space.tolerances[tolerance];
+            results.maxIterations[row] = space.maxIterations[iterationLimit];
+            results.startX[row] = space.starts[start].getX();
+            results.startY[row] = space.starts[start].getY();
+            results.converged[row] = result.converged ? 1 : 0;
+            results.iterations[row] = result.iterations;
+            results.functionEvaluations[row] = result.functionEvaluations;
+            results.gradientEvaluations[row] = result.gradientEvaluations;
+            results.hessianEvaluations[row] = result.hessianEvaluations;
+            results.finalValue[row] = result.minimumValue;
+            results.wallSeconds[row] = std::chrono::duration<double>(std::chrono::steady_clock::now() - runStart).count();
+        } });
+
+    return results;
+}
+
+const std::vector<std::string> &ParameterSweep::optimizerNames()
+{
+    static const std::vector<std::string> names = {
+        "gradient-descent", "momentum", "nesterov", "rmsprop", "adam", "newton", "trust-region",
+        "lbfgs", "nelder-mead", "pattern-search", "particle-swarm", "diff-evolution", "cma-es"};
+    return names;
+}
+
+std::unique_ptr<Optimizer> ParameterSweep::createOptimizer(const std::string &name, const Surface *surf,
+                                                           double lr, int maxIter, double tol)
+{
+    Optimizer *optimizer = nullptr;
+    if (name == "gradient-descent")
+        optimizer = new GradientDescent(surf, lr, maxIter, tol);
+    else if (name == "momentum")
+        optimizer = new MomentumOptimizer(surf, lr, maxIter, tol);
+    else if (name == "nesterov")
+        optimizer = new NesterovOptimizer(surf, lr, maxIter, tol);
+    else if (name == "rmsprop")
+        optimizer = new RMSPropOptimizer(surf, lr, maxIter, tol);
+    else if (name == "adam")
+        optimizer = new AdamOptimizer(surf, lr, maxIter, tol);
+    else if (name == "newton")
+        optimizer = new NewtonOptimizer(surf, lr, maxIter, tol);
+    else if (name == "trust-region")
+        optimizer = new TrustRegionNewton(surf, lr, maxIter, tol);
+    else if (name == "lbfgs")
+        optimizer = new LBFGSOptimizer(surf, 8, lr, maxIter, tol);
+    else if (name == "nelder-mead")
+        optimizer = new NelderMead(surf, lr, maxIter, tol);
+    else if (name == "pattern-search")
+        optimizer = new PatternSearch(surf, lr, maxIter, tol);
+    else if (name == "particle-swarm")
+        optimizer = new ParticleSwarm(surf, lr, maxIter, tol);
+    else if (name == "diff-evolution")
+        optimizer = new DifferentialEvolution(surf, lr, maxIter, tol);
+    else if (name == "cma-es")
+        optimizer = new CMAES(surf, lr, maxIter, tol);
+    else
+        throw std::runtime_error("Unknown optimizer: " + name);
+    return std::unique_ptr<Optimizer>(optimizer);
+}
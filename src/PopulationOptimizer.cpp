@@ -0,0 +1,406 @@
+#include "PopulationOptimizer.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+
+static const double PI = 3.14159265358979323846;
+
+double RandomStream::normal()
+{
+    // 1 - uniform() lies in (0, 1], so the log is finite
+    double u1 = 1.0 - uniform();
+    double u2 = uniform();
+    return std::sqrt(-2.0 * std::log(u1)) * std::cos(2.0 * PI * u2);
+}
+
+// Population base
+PopulationOptimizer::PopulationOptimizer(const Surface *surf, double lr, int maxIter, double tol,
+                                         int populationSize, unsigned seed)
+    : Optimizer(surf, lr, maxIter, tol), populationSize(populationSize), seed(seed), pool(nullptr),
+      originX(0), originY(0), generation(0), bestX(0), bestY(0), bestZ(0) {}
+
+void PopulationOptimizer::beginRun(double startX, double startY)
+{
+    resetCounters();
+
+    size_t n = static_cast<size_t>(populationSize);
+    streams.clear();
+    for (size_t k = 0; k < n; ++k)
+        streams.push_back(RandomStream::forSlot(seed, k));
+    candidateX.assign(n, 0.0);
+    candidateY.assign(n, 0.0);
+    candidateZ.assign(n, 0.0);
+
+    originX = startX;
+    originY = startY;
+    generation = 0;
+    bestX = startX;
+    bestY = startY;
+    bestZ = std::numeric_limits<double>::infinity();
+}
+
+void PopulationOptimizer::evaluateGeneration()
+{
+    size_t n = static_cast<size_t>(populationSize);
+    ThreadPool &threads = pool ? *pool : ThreadPool::shared();
+    threads.parallelFor(0, n, 16, [&](size_t begin, size_t end)
+                        {
+        for (size_t k = begin; k < end; ++k)
+            propose(k);
+        surface->evaluateBatch(candidateX.data() + begin, candidateY.data() + begin,
+                               candidateZ.data() + begin, end - begin); });
+    functionEvaluations += populationSize;
+
+    // In slot order, so ties resolve the same way every run
+    for (size_t k = 0; k < n; ++k)
+    {
+        if (candidateZ[k] < bestZ)
+        {
+            bestX = candidateX[k];
+            bestY = candidateY[k];
+            bestZ = candidateZ[k];
+        }
+    }
+    generation++;
+}
+
+bool PopulationOptimizer::diverged() const
+{
+    return std::isinf(bestZ) && bestZ < 0;
+}
+
+void PopulationOptimizer::finishRun(OptimizationResult &result, PathRecorder &recorder)
+{
+    recorder.finish();
+    result.minimumValue = bestZ;
+    result.minimumPoint = Point3D(bestX, bestY, bestZ);
+    recordCounters(result);
+}
+
+// Particle Swarm Implementation
+ParticleSwarm::ParticleSwarm(const Surface *surf, double lr, int maxIter, double tol,
+                             int populationSize, unsigned seed)
+    : PopulationOptimizer(surf, lr, maxIter, tol, std::max(2, populationSize), seed) {}
+
+void ParticleSwarm::propose(size_t k)
+{
+    // Constriction coefficients of Clerc and Kennedy
+    const double inertia = 0.7298, cognitive = 1.49618, social = 1.49618;
+    RandomStream &random = streams[k];
+
+    if (generation == 0)
+    {
+        px[k] = originX + learningRate * (2 * random.uniform() - 1);
+        py[k] = originY + learningRate * (2 * random.uniform() - 1);
+        vx[k] = 0.5 * learningRate * (2 * random.uniform() - 1);
+        vy[k] = 0.5 * learningRate * (2 * random.uniform() - 1);
+    }
+    else
+    {
+        double r1 = random.uniform(), r2 = random.uniform();
+        double r3 = random.uniform(), r4 = random.uniform();
+        vx[k] = inertia * vx[k] + cognitive * r1 * (bestPx[k] - px[k]) + social * r2 * (bestX - px[k]);
+        vy[k] = inertia * vy[k] + cognitive * r3 * (bestPy[k] - py[k]) + social * r4 * (bestY - py[k]);
+        px[k] += vx[k];
+        py[k] += vy[k];
+    }
+
+    candidateX[k] = px[k];
+    candidateY[k] = py[k];
+}
+
+OptimizationResult ParticleSwarm::optimize(double startX, double startY)
+{
+    OptimizationResult result;
+    result.converged = false;
+    result.iterations = 0;
+    beginRun(startX, startY);
+
+    PathRecorder recorder(pathRecording, result.path, result.compactPath, maxIterations);
+
+    size_t n = static_cast<size_t>(populationSize);
+    px.assign(n, 0.0);
+    py.assign(n, 0.0);
+    vx.assign(n, 0.0);
+    vy.assign(n, 0.0);
+    bestPx.assign(n, 0.0);
+    bestPy.assign(n, 0.0);
+    bestPz.assign(n, std::numeric_limits<double>::infinity());
+
+    for (int iter = 0; iter < maxIterations; ++iter)
+    {
+        evaluateGeneration();
+        recorder.record(bestX, bestY, bestZ);
+        result.iterations = iter + 1;
+        if (diverged() || !keepGoing(bestX, bestY, bestZ))
+            break;
+
+        double spread = 0;
+        for (size_t k = 0; k < n; ++k)
+        {
+            if (candidateZ[k] < bestPz[k])
+            {
+                bestPx[k] = px[k];
+                bestPy[k] = py[k];
+                bestPz[k] = candidateZ[k];
+            }
+            spread = std::max(spread, std::max(std::abs(bestPx[k] - bestX), std::abs(bestPy[k] - bestY)));
+        }
+
+        if (spread < tolerance)
+        {
+            result.converged = true;
+            break;
+        }
+    }
+
+    finishRun(result, recorder);
+    return result;
+}
+
+// Differential Evolution Implementation
+DifferentialEvolution::DifferentialEvolution(const Surface *surf, double lr, int maxIter, double tol,
+                                             int populationSize, unsigned seed)
+    : PopulationOptimizer(surf, lr, maxIter, tol, std::max(4, populationSize), seed),
+      weight(0.8), crossover(0.9) {}
+
+void DifferentialEvolution::propose(size_t k)
+{
+    RandomStream &random = streams[k];
+
+    if (generation == 0)
+    {
+        candidateX[k] = originX + learningRate * (2 * random.uniform() - 1);
+        candidateY[k] = originY + learningRate * (2 * random.uniform() - 1);
+        return;
+    }
+
+    // Three distinct members other than k
+    size_t n = px.size();
+    size_t r[3];
+    for (int i = 0; i < 3; ++i)
+    {
+        bool distinct;
+        do
+        {
+            r[i] = static_cast<size_t>(random.next() % n);
+            distinct = r[i] != k;
+            for (int j = 0; j < i; ++j)
+                distinct = distinct && r[i] != r[j];
+        } while (!distinct);
+    }
+
+    double mutantX = px[r[0]] + weight * (px[r[1]] - px[r[2]]);
+    double mutantY = py[r[0]] + weight * (py[r[1]] - py[r[2]]);
+
+    // Binomial crossover; one coordinate always comes from the mutant
+    int forced = static_cast<int>(random.next() & 1);
+    bool takeX = forced == 0 || random.uniform() < crossover;
+    bool takeY = forced == 1 || random.uniform() < crossover;
+    candidateX[k] = takeX ? mutantX : px[k];
+    candidateY[k] = takeY ? mutantY : py[k];
+}
+
+OptimizationResult DifferentialEvolution::optimize(double startX, double startY)
+{
+    OptimizationResult result;
+    result.converged = false;
+    result.iterations = 0;
+    beginRun(startX, startY);
+
+    PathRecorder recorder(pathRecording, result.path, result.compactPath, maxIterations);
+
+    size_t n = static_cast<size_t>(populationSize);
+    px.assign(n, 0.0);
+    py.assign(n, 0.0);
+    pz.assign(n, std::numeric_limits<double>::infinity());
+
+    for (int iter = 0; iter < maxIterations; ++iter)
+    {
+        evaluateGeneration();
+        recorder.record(bestX, bestY, bestZ);
+        result.iterations = iter + 1;
+        if (diverged() || !keepGoing(bestX, bestY, bestZ))
+            break;
+
+        // Greedy selection: a trial replaces its parent unless it is worse
+        for (size_t k = 0; k < n; ++k)
+        {
+            if (candidateZ[k] <= pz[k] || iter == 0)
+            {
+                px[k] = candidateX[k];
+                py[k] = candidateY[k];
+                pz[k] = candidateZ[k];
+            }
+        }
+
+        double spread = 0;
+        for (size_t k = 0; k < n; ++k)
+            spread = std::max(spread, std::max(std::abs(px[k] - bestX), std::abs(py[k] - bestY)));
+        if (spread < tolerance)
+        {
+            result.converged = true;
+            break;
+        }
+    }
+
+    finishRun(result, recorder);
+    return result;
+}
+
+// CMA-ES Implementation
+CMAES::CMAES(const Surface *surf, double lr, int maxIter, double tol,
+             int populationSize, unsigned seed)
+    : PopulationOptimizer(surf, lr, maxIter, tol, populationSize > 0 ? std::max(4, populationSize) : 6, seed),
+      meanX(0), meanY(0), sigma(lr), c11(1), c12(0), c22(1),
+      b11(1), b12(0), b21(0), b22(1), d1(1), d2(1) {}
+
+void CMAES::propose(size_t k)
+{
+    RandomStream &random = streams[k];
+    zx[k] = random.normal();
+    zy[k] = random.normal();
+
+    // x = m + sigma B D z
+    candidateX[k] = meanX + sigma * (b11 * d1 * zx[k] + b12 * d2 * zy[k]);
+    candidateY[k] = meanY + sigma * (b21 * d1 * zx[k] + b22 * d2 * zy[k]);
+}
+
+OptimizationResult CMAES::optimize(double startX, double startY)
+{
+    OptimizationResult result;
+    result.converged = false;
+    result.iterations = 0;
+    beginRun(startX, startY);
+
+    PathRecorder recorder(pathRecording, result.path, result.compactPath, maxIterations);
+
+    const int n = 2;
+    const int lambda = populationSize;
+    const int mu = lambda / 2;
+
+    // Recombination weights and the strategy constants
+    std::vector<double> weights(mu);
+    for (int i = 0; i < mu; ++i)
+        weights[i] = std::log(mu + 0.5) - std::log(i + 1.0);
+    double weightSum = std::accumulate(weights.begin(), weights.end(), 0.0);
+    double weightSquares = 0;
+    for (double &w : weights)
+    {
+        w /= weightSum;
+        weightSquares += w * w;
+    }
+    const double muEff = 1.0 / weightSquares;
+
+    const double cSigma = (muEff + 2) / (n + muEff + 5);
+    const double dSigma = 1 + 2 * std::max(0.0, std::sqrt((muEff - 1) / (n + 1)) - 1) + cSigma;
+    const double cc = (4 + muEff / n) / (n + 4 + 2 * muEff / n);
+    const double c1 = 2 / ((n + 1.3) * (n + 1.3) + muEff);
+    const double cMu = std::min(1 - c1, 2 * (muEff - 2 + 1 / muEff) / ((n + 2) * (n + 2) + muEff));
+    const double chiN = std::sqrt(double(n)) * (1 - 1.0 / (4 * n) + 1.0 / (21 * n * n));
+
+    meanX = startX;
+    meanY = startY;
+    sigma = learningRate;
+    c11 = c22 = 1;
+    c12 = 0;
+    b11 = b22 = 1;
+    b12 = b21 = 0;
+    d1 = d2 = 1;
+    double pSigmaX = 0, pSigmaY = 0, pcX = 0, pcY = 0;
+    zx.assign(lambda, 0.0);
+    zy.assign(lambda, 0.0);
+    std::vector<int> order(lambda);
+
+    for (int iter = 0; iter < maxIterations; ++iter)
+    {
+        evaluateGeneration();
+        recorder.record(bestX, bestY, bestZ);
+        result.iterations = iter + 1;
+        if (diverged() || !keepGoing(bestX, bestY, bestZ))
+            break;
+
+        std::iota(order.begin(), order.end(), 0);
+        std::stable_sort(order.begin(), order.end(), [&](int a, int b)
+                         { return candidateZ[a] < candidateZ[b]; });
+
+        // Weighted means of the best mu steps, in y = B D z and in z
+        double ywX = 0, ywY = 0, zwX = 0, zwY = 0;
+        for (int i = 0; i < mu; ++i)
+        {
+            int k = order[i];
+            ywX += weights[i] * (candidateX[k] - meanX) / sigma;
+            ywY += weights[i] * (candidateY[k] - meanY) / sigma;
+            zwX += weights[i] * zx[k];
+            zwY += weights[i] * zy[k];
+        }
+        meanX += sigma * ywX;
+        meanY += sigma * ywY;
+
+        // Step-size path: C^(-1/2) yw = B zw
+        double sigmaScale = std::sqrt(cSigma * (2 - cSigma) * muEff);
+        pSigmaX = (1 - cSigma) * pSigmaX + sigmaScale * (b11 * zwX + b12 * zwY);
+        pSigmaY = (1 - cSigma) * pSigmaY + sigmaScale * (b21 * zwX + b22 * zwY);
+        double pSigmaNorm = std::hypot(pSigmaX, pSigmaY);
+
+        // Stall the covariance path while sigma is growing fast
+        double correction = std::sqrt(1 - std::pow(1 - cSigma, 2.0 * (iter + 1)));
+        double hSigma = pSigmaNorm / correction < (1.4 + 2.0 / (n + 1)) * chiN ? 1.0 : 0.0;
+        double cScale = std::sqrt(cc * (2 - cc) * muEff);
+        pcX = (1 - cc) * pcX + hSigma * cScale * ywX;
+        pcY = (1 - cc) * pcY + hSigma * cScale * ywY;
+
+        // Rank-one and rank-mu covariance update
+        double keep = 1 - c1 - cMu + (1 - hSigma) * c1 * cc * (2 - cc);
+        double r11 = 0, r12 = 0, r22 = 0;
+        for (int i = 0; i < mu; ++i)
+        {
+            int k = order[i];
+            double yx = (candidateX[k] - (meanX - sigma * ywX)) / sigma;
+            double yy = (candidateY[k] - (meanY - sigma * ywY)) / sigma;
+            r11 += weights[i] * yx * yx;
+            r12 += weights[i] * yx * yy;
+            r22 += weights[i] * yy * yy;
+        }
+        c11 = keep * c11 + c1 * pcX * pcX + cMu * r11;
+        c12 = keep * c12 + c1 * pcX * pcY + cMu * r12;
+        c22 = keep * c22 + c1 * pcY * pcY + cMu * r22;
+
+        sigma *= std::exp((cSigma / dSigma) * (pSigmaNorm / chiN - 1));
+
+        // C = B diag(d1^2, d2^2) B^T
+        double mid = 0.5 * (c11 + c22);
+        double radius = std::hypot(0.5 * (c11 - c22), c12);
+        double e1 = std::max(mid - radius, 1e-300);
+        double e2 = std::max(mid + radius, 1e-300);
+        if (radius > 0)
+        {
+            // Eigenvector of e2, written so that it is stable for either sign of c11 - c22
+            double ux = c11 - c22 >= 0 ? mid + radius - c22 : c12;
+            double uy = c11 - c22 >= 0 ? c12 : mid + radius - c11;
+            double length = std::hypot(ux, uy);
+            b12 = ux / length;
+            b22 = uy / length;
+            b11 = b22;
+            b21 = -b12;
+        }
+        else
+        {
+            b11 = b22 = 1;
+            b12 = b21 = 0;
+        }
+        d1 = std::sqrt(e1);
+        d2 = std::sqrt(e2);
+
+        if (sigma * d2 < tolerance)
+        {
+            result.converged = true;
+            break;
+        }
+    }
+
+    finishRun(result, recorder);
+    return result;
+}
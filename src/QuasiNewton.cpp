@@ -0,0 +1,279 @@
+#include "QuasiNewton.h"
+#include <cmath>
+#include <algorithm>
+
+namespace
+{
+    double dot(const double *a, const double *b, size_t n)
+    {
+        double sum = 0.0;
+        for (size_t i = 0; i < n; ++i)
+            sum += a[i] * b[i];
+        return sum;
+    }
+
+    double dot(const std::vector<double> &a, const std::vector<double> &b)
+    {
+        return dot(a.data(), b.data(), a.size());
+    }
+
+    double norm(const std::vector<double> &a)
+    {
+        return std::sqrt(dot(a, a));
+    }
+}
+
+QuasiNewton::QuasiNewton(ObjectiveFunction objective, const QuasiNewtonOptions &options)
+    : objective(objective), options(options) {}
+
+QuasiNewtonResult QuasiNewton::minimize(const std::vector<double> &start) const
+{
+    const size_t n = start.size();
+
+    QuasiNewtonResult result;
+    result.x = start;
+    result.gradient.assign(n, 0.0);
+    result.iterations = 0;
+    result.converged = false;
+    result.value = objective(result.x, result.gradient);
+
+    // Objective calls made by the line search are counted here
+    CombinedLineObjective line(objective);
+    std::shared_ptr<const LineSearch> lineSearch = options.lineSearch;
+    if (!lineSearch)
+        lineSearch = std::make_shared<StrongWolfe>();
+
+    std::vector<double> &x = result.x;
+    std::vector<double> &g = result.gradient;
+    std::vector<double> direction(n), s(n), y(n);
+    LineSearchPoint accepted;
+
+    // L-BFGS correction pairs in a ring of flat arrays, so iterations do not
+    // allocate; pair k (0 = oldest) lives in slot (oldest + k) % memory
+    const size_t memory = options.memory > 0 ? options.memory : 0;
+    std::vector<double> sHistory(memory * n), yHistory(memory * n), rhoHistory(memory), alphas(memory);
+    size_t oldest = 0, pairs = 0;
+    auto slot = [&](size_t k)
+    { return (oldest + k) % memory; };
+
+    // Dense inverse Hessian approximation for memory = 0
+    const bool dense = memory == 0;
+    std::vector<double> H, Hy;
+    if (dense)
+        Hy.resize(n);
+    bool identity = true;
+    auto resetHessian = [&]()
+    {
+        oldest = 0;
+        pairs = 0;
+        if (dense)
+        {
+            H.assign(n * n, 0.0);
+            for (size_t i = 0; i < n; ++i)
+                H[i * n + i] = 1.0;
+        }
+        identity = true;
+    };
+    resetHessian();
+
+    for (int iter = 0; iter < options.maxIterations; ++iter)
+    {
+        if (options.recordPath)
+        {
+            result.path.push_back(x);
+            result.pathValues.push_back(result.value);
+        }
+
+        if (options.onIterate && !options.onIterate(x, result.value))
+            break;
+
+        double gradNorm = norm(g);
+        if (gradNorm < options.tolerance)
+        {
+            result.converged = true;
+            break;
+        }
+
+        // direction = -H g
+        if (dense)
+        {
+            for (size_t i = 0; i < n; ++i)
+            {
+                double sum = 0.0;
+                for (size_t j = 0; j < n; ++j)
+                    sum += H[i * n + j] * g[j];
+                direction[i] = -sum;
+            }
+        }
+        else
+        {
+            // Two-loop recursion, run in place on q = -direction
+            std::vector<double> &q = direction;
+            q = g;
+            for (size_t k = pairs; k-- > 0;)
+            {
+                const double *sk = &sHistory[slot(k) * n], *yk = &yHistory[slot(k) * n];
+                alphas[k] = rhoHistory[slot(k)] * dot(sk, q.data(), n);
+                for (size_t i = 0; i < n; ++i)
+                    q[i] -= alphas[k] * yk[i];
+            }
+
+            double gamma = 1.0;
+            if (pairs > 0)
+            {
+                const double *sk = &sHistory[slot(pairs - 1) * n], *yk = &yHistory[slot(pairs - 1) * n];
+                gamma = dot(sk, yk, n) / dot(yk, yk, n);
+            }
+            for (size_t i = 0; i < n; ++i)
+                q[i] *= gamma;
+
+            for (size_t k = 0; k < pairs; ++k)
+            {
+                const double *sk = &sHistory[slot(k) * n], *yk = &yHistory[slot(k) * n];
+                double beta = rhoHistory[slot(k)] * dot(yk, q.data(), n);
+                for (size_t i = 0; i < n; ++i)
+                    q[i] += sk[i] * (alphas[k] - beta);
+            }
+
+            for (size_t i = 0; i < n; ++i)
+                direction[i] = -q[i];
+        }
+
+        // Not a descent direction: restart from steepest descent
+        if (dot(direction, g) >= 0)
+        {
+            resetHessian();
+            for (size_t i = 0; i < n; ++i)
+                direction[i] = -g[i];
+        }
+
+        // Without curvature information, scale the first step by 1/|g|
+        double alpha = identity ? options.initialStep * std::min(1.0, 1.0 / gradNorm) : 1.0;
+
+        if (!lineSearch->search(line, x, result.value, g, direction, alpha, accepted))
+        {
+            if (identity)
+                break; // Even steepest descent makes no progress
+            resetHessian();
+            continue;
+        }
+
+        // Searches that test only sufficient decrease leave the gradient to us;
+        // the objective still holds it from the accepted trial
+        if (!accepted.hasGradient)
+        {
+            accepted.g.resize(n);
+            line.gradient(accepted.x, accepted.g);
+        }
+
+        // Curvature pair
+        for (size_t i = 0; i < n; ++i)
+        {
+            s[i] = accepted.x[i] - x[i];
+            y[i] = accepted.g[i] - g[i];
+        }
+        double sy = dot(s, y);
+
+        x = accepted.x;
+        g = accepted.g;
+        result.value = accepted.f;
+        result.iterations = iter + 1;
+
+        // Skip updates that would lose positive definiteness
+        if (!(sy > 1e-10 * norm(s) * norm(y)))
+            continue;
+
+        double rho = 1.0 / sy;
+        if (dense)
+        {
+            if (identity)
+            {
+                // Scale the initial matrix to the observed curvature
+                double gamma = sy / dot(y, y);
+                for (size_t i = 0; i < n; ++i)
+                    H[i * n + i] = gamma;
+            }
+
+            // H = (I - rho s y^T) H (I - rho y s^T) + rho s s^T
+            for (size_t i = 0; i < n; ++i)
+            {
+                double sum = 0.0;
+                for (size_t j = 0; j < n; ++j)
+                    sum += H[i * n + j] * y[j];
+                Hy[i] = sum;
+            }
+            double yHy = dot(y, Hy);
+            for (size_t i = 0; i < n; ++i)
+                for (size_t j = 0; j < n; ++j)
+                    H[i * n + j] += rho * ((1.0 + rho * yHy) * s[i] * s[j] - Hy[i] * s[j] - s[i] * Hy[j]);
+        }
+        else
+        {
+            // Overwrite the oldest pair once the ring is full
+            size_t target;
+            if (pairs == memory)
+            {
+                target = oldest;
+                oldest = (oldest + 1) % memory;
+            }
+            else
+            {
+                target = slot(pairs++);
+            }
+            std::copy(s.begin(), s.end(), sHistory.begin() + target * n);
+            std::copy(y.begin(), y.end(), yHistory.begin() + target * n);
+            rhoHistory[target] = rho;
+        }
+        identity = false;
+    }
+
+    result.evaluations = 1 + line.getCalls();
+    return result;
+}
+
+// Surface adapter
+LBFGSOptimizer::LBFGSOptimizer(const Surface *surf, int memory, double lr,
+                               int maxIter, double tol)
+    : Optimizer(surf, lr, maxIter, tol), memory(memory) {}
+
+OptimizationResult LBFGSOptimizer::optimize(double startX, double startY)
+{
+    resetCounters();
+
+    QuasiNewtonOptions options;
+    options.memory = memory;
+    options.maxIterations = maxIterations;
+    options.tolerance = tolerance;
+    options.initialStep = learningRate;
+    options.lineSearch = lineSearch;
+    options.recordPath = false;
+
+    // Iterates go straight into the recorder, so RING and EVERY_K stay bounded
+    OptimizationResult result;
+    PathRecorder recorder(pathRecording, result.path, result.compactPath, maxIterations);
+    options.onIterate = [this, &recorder](const std::vector<double> &x, double value)
+    {
+        recorder.record(x[0], x[1], value);
+        return keepGoing(x[0], x[1], value);
+    };
+
+    QuasiNewton solver([this](const std::vector<double> &p, std::vector<double> &grad)
+                       {
+        Point3D g = surfaceGradient(p[0], p[1]);
+        grad[0] = g.getX();
+        grad[1] = g.getY();
+        return evaluateSurface(p[0], p[1]); },
+                       options);
+
+    QuasiNewtonResult qn = solver.minimize({startX, startY});
+
+    result.converged = qn.converged;
+    result.iterations = qn.iterations;
+    result.minimumValue = qn.value;
+    result.minimumPoint = Point3D(qn.x[0], qn.x[1], qn.value);
+
+    recorder.finish();
+    recordCounters(result);
+
+    return result;
+}
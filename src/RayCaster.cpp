@@ -0,0 +1,555 @@
+#include "RayCaster.h"
+#include "Instrumentation.h"
+#include "Surface.h"
+#include "ThreadPool.h"
+#include "Trace.h"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+// Overlay bin entries: a segment index, or DISC and a disc index
+static const uint32_t DISC = 0x80000000u;
+static const uint32_t INDEX_MASK = 0x7FFFFFFFu;
+
+// Relative boost to 1 / depth of the overlay, as in SoftwareRenderer
+static const float OVERLAY_DEPTH_BIAS = 0.002f;
+
+// Slack on the barycentric tests so rays through a shared edge hit one of
+// its two triangles despite rounding
+static const float EDGE_EPSILON = 1e-5f;
+
+namespace
+{
+    const int LANES = RayCaster::PACKET_SIZE;
+
+    // Camera and field in the field's frame: x and y relative to its
+    // (xMin, yMin) corner, which keeps float coordinates precise on
+    // large domains
+    struct Scene
+    {
+        const HeightPyramid *pyramid;
+        float origin[3];
+        float xStep, yStep;
+        float nearPlane;
+    };
+
+    // Rays of a 4x2 pixel block and the closest hit of each
+    struct Packet
+    {
+        float dx[LANES], dy[LANES], dz[LANES];
+        float invX[LANES], invY[LANES], invZ[LANES];
+        float t[LANES]; // Starts at the far plane
+        int cellI[LANES], cellJ[LANES];
+        int triangle[LANES]; // -1 until a hit
+        float u[LANES], v[LANES];
+    };
+
+    // Whether any ray of the packet enters the box before its closest hit
+    bool packetHitsBox(const Scene &scene, const Packet &packet, const float *boxMin, const float *boxMax)
+    {
+        float lowX = boxMin[0] - scene.origin[0], highX = boxMax[0] - scene.origin[0];
+        float lowY = boxMin[1] - scene.origin[1], highY = boxMax[1] - scene.origin[1];
+        float lowZ = boxMin[2] - scene.origin[2], highZ = boxMax[2] - scene.origin[2];
+
+        int any = 0;
+        for (int k = 0; k < LANES; ++k)
+        {
+            float x1 = lowX * packet.invX[k], x2 = highX * packet.invX[k];
+            float y1 = lowY * packet.invY[k], y2 = highY * packet.invY[k];
+            float z1 = lowZ * packet.invZ[k], z2 = highZ * packet.invZ[k];
+            float tNear = std::max(std::max(scene.nearPlane, std::min(x1, x2)),
+                                   std::max(std::min(y1, y2), std::min(z1, z2)));
+            float tFar = std::min(std::min(packet.t[k], std::max(x1, x2)),
+                                  std::min(std::max(y1, y2), std::max(z1, z2)));
+            any |= tNear <= tFar;
+        }
+        return any != 0;
+    }
+
+    // Moller-Trumbore against one triangle for the whole packet. The rays
+    // share their origin, so only the terms with the direction vary by lane.
+    void intersectTriangle(const Scene &scene, Packet &packet, const float *a, const float *b, const float *c,
+                           int i, int j, int triangle)
+    {
+        float e1[3] = {b[0] - a[0], b[1] - a[1], b[2] - a[2]};
+        float e2[3] = {c[0] - a[0], c[1] - a[1], c[2] - a[2]};
+        float s[3] = {scene.origin[0] - a[0], scene.origin[1] - a[1], scene.origin[2] - a[2]};
+        float q[3] = {s[1] * e1[2] - s[2] * e1[1],
+                      s[2] * e1[0] - s[0] * e1[2],
+                      s[0] * e1[1] - s[1] * e1[0]};
+        float tNumerator = e2[0] * q[0] + e2[1] * q[1] + e2[2] * q[2];
+
+        float hitT[LANES], hitU[LANES], hitV[LANES];
+        int hit[LANES];
+        int any = 0;
+        for (int k = 0; k < LANES; ++k)
+        {
+            float px = packet.dy[k] * e2[2] - packet.dz[k] * e2[1];
+            float py = packet.dz[k] * e2[0] - packet.dx[k] * e2[2];
+            float pz = packet.dx[k] * e2[1] - packet.dy[k] * e2[0];
+            float det = e1[0] * px + e1[1] * py + e1[2] * pz;
+            float invDet = 1.0f / det;
+            hitU[k] = (s[0] * px + s[1] * py + s[2] * pz) * invDet;
+            hitV[k] = (packet.dx[k] * q[0] + packet.dy[k] * q[1] + packet.dz[k] * q[2]) * invDet;
+            hitT[k] = tNumerator * invDet;
+            hit[k] = (det != 0.0f) & (hitU[k] >= -EDGE_EPSILON) & (hitV[k] >= -EDGE_EPSILON) &
+                     (hitU[k] + hitV[k] <= 1.0f + EDGE_EPSILON) & (hitT[k] >= scene.nearPlane) &
+                     (hitT[k] < packet.t[k]);
+            any |= hit[k];
+        }
+        if (!any)
+            return;
+
+        for (int k = 0; k < LANES; ++k)
+        {
+            if (!hit[k])
+                continue;
+            packet.t[k] = hitT[k];
+            packet.u[k] = hitU[k];
+            packet.v[k] = hitV[k];
+            packet.cellI[k] = i;
+            packet.cellJ[k] = j;
+            packet.triangle[k] = triangle;
+        }
+    }
+
+    // Corners of base cell (i, j) in the scene frame
+    void cellCorners(const Scene &scene, int i, int j, float corners[4][3])
+    {
+        const HeightField &field = scene.pyramid->getField();
+        float x0 = i * scene.xStep, x1 = (i + 1) * scene.xStep;
+        float y0 = j * scene.yStep, y1 = (j + 1) * scene.yStep;
+        float v00[3] = {x0, y0, field.height(i, j)};
+        float v10[3] = {x1, y0, field.height(i + 1, j)};
+        float v01[3] = {x0, y1, field.height(i, j + 1)};
+        float v11[3] = {x1, y1, field.height(i + 1, j + 1)};
+        std::copy(v00, v00 + 3, corners[0]);
+        std::copy(v10, v10 + 3, corners[1]);
+        std::copy(v01, v01 + 3, corners[2]);
+        std::copy(v11, v11 + 3, corners[3]);
+    }
+
+    // Triangle k of a cell, as in HeightPyramid::intersectRay:
+    // 0 is (v00, v10, v01), 1 is (v10, v01, v11)
+    const int CELL_TRIANGLES[2][3] = {{0, 1, 2}, {1, 2, 3}};
+
+    // Descend the pyramid front to back, testing each cell against the
+    // packet and the triangles of the base cells it reaches
+    void tracePacket(const Scene &scene, Packet &packet)
+    {
+        const HeightPyramid &pyramid = *scene.pyramid;
+        const int baseColumns = pyramid.level(0).columns, baseRows = pyramid.level(0).rows;
+
+        struct Node
+        {
+            int level, i, j;
+        };
+        Node stack[3 * 32 + 1]; // Three siblings wait on each level
+        int top = 0;
+        stack[top++] = {pyramid.levelCount() - 1, 0, 0};
+
+        while (top > 0)
+        {
+            Node node = stack[--top];
+            const HeightPyramid::Level &level = pyramid.level(node.level);
+
+            int i0 = node.i << node.level, j0 = node.j << node.level;
+            int i1 = std::min((node.i + 1) << node.level, baseColumns);
+            int j1 = std::min((node.j + 1) << node.level, baseRows);
+            float boxMin[3] = {i0 * scene.xStep, j0 * scene.yStep, level.minAt(node.i, node.j)};
+            float boxMax[3] = {i1 * scene.xStep, j1 * scene.yStep, level.maxAt(node.i, node.j)};
+            if (!packetHitsBox(scene, packet, boxMin, boxMax))
+                continue;
+
+            if (node.level == 0)
+            {
+                float corners[4][3];
+                cellCorners(scene, node.i, node.j, corners);
+                for (int k = 0; k < 2; ++k)
+                {
+                    const int *corner = CELL_TRIANGLES[k];
+                    intersectTriangle(scene, packet, corners[corner[0]], corners[corner[1]], corners[corner[2]],
+                                      node.i, node.j, k);
+                }
+                continue;
+            }
+
+            // Every ray starts at the eye, so the child on the eye's side of
+            // each split plane is entered first. Push far to near.
+            const HeightPyramid::Level &below = pyramid.level(node.level - 1);
+            int childLevel = node.level - 1;
+            float splitX = ((2 * node.i + 1) << childLevel) * scene.xStep;
+            float splitY = ((2 * node.j + 1) << childLevel) * scene.yStep;
+            int nearX = scene.origin[0] < splitX ? 0 : 1;
+            int nearY = scene.origin[1] < splitY ? 0 : 1;
+            const int order[4][2] = {{1 - nearX, 1 - nearY}, {nearX, 1 - nearY}, {1 - nearX, nearY}, {nearX, nearY}};
+            for (const auto &offset : order)
+            {
+                int ci = 2 * node.i + offset[0], cj = 2 * node.j + offset[1];
+                if (ci < below.columns && cj < below.rows)
+                    stack[top++] = {childLevel, ci, cj};
+            }
+        }
+    }
+
+    uint8_t toByte(float value)
+    {
+        return static_cast<uint8_t>(std::min(255.0f, std::max(0.0f, value * 255.0f + 0.5f)));
+    }
+
+    struct TileBuffer
+    {
+        float invDepth[RayCaster::TILE_SIZE * RayCaster::TILE_SIZE];
+        uint8_t rgb[3 * RayCaster::TILE_SIZE * RayCaster::TILE_SIZE];
+    };
+
+    // Thick line with round caps: pixels within halfWidth of the segment
+    void rasterSegment(TileBuffer &tile, int originX, int originY, int tileWidth, int tileHeight,
+                       const RayCaster::ScreenSegment &segment)
+    {
+        float x0 = segment.x0 - originX, y0 = segment.y0 - originY;
+        float x1 = segment.x1 - originX, y1 = segment.y1 - originY;
+        float reach = segment.halfWidth;
+        int xBegin = std::max(0, static_cast<int>(std::ceil(std::min(x0, x1) - reach - 0.5f)));
+        int xEnd = std::min(tileWidth - 1, static_cast<int>(std::floor(std::max(x0, x1) + reach - 0.5f)));
+        int yBegin = std::max(0, static_cast<int>(std::ceil(std::min(y0, y1) - reach - 0.5f)));
+        int yEnd = std::min(tileHeight - 1, static_cast<int>(std::floor(std::max(y0, y1) + reach - 0.5f)));
+
+        float dx = x1 - x0, dy = y1 - y0;
+        float length2 = dx * dx + dy * dy;
+        float invLength2 = length2 > 0.0f ? 1.0f / length2 : 0.0f;
+        float reach2 = reach * reach;
+        uint8_t colour[3] = {toByte(segment.colour[0]), toByte(segment.colour[1]), toByte(segment.colour[2])};
+
+        for (int y = yBegin; y <= yEnd; ++y)
+        {
+            for (int x = xBegin; x <= xEnd; ++x)
+            {
+                float px = x + 0.5f - x0, py = y + 0.5f - y0;
+                float s = std::min(1.0f, std::max(0.0f, (px * dx + py * dy) * invLength2));
+                float ox = px - s * dx, oy = py - s * dy;
+                if (ox * ox + oy * oy > reach2)
+                    continue;
+
+                // 1 / depth is linear in screen space
+                float invDepth = (segment.invDepth0 + s * (segment.invDepth1 - segment.invDepth0)) *
+                                 (1.0f + OVERLAY_DEPTH_BIAS);
+                size_t index = static_cast<size_t>(y) * RayCaster::TILE_SIZE + x;
+                if (invDepth <= tile.invDepth[index])
+                    continue;
+                tile.invDepth[index] = invDepth;
+                std::copy(colour, colour + 3, tile.rgb + 3 * index);
+            }
+        }
+    }
+
+    void rasterDisc(TileBuffer &tile, int originX, int originY, int tileWidth, int tileHeight,
+                    const SoftwareRenderer::ScreenDisc &disc)
+    {
+        float cx = disc.x - originX, cy = disc.y - originY;
+        int xBegin = std::max(0, static_cast<int>(std::ceil(cx - disc.radius - 0.5f)));
+        int xEnd = std::min(tileWidth - 1, static_cast<int>(std::floor(cx + disc.radius - 0.5f)));
+        int yBegin = std::max(0, static_cast<int>(std::ceil(cy - disc.radius - 0.5f)));
+        int yEnd = std::min(tileHeight - 1, static_cast<int>(std::floor(cy + disc.radius - 0.5f)));
+
+        uint8_t colour[3] = {toByte(disc.colour[0]), toByte(disc.colour[1]), toByte(disc.colour[2])};
+        float radius2 = disc.radius * disc.radius;
+        for (int y = yBegin; y <= yEnd; ++y)
+        {
+            for (int x = xBegin; x <= xEnd; ++x)
+            {
+                float dx = x + 0.5f - cx, dy = y + 0.5f - cy;
+                float r2 = dx * dx + dy * dy;
+                if (r2 > radius2)
+                    continue;
+
+                float depth = disc.depth - disc.worldRadius * std::sqrt(1.0f - r2 / radius2);
+                float invDepth = (1.0f + OVERLAY_DEPTH_BIAS) / depth;
+                size_t index = static_cast<size_t>(y) * RayCaster::TILE_SIZE + x;
+                if (invDepth <= tile.invDepth[index])
+                    continue;
+                tile.invDepth[index] = invDepth;
+                std::copy(colour, colour + 3, tile.rgb + 3 * index);
+            }
+        }
+    }
+}
+
+RayCaster::RayCaster(ThreadPool *pool) : pool(pool ? pool : &ThreadPool::shared())
+{
+}
+
+Image RayCaster::render(const HeightPyramid &pyramid, const OptimizationResult *path,
+                        const RenderSettings &settings, const Surface *surface)
+{
+    Image image;
+    render(pyramid, path, settings, image, surface);
+    return image;
+}
+
+void RayCaster::render(const HeightPyramid &pyramid, const OptimizationResult *path,
+                       const RenderSettings &settings, Image &image, const Surface *surface)
+{
+    SURFACE_TIME_SCOPE(RENDER);
+    if (settings.width <= 0 || settings.height <= 0)
+        throw std::runtime_error("Render size must be positive");
+    if (image.width != settings.width || image.height != settings.height)
+        image = Image(settings.width, settings.height);
+
+    ViewTransform view(settings);
+    tileColumns = (settings.width + TILE_SIZE - 1) / TILE_SIZE;
+    tileRows = (settings.height + TILE_SIZE - 1) / TILE_SIZE;
+    size_t tileCount = static_cast<size_t>(tileColumns) * tileRows;
+    bins.resize(tileCount);
+    for (auto &bin : bins)
+        bin.clear();
+    segments.clear();
+    discs.clear();
+
+    addOverlay(path, settings, view);
+
+    SURFACE_TRACE_SCOPE("render", "raycast", static_cast<int64_t>(tileCount));
+    pool->parallelFor(0, tileCount, 1, [&](size_t begin, size_t end)
+                      {
+        for (size_t tile = begin; tile < end; ++tile)
+            renderTile(static_cast<int>(tile), pyramid, surface, settings, view, image); });
+}
+
+void RayCaster::renderTile(int tile, const HeightPyramid &pyramid, const Surface *surface,
+                           const RenderSettings &settings, const ViewTransform &view, Image &image)
+{
+    int originX = (tile % tileColumns) * TILE_SIZE, originY = (tile / tileColumns) * TILE_SIZE;
+    int tileWidth = std::min(TILE_SIZE, image.width - originX);
+    int tileHeight = std::min(TILE_SIZE, image.height - originY);
+
+    thread_local TileBuffer buffer;
+    std::fill(buffer.invDepth, buffer.invDepth + TILE_SIZE * TILE_SIZE, 1.0f / settings.farPlane);
+    uint8_t background[3] = {toByte(settings.background[0]), toByte(settings.background[1]),
+                             toByte(settings.background[2])};
+    for (int p = 0; p < TILE_SIZE * TILE_SIZE; ++p)
+        std::copy(background, background + 3, buffer.rgb + 3 * p);
+
+    if (!pyramid.empty())
+    {
+        const HeightField &field = pyramid.getField();
+        const float *r = view.rotation;
+
+        // The eye at (0, 0, zoom) in eye space, taken back to the world
+        // with the transposed rotation, then into the field's frame
+        Scene scene;
+        scene.pyramid = &pyramid;
+        scene.origin[0] = view.zoom * r[6] - static_cast<float>(field.getXMin());
+        scene.origin[1] = view.zoom * r[7] - static_cast<float>(field.getYMin());
+        scene.origin[2] = view.zoom * r[8];
+        scene.xStep = static_cast<float>(field.xStep());
+        scene.yStep = static_cast<float>(field.yStep());
+        scene.nearPlane = view.nearPlane;
+
+        for (int py = 0; py < tileHeight; py += PACKET_HEIGHT)
+        {
+            for (int px = 0; px < tileWidth; px += PACKET_WIDTH)
+            {
+                // Eye-space directions have z = -1, so t is the eye depth
+                Packet packet;
+                for (int k = 0; k < LANES; ++k)
+                {
+                    float ex = (originX + px + k % PACKET_WIDTH + 0.5f - view.centreX) / view.focalX;
+                    float ey = -(originY + py + k / PACKET_WIDTH + 0.5f - view.centreY) / view.focalY;
+                    float d[3] = {r[0] * ex + r[3] * ey - r[6],
+                                  r[1] * ex + r[4] * ey - r[7],
+                                  r[2] * ex + r[5] * ey - r[8]};
+                    // Keep the reciprocals finite for axis-parallel rays
+                    for (float &component : d)
+                        if (std::abs(component) < 1e-12f)
+                            component = 1e-12f;
+                    packet.dx[k] = d[0];
+                    packet.dy[k] = d[1];
+                    packet.dz[k] = d[2];
+                    packet.invX[k] = 1.0f / d[0];
+                    packet.invY[k] = 1.0f / d[1];
+                    packet.invZ[k] = 1.0f / d[2];
+                    packet.t[k] = view.farPlane;
+                    packet.triangle[k] = -1;
+                }
+
+                tracePacket(scene, packet);
+
+                // Hit points, and analytic gradients there if a surface was given
+                float hitX[LANES], hitY[LANES], gradX[LANES], gradY[LANES];
+                for (int k = 0; k < LANES; ++k)
+                {
+                    hitX[k] = static_cast<float>(field.getXMin()) + scene.origin[0] + packet.t[k] * packet.dx[k];
+                    hitY[k] = static_cast<float>(field.getYMin()) + scene.origin[1] + packet.t[k] * packet.dy[k];
+                }
+                if (surface)
+                    surface->gradientBatch(hitX, hitY, gradX, gradY, LANES);
+
+                for (int k = 0; k < LANES; ++k)
+                {
+                    int x = px + k % PACKET_WIDTH, y = py + k / PACKET_WIDTH;
+                    if (packet.triangle[k] < 0 || x >= tileWidth || y >= tileHeight)
+                        continue;
+
+                    float normal[3];
+                    int i = packet.cellI[k], j = packet.cellJ[k];
+                    const int *corner = CELL_TRIANGLES[packet.triangle[k]];
+                    if (surface)
+                    {
+                        normal[0] = -gradX[k];
+                        normal[1] = -gradY[k];
+                        normal[2] = 1.0f;
+                    }
+                    else if (field.hasNormals())
+                    {
+                        // Barycentric blend of the stored corner normals
+                        const float *n[4] = {field.normal(i, j), field.normal(i + 1, j), field.normal(i, j + 1),
+                                             field.normal(i + 1, j + 1)};
+                        float w[3] = {1.0f - packet.u[k] - packet.v[k], packet.u[k], packet.v[k]};
+                        for (int axis = 0; axis < 3; ++axis)
+                            normal[axis] = w[0] * n[corner[0]][axis] + w[1] * n[corner[1]][axis] +
+                                           w[2] * n[corner[2]][axis];
+                    }
+                    else
+                    {
+                        float corners[4][3];
+                        cellCorners(scene, i, j, corners);
+                        const float *a = corners[corner[0]], *b = corners[corner[1]], *c = corners[corner[2]];
+                        float e1[3] = {b[0] - a[0], b[1] - a[1], b[2] - a[2]};
+                        float e2[3] = {c[0] - a[0], c[1] - a[1], c[2] - a[2]};
+                        normal[0] = e1[1] * e2[2] - e1[2] * e2[1];
+                        normal[1] = e1[2] * e2[0] - e1[0] * e2[2];
+                        normal[2] = e1[0] * e2[1] - e1[1] * e2[0];
+                        if (normal[2] < 0.0f)
+                            for (float &component : normal)
+                                component = -component;
+                    }
+
+                    float length = std::sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+                    if (length > 0.0f)
+                        for (float &component : normal)
+                            component /= length;
+
+                    float eyeNormal[3], lit[3];
+                    view.rotate(normal, eyeNormal);
+                    view.shade(settings, eyeNormal, settings.surfaceColour, lit);
+
+                    size_t index = static_cast<size_t>(y) * TILE_SIZE + x;
+                    buffer.invDepth[index] = 1.0f / packet.t[k];
+                    for (int channel = 0; channel < 3; ++channel)
+                        buffer.rgb[3 * index + channel] = toByte(lit[channel]);
+                }
+            }
+        }
+    }
+
+    for (uint32_t id : bins[tile])
+    {
+        if (id & DISC)
+            rasterDisc(buffer, originX, originY, tileWidth, tileHeight, discs[id & INDEX_MASK]);
+        else
+            rasterSegment(buffer, originX, originY, tileWidth, tileHeight, segments[id]);
+    }
+
+    for (int y = 0; y < tileHeight; ++y)
+        std::copy(buffer.rgb + 3 * y * TILE_SIZE, buffer.rgb + 3 * (y * TILE_SIZE + tileWidth),
+                  image.pixel(originX, originY + y));
+}
+
+void RayCaster::binBox(uint32_t id, float minX, float minY, float maxX, float maxY, int width, int height)
+{
+    if (!(maxX >= 0.0f && maxY >= 0.0f && minX < width && minY < height))
+        return;
+
+    int x0 = static_cast<int>(std::max(0.0f, minX)) / TILE_SIZE;
+    int x1 = static_cast<int>(std::min(static_cast<float>(width - 1), maxX)) / TILE_SIZE;
+    int y0 = static_cast<int>(std::max(0.0f, minY)) / TILE_SIZE;
+    int y1 = static_cast<int>(std::min(static_cast<float>(height - 1), maxY)) / TILE_SIZE;
+    for (int ty = y0; ty <= y1; ++ty)
+        for (int tx = x0; tx <= x1; ++tx)
+            bins[static_cast<size_t>(ty) * tileColumns + tx].push_back(id);
+}
+
+void RayCaster::addSegment(const float *a, const float *b, const float *colour, float width,
+                           const ViewTransform &view)
+{
+    float ends[2][3];
+    view.toEye(a, ends[0]);
+    view.toEye(b, ends[1]);
+
+    // Clip to the near plane
+    float da = -ends[0][2] - view.nearPlane, db = -ends[1][2] - view.nearPlane;
+    if (da < 0 && db < 0)
+        return;
+    if (da < 0 || db < 0)
+    {
+        float t = da / (da - db);
+        float *moved = da < 0 ? ends[0] : ends[1];
+        for (int k = 0; k < 3; ++k)
+            moved[k] = ends[0][k] + t * (ends[1][k] - ends[0][k]);
+    }
+
+    ScreenSegment segment;
+    float screen[2][3];
+    for (int e = 0; e < 2; ++e)
+    {
+        float invDepth = 1.0f / -ends[e][2];
+        screen[e][0] = view.centreX + view.focalX * ends[e][0] * invDepth;
+        screen[e][1] = view.centreY - view.focalY * ends[e][1] * invDepth;
+        screen[e][2] = invDepth;
+    }
+    segment.x0 = screen[0][0];
+    segment.y0 = screen[0][1];
+    segment.invDepth0 = screen[0][2];
+    segment.x1 = screen[1][0];
+    segment.y1 = screen[1][1];
+    segment.invDepth1 = screen[1][2];
+    segment.halfWidth = 0.5f * width;
+    std::copy(colour, colour + 3, segment.colour);
+
+    segments.push_back(segment);
+    float reach = segment.halfWidth + 1.0f;
+    binBox(static_cast<uint32_t>(segments.size() - 1), std::min(segment.x0, segment.x1) - reach,
+           std::min(segment.y0, segment.y1) - reach, std::max(segment.x0, segment.x1) + reach,
+           std::max(segment.y0, segment.y1) + reach, static_cast<int>(2 * view.centreX),
+           static_cast<int>(2 * view.centreY));
+}
+
+void RayCaster::addOverlay(const OptimizationResult *path, const RenderSettings &settings,
+                           const ViewTransform &view)
+{
+    if (settings.drawAxes)
+    {
+        const float origin[3] = {0, 0, 0};
+        const float axes[3][3] = {{10, 0, 0}, {0, 10, 0}, {0, 0, 10}};
+        const float colours[3][3] = {{1, 0, 0}, {0, 1, 0}, {0, 0, 1}};
+        for (int k = 0; k < 3; ++k)
+            addSegment(origin, axes[k], colours[k], 2.0f, view);
+    }
+
+    if (!path || path->pathSize() == 0)
+        return;
+
+    const float red[3] = {1, 0, 0}, green[3] = {0, 1, 0};
+    for (size_t i = 0; i + 1 < path->pathSize(); ++i)
+    {
+        Point3D a = path->pathPoint(i), b = path->pathPoint(i + 1);
+        float pa[3] = {static_cast<float>(a.getX()), static_cast<float>(a.getY()), static_cast<float>(a.getZ())};
+        float pb[3] = {static_cast<float>(b.getX()), static_cast<float>(b.getY()), static_cast<float>(b.getZ())};
+        addSegment(pa, pb, red, settings.pathWidth, view);
+    }
+
+    // Start and end markers, sized as in Visualizer::drawOptimizationPath
+    const Point3D centres[2] = {path->pathPoint(0), path->pathPoint(path->pathSize() - 1)};
+    const float radii[2] = {0.2f, 0.3f};
+    const float *colours[2] = {green, red};
+    for (int k = 0; k < 2; ++k)
+    {
+        SoftwareRenderer::ScreenDisc disc;
+        if (!SoftwareRenderer::projectDisc(centres[k], radii[k], colours[k], view, disc))
+            continue;
+        discs.push_back(disc);
+        binBox(DISC | static_cast<uint32_t>(discs.size() - 1), disc.x - disc.radius, disc.y - disc.radius,
+               disc.x + disc.radius, disc.y + disc.radius, static_cast<int>(2 * view.centreX),
+               static_cast<int>(2 * view.centreY));
+    }
+}
@@ -0,0 +1,253 @@
+#include "SampledSurface.h"
+#include "ByteOrder.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <vector>
+
+static_assert(sizeof(GridFileHeader) == 72, "GridFileHeader must match the on-disk layout");
+
+static const char GRID_MAGIC[8] = {'S', 'O', 'G', 'R', 'I', 'D', '\0', '\0'};
+
+static size_t sampleSize(uint32_t dataType)
+{
+    return dataType == SampledSurface::FLOAT64 ? sizeof(double) : sizeof(float);
+}
+
+SampledSurface::SampledSurface(const std::string &path, Interpolation interp)
+    : file(path), samples(nullptr), interpolation(interp)
+{
+    if (file.size() < sizeof(GridFileHeader))
+        throw std::runtime_error("Grid file too small: " + path);
+
+    std::memcpy(&header, file.data(), sizeof(GridFileHeader));
+
+    if (std::memcmp(header.magic, GRID_MAGIC, sizeof(GRID_MAGIC)) != 0)
+        throw std::runtime_error("Not a grid file: " + path);
+    if (header.version == byteSwapped(GRID_FILE_VERSION))
+        throw std::runtime_error("Grid file was written with the other byte order: " + path);
+    if (header.version != GRID_FILE_VERSION)
+        throw std::runtime_error("Unsupported grid file version: " + path);
+    if (header.dataType != FLOAT32 && header.dataType != FLOAT64)
+        throw std::runtime_error("Unsupported grid data type: " + path);
+    if (header.columns < 2 || header.rows < 2)
+        throw std::runtime_error("Grid needs at least 2x2 samples: " + path);
+    if (!(header.xMax > header.xMin) || !(header.yMax > header.yMin))
+        throw std::runtime_error("Invalid grid bounds: " + path);
+
+    size_t bytesPerSample = sampleSize(header.dataType);
+    if (header.dataOffset % bytesPerSample != 0)
+        throw std::runtime_error("Misaligned grid data: " + path);
+
+    // Guard against overflow before multiplying out the payload size
+    uint64_t available = (file.size() - std::min<uint64_t>(file.size(), header.dataOffset)) / bytesPerSample;
+    if (header.dataOffset > file.size() || header.columns > available / header.rows)
+        throw std::runtime_error("Grid file truncated: " + path);
+
+    samples = file.data() + header.dataOffset;
+    xStep = (header.xMax - header.xMin) / static_cast<double>(header.columns - 1);
+    yStep = (header.yMax - header.yMin) / static_cast<double>(header.rows - 1);
+}
+
+double SampledSurface::sample(size_t i, size_t j) const
+{
+    size_t index = j * static_cast<size_t>(header.columns) + i;
+    if (header.dataType == FLOAT64)
+        return static_cast<const double *>(samples)[index];
+    return static_cast<const float *>(samples)[index];
+}
+
+// Catmull-Rom weights for the four samples around t in [0, 1], and their derivatives
+static void cubicWeights(double t, double w[4], double dw[4])
+{
+    double t2 = t * t;
+    double t3 = t2 * t;
+    w[0] = 0.5 * (-t + 2 * t2 - t3);
+    w[1] = 0.5 * (2 - 5 * t2 + 3 * t3);
+    w[2] = 0.5 * (t + 4 * t2 - 3 * t3);
+    w[3] = 0.5 * (-t2 + t3);
+    dw[0] = 0.5 * (-1 + 4 * t - 3 * t2);
+    dw[1] = 0.5 * (-10 * t + 9 * t2);
+    dw[2] = 0.5 * (1 + 8 * t - 9 * t2);
+    dw[3] = 0.5 * (-2 * t + 3 * t2);
+}
+
+template <typename T>
+double SampledSurface::interpolate(double x, double y, double *dx, double *dy) const
+{
+    const T *data = static_cast<const T *>(samples);
+    const ptrdiff_t nx = static_cast<ptrdiff_t>(header.columns);
+    const ptrdiff_t ny = static_cast<ptrdiff_t>(header.rows);
+
+    // Continuous grid coordinates, clamped to the domain
+    double u = (x - header.xMin) / xStep;
+    double v = (y - header.yMin) / yStep;
+    bool clampedX = !(u >= 0 && u <= nx - 1);
+    bool clampedY = !(v >= 0 && v <= ny - 1);
+    u = std::min(std::max(u, 0.0), static_cast<double>(nx - 1));
+    v = std::min(std::max(v, 0.0), static_cast<double>(ny - 1));
+
+    ptrdiff_t i = std::min(static_cast<ptrdiff_t>(u), nx - 2);
+    ptrdiff_t j = std::min(static_cast<ptrdiff_t>(v), ny - 2);
+    double tx = u - i;
+    double ty = v - j;
+
+    auto at = [&](ptrdiff_t ii, ptrdiff_t jj) -> double
+    {
+        ii = std::min(std::max(ii, ptrdiff_t(0)), nx - 1);
+        jj = std::min(std::max(jj, ptrdiff_t(0)), ny - 1);
+        return static_cast<double>(data[jj * nx + ii]);
+    };
+
+    double value, derivX, derivY;
+
+    if (interpolation == BILINEAR)
+    {
+        double p00 = at(i, j), p10 = at(i + 1, j);
+        double p01 = at(i, j + 1), p11 = at(i + 1, j + 1);
+
+        value = (1 - ty) * ((1 - tx) * p00 + tx * p10) + ty * ((1 - tx) * p01 + tx * p11);
+        derivX = ((1 - ty) * (p10 - p00) + ty * (p11 - p01)) / xStep;
+        derivY = ((1 - tx) * (p01 - p00) + tx * (p11 - p10)) / yStep;
+    }
+    else
+    {
+        double wx[4], dwx[4], wy[4], dwy[4];
+        cubicWeights(tx, wx, dwx);
+        cubicWeights(ty, wy, dwy);
+
+        value = derivX = derivY = 0;
+        for (int m = 0; m < 4; ++m)
+        {
+            double rowValue = 0, rowDerivative = 0;
+            for (int k = 0; k < 4; ++k)
+            {
+                double p = at(i - 1 + k, j - 1 + m);
+                rowValue += wx[k] * p;
+                rowDerivative += dwx[k] * p;
+            }
+            value += wy[m] * rowValue;
+            derivX += wy[m] * rowDerivative;
+            derivY += dwy[m] * rowValue;
+        }
+        derivX /= xStep;
+        derivY /= yStep;
+    }
+
+    // The clamped extension is constant across the border
+    if (dx)
+        *dx = clampedX ? 0.0 : derivX;
+    if (dy)
+        *dy = clampedY ? 0.0 : derivY;
+    return value;
+}
+
+double SampledSurface::evaluate(double x, double y) const
+{
+    if (header.dataType == FLOAT64)
+        return interpolate<double>(x, y, nullptr, nullptr);
+    return interpolate<float>(x, y, nullptr, nullptr);
+}
+
+double SampledSurface::partialX(double x, double y) const
+{
+    double dx;
+    if (header.dataType == FLOAT64)
+        interpolate<double>(x, y, &dx, nullptr);
+    else
+        interpolate<float>(x, y, &dx, nullptr);
+    return dx;
+}
+
+double SampledSurface::partialY(double x, double y) const
+{
+    double dy;
+    if (header.dataType == FLOAT64)
+        interpolate<double>(x, y, nullptr, &dy);
+    else
+        interpolate<float>(x, y, nullptr, &dy);
+    return dy;
+}
+
+static GridFileHeader makeHeader(double xMin, double xMax, double yMin, double yMax,
+                                 size_t columns, size_t rows, SampledSurface::DataType type)
+{
+    if (columns < 2 || rows < 2)
+        throw std::runtime_error("Grid needs at least 2x2 samples");
+
+    GridFileHeader header;
+    std::memcpy(header.magic, GRID_MAGIC, sizeof(GRID_MAGIC));
+    header.version = GRID_FILE_VERSION;
+    header.dataType = type;
+    header.columns = columns;
+    header.rows = rows;
+    header.xMin = xMin;
+    header.xMax = xMax;
+    header.yMin = yMin;
+    header.yMax = yMax;
+    header.dataOffset = sizeof(GridFileHeader);
+    return header;
+}
+
+template <typename T, typename RowSource>
+static void writeRows(const std::string &path, const GridFileHeader &header, RowSource fillRow)
+{
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out)
+        throw std::runtime_error("Cannot write grid file: " + path);
+
+    out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+
+    std::vector<T> row(static_cast<size_t>(header.columns));
+    for (size_t j = 0; j < header.rows; ++j)
+    {
+        fillRow(j, row);
+        out.write(reinterpret_cast<const char *>(row.data()), row.size() * sizeof(T));
+    }
+
+    if (!out)
+        throw std::runtime_error("Failed writing grid file: " + path);
+}
+
+void SampledSurface::writeGridFile(const std::string &path,
+                                   double xMin, double xMax, double yMin, double yMax,
+                                   size_t columns, size_t rows,
+                                   const double *values, DataType type)
+{
+    GridFileHeader header = makeHeader(xMin, xMax, yMin, yMax, columns, rows, type);
+
+    auto copyRow = [&](size_t j, auto &row)
+    {
+        for (size_t i = 0; i < columns; ++i)
+            row[i] = static_cast<typename std::decay<decltype(row[0])>::type>(values[j * columns + i]);
+    };
+
+    if (type == FLOAT64)
+        writeRows<double>(path, header, copyRow);
+    else
+        writeRows<float>(path, header, copyRow);
+}
+
+void SampledSurface::writeGridFile(const std::string &path, const Surface &surface,
+                                   double xMin, double xMax, double yMin, double yMax,
+                                   size_t columns, size_t rows, DataType type)
+{
+    GridFileHeader header = makeHeader(xMin, xMax, yMin, yMax, columns, rows, type);
+    double xStep = (xMax - xMin) / static_cast<double>(columns - 1);
+    double yStep = (yMax - yMin) / static_cast<double>(rows - 1);
+
+    auto sampleRow = [&](size_t j, auto &row)
+    {
+        double y = yMin + j * yStep;
+        for (size_t i = 0; i < columns; ++i)
+            row[i] = static_cast<typename std::decay<decltype(row[0])>::type>(
+                surface.evaluate(xMin + i * xStep, y));
+    };
+
+    if (type == FLOAT64)
+        writeRows<double>(path, header, sampleRow);
+    else
+        writeRows<float>(path, header, sampleRow);
+}
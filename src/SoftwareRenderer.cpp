@@ -0,0 +1,576 @@
+#include "SoftwareRenderer.h"
+#include "Instrumentation.h"
+#include "ThreadPool.h"
+#include "Trace.h"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+static const float PI = 3.14159265358979323846f;
+
+// Bin entries: a mesh triangle index, or one of these tags and an index
+static const uint32_t EXTRA_TRIANGLE = 0x80000000u;
+static const uint32_t DISC = 0x40000000u;
+static const uint32_t INDEX_MASK = 0x3FFFFFFFu;
+
+// Relative boost to 1 / depth of lines and markers so they win ties with
+// the surface they lie on, like glPolygonOffset
+static const float OVERLAY_DEPTH_BIAS = 0.002f;
+
+// Pixels evaluated together by the edge-function loops
+static const int LANES = 8;
+
+ViewTransform::ViewTransform(const RenderSettings &settings)
+{
+    float ax = settings.rotationX * PI / 180.0f, ay = settings.rotationY * PI / 180.0f;
+    float cx = std::cos(ax), sx = std::sin(ax), cy = std::cos(ay), sy = std::sin(ay);
+
+    // Rx(rotationX) * Ry(rotationY), as glRotatef x then y
+    float r[9] = {cy, 0, sy,
+                  sx * sy, cx, -sx * cy,
+                  -cx * sy, sx, cx * cy};
+    std::copy(r, r + 9, rotation);
+
+    zoom = settings.zoom;
+    focalY = 0.5f * settings.height / std::tan(0.5f * settings.fieldOfView * PI / 180.0f);
+    focalX = focalY;
+    centreX = 0.5f * settings.width;
+    centreY = 0.5f * settings.height;
+    nearPlane = settings.nearPlane;
+    farPlane = settings.farPlane;
+
+    const float *l = settings.lightDirection;
+    float length = std::sqrt(l[0] * l[0] + l[1] * l[1] + l[2] * l[2]);
+    for (int k = 0; k < 3; ++k)
+        light[k] = length > 0 ? l[k] / length : 0.0f;
+}
+
+void ViewTransform::shade(const RenderSettings &settings, const float *eyeNormal, const float *colour,
+                          float *lit) const
+{
+    // GL_COLOR_MATERIAL: the colour is both ambient and diffuse reflectance
+    float diffuse = std::max(0.0f, eyeNormal[0] * light[0] + eyeNormal[1] * light[1] + eyeNormal[2] * light[2]);
+    float intensity = settings.globalAmbient + settings.lightAmbient + settings.lightDiffuse * diffuse;
+    for (int k = 0; k < 3; ++k)
+        lit[k] = std::min(1.0f, colour[k] * intensity);
+}
+
+namespace
+{
+    // Eye-space point with its lit colour, before projection
+    struct EyeVertex
+    {
+        float eye[3];
+        float colour[3];
+    };
+
+    SoftwareRenderer::ScreenVertex project(const EyeVertex &v, const ViewTransform &view)
+    {
+        float invDepth = 1.0f / -v.eye[2];
+        SoftwareRenderer::ScreenVertex s;
+        s.x = view.centreX + view.focalX * v.eye[0] * invDepth;
+        s.y = view.centreY - view.focalY * v.eye[1] * invDepth;
+        s.invDepth = invDepth;
+        s.r = v.colour[0] * invDepth;
+        s.g = v.colour[1] * invDepth;
+        s.b = v.colour[2] * invDepth;
+        return s;
+    }
+
+    EyeVertex lerp(const EyeVertex &a, const EyeVertex &b, float t)
+    {
+        EyeVertex v;
+        for (int k = 0; k < 3; ++k)
+        {
+            v.eye[k] = a.eye[k] + t * (b.eye[k] - a.eye[k]);
+            v.colour[k] = a.colour[k] + t * (b.colour[k] - a.colour[k]);
+        }
+        return v;
+    }
+
+    // Clip a polygon to depth >= nearPlane; returns the new vertex count
+    int clipNear(const EyeVertex *in, int count, EyeVertex *out, float nearPlane)
+    {
+        int n = 0;
+        for (int k = 0; k < count; ++k)
+        {
+            const EyeVertex &a = in[k], &b = in[(k + 1) % count];
+            float da = -a.eye[2] - nearPlane, db = -b.eye[2] - nearPlane;
+            if (da >= 0)
+                out[n++] = a;
+            if ((da >= 0) != (db >= 0))
+                out[n++] = lerp(a, b, da / (da - db));
+        }
+        return n;
+    }
+
+    uint8_t toByte(float value)
+    {
+        return static_cast<uint8_t>(std::min(255.0f, std::max(0.0f, value * 255.0f + 0.5f)));
+    }
+
+    // Colour and depth of one tile. 1 / depth starts at 1 / farPlane, so
+    // anything beyond the far plane fails the depth test as in GL.
+    struct TileBuffer
+    {
+        float invDepth[SoftwareRenderer::TILE_SIZE * SoftwareRenderer::TILE_SIZE];
+        uint8_t rgb[3 * SoftwareRenderer::TILE_SIZE * SoftwareRenderer::TILE_SIZE];
+    };
+
+    // Rasterize a triangle inside the tile whose origin is (originX, originY)
+    void rasterTriangle(TileBuffer &tile, int originX, int originY, int tileWidth, int tileHeight,
+                        const SoftwareRenderer::ScreenVertex *a, const SoftwareRenderer::ScreenVertex *b,
+                        const SoftwareRenderer::ScreenVertex *c, float depthBias)
+    {
+        // Tile-relative coordinates keep the edge functions precise
+        float x0 = a->x - originX, y0 = a->y - originY;
+        float x1 = b->x - originX, y1 = b->y - originY;
+        float x2 = c->x - originX, y2 = c->y - originY;
+
+        float area = (x1 - x0) * (y2 - y0) - (y1 - y0) * (x2 - x0);
+        if (area == 0.0f || !std::isfinite(area))
+            return;
+        if (area < 0.0f)
+        {
+            // No back-face culling: both sides of the surface are drawn
+            std::swap(b, c);
+            std::swap(x1, x2);
+            std::swap(y1, y2);
+            area = -area;
+        }
+
+        int xBegin = std::max(0, static_cast<int>(std::ceil(std::min(x0, std::min(x1, x2)) - 0.5f)));
+        int xEnd = std::min(tileWidth - 1, static_cast<int>(std::floor(std::max(x0, std::max(x1, x2)) - 0.5f)));
+        int yBegin = std::max(0, static_cast<int>(std::ceil(std::min(y0, std::min(y1, y2)) - 0.5f)));
+        int yEnd = std::min(tileHeight - 1, static_cast<int>(std::floor(std::max(y0, std::max(y1, y2)) - 0.5f)));
+        if (xBegin > xEnd || yBegin > yEnd)
+            return;
+
+        // Edge k is opposite vertex k: E(px, py) = A px + B py + C, positive
+        // inside. A pixel centre exactly on an edge belongs to the triangle
+        // that owns the edge, so shared edges are drawn once.
+        const float ex[3][2] = {{x1, y1}, {x2, y2}, {x0, y0}};
+        const float ey[3][2] = {{x2, y2}, {x0, y0}, {x1, y1}};
+        float edgeA[3], edgeB[3], edgeC[3];
+        bool owned[3];
+        for (int k = 0; k < 3; ++k)
+        {
+            float dx = ey[k][0] - ex[k][0], dy = ey[k][1] - ex[k][1];
+            edgeA[k] = -dy;
+            edgeB[k] = dx;
+            edgeC[k] = dy * ex[k][0] - dx * ex[k][1];
+            owned[k] = dy < 0 || (dy == 0 && dx > 0);
+        }
+
+        float invArea = 1.0f / area;
+        float d[3] = {a->invDepth, b->invDepth, c->invDepth};
+        float r[3] = {a->r, b->r, c->r};
+        float g[3] = {a->g, b->g, c->g};
+        float bl[3] = {a->b, b->b, c->b};
+        float boost = 1.0f + depthBias;
+
+        for (int y = yBegin; y <= yEnd; ++y)
+        {
+            float py = y + 0.5f;
+            float row[3];
+            for (int k = 0; k < 3; ++k)
+                row[k] = edgeB[k] * py + edgeC[k];
+
+            float *depthRow = tile.invDepth + y * SoftwareRenderer::TILE_SIZE;
+            uint8_t *rgbRow = tile.rgb + 3 * y * SoftwareRenderer::TILE_SIZE;
+
+            for (int x = xBegin; x <= xEnd; x += LANES)
+            {
+                float w0[LANES], w1[LANES], w2[LANES];
+                int inside[LANES];
+                int any = 0;
+                for (int k = 0; k < LANES; ++k)
+                {
+                    float px = static_cast<float>(x + k) + 0.5f;
+                    w0[k] = edgeA[0] * px + row[0];
+                    w1[k] = edgeA[1] * px + row[1];
+                    w2[k] = edgeA[2] * px + row[2];
+                    int in0 = owned[0] ? w0[k] >= 0.0f : w0[k] > 0.0f;
+                    int in1 = owned[1] ? w1[k] >= 0.0f : w1[k] > 0.0f;
+                    int in2 = owned[2] ? w2[k] >= 0.0f : w2[k] > 0.0f;
+                    inside[k] = in0 & in1 & in2 & (x + k <= xEnd);
+                    any |= inside[k];
+                }
+                if (!any)
+                    continue;
+
+                float invDepth[LANES], red[LANES], green[LANES], blue[LANES];
+                for (int k = 0; k < LANES; ++k)
+                {
+                    float b0 = w0[k] * invArea, b1 = w1[k] * invArea, b2 = w2[k] * invArea;
+                    invDepth[k] = b0 * d[0] + b1 * d[1] + b2 * d[2];
+                    float depth = 1.0f / invDepth[k];
+                    red[k] = (b0 * r[0] + b1 * r[1] + b2 * r[2]) * depth;
+                    green[k] = (b0 * g[0] + b1 * g[1] + b2 * g[2]) * depth;
+                    blue[k] = (b0 * bl[0] + b1 * bl[1] + b2 * bl[2]) * depth;
+                    invDepth[k] *= boost;
+                }
+
+                for (int k = 0; k < LANES; ++k)
+                {
+                    if (!inside[k] || invDepth[k] <= depthRow[x + k])
+                        continue;
+                    depthRow[x + k] = invDepth[k];
+                    uint8_t *pixel = rgbRow + 3 * (x + k);
+                    pixel[0] = toByte(red[k]);
+                    pixel[1] = toByte(green[k]);
+                    pixel[2] = toByte(blue[k]);
+                }
+            }
+        }
+    }
+
+    void rasterDisc(TileBuffer &tile, int originX, int originY, int tileWidth, int tileHeight,
+                    const SoftwareRenderer::ScreenDisc &disc)
+    {
+        float cx = disc.x - originX, cy = disc.y - originY;
+        int xBegin = std::max(0, static_cast<int>(std::ceil(cx - disc.radius - 0.5f)));
+        int xEnd = std::min(tileWidth - 1, static_cast<int>(std::floor(cx + disc.radius - 0.5f)));
+        int yBegin = std::max(0, static_cast<int>(std::ceil(cy - disc.radius - 0.5f)));
+        int yEnd = std::min(tileHeight - 1, static_cast<int>(std::floor(cy + disc.radius - 0.5f)));
+
+        uint8_t colour[3] = {toByte(disc.colour[0]), toByte(disc.colour[1]), toByte(disc.colour[2])};
+        float radius2 = disc.radius * disc.radius;
+        for (int y = yBegin; y <= yEnd; ++y)
+        {
+            for (int x = xBegin; x <= xEnd; ++x)
+            {
+                float dx = x + 0.5f - cx, dy = y + 0.5f - cy;
+                float r2 = dx * dx + dy * dy;
+                if (r2 > radius2)
+                    continue;
+
+                // Front of the sphere under this pixel
+                float depth = disc.depth - disc.worldRadius * std::sqrt(1.0f - r2 / radius2);
+                float invDepth = (1.0f + OVERLAY_DEPTH_BIAS) / depth;
+                size_t index = static_cast<size_t>(y) * SoftwareRenderer::TILE_SIZE + x;
+                if (invDepth <= tile.invDepth[index])
+                    continue;
+                tile.invDepth[index] = invDepth;
+                std::copy(colour, colour + 3, tile.rgb + 3 * index);
+            }
+        }
+    }
+}
+
+SoftwareRenderer::SoftwareRenderer(ThreadPool *pool) : pool(pool ? pool : &ThreadPool::shared())
+{
+}
+
+Image SoftwareRenderer::render(const GridMeshF &mesh, const OptimizationResult *path,
+                               const RenderSettings &settings)
+{
+    Image image;
+    render(mesh, path, settings, image);
+    return image;
+}
+
+void SoftwareRenderer::render(const GridMeshF &mesh, const OptimizationResult *path,
+                              const RenderSettings &settings, Image &image, const float *colours)
+{
+    SURFACE_TIME_SCOPE(RENDER);
+    if (settings.width <= 0 || settings.height <= 0)
+        throw std::runtime_error("Render size must be positive");
+    if (image.width != settings.width || image.height != settings.height)
+        image = Image(settings.width, settings.height);
+
+    ViewTransform view(settings);
+    tileColumns = (settings.width + TILE_SIZE - 1) / TILE_SIZE;
+    tileRows = (settings.height + TILE_SIZE - 1) / TILE_SIZE;
+
+    // Mesh triangles are binned by several groups at once; the last group
+    // holds the path, markers and axes
+    groupCount = static_cast<int>(std::min<size_t>(4 * (pool->size() + 1), mesh.triangleCount() / 4096 + 1)) + 1;
+    size_t tileCount = static_cast<size_t>(tileColumns) * tileRows;
+    bins.resize(groupCount * tileCount);
+    for (auto &bin : bins)
+        bin.clear();
+    extraTriangles.resize(groupCount);
+    for (auto &extra : extraTriangles)
+        extra.clear();
+    discs.clear();
+
+    transformVertices(mesh, colours, settings, view);
+    binMesh(mesh, view);
+    addOverlay(path, settings, view);
+
+    {
+        SURFACE_TRACE_SCOPE("render", "raster", static_cast<int64_t>(tileCount));
+        pool->parallelFor(0, tileCount, 1, [&](size_t begin, size_t end)
+                          {
+            for (size_t tile = begin; tile < end; ++tile)
+                rasterizeTile(static_cast<int>(tile), mesh, settings, image); });
+    }
+}
+
+void SoftwareRenderer::transformVertices(const GridMeshF &mesh, const float *colours,
+                                         const RenderSettings &settings, const ViewTransform &view)
+{
+    SURFACE_TRACE_SCOPE("render", "transform", static_cast<int64_t>(mesh.vertexCount()));
+    size_t count = mesh.vertexCount();
+    vertices.resize(count);
+    eyeDepth.resize(count);
+
+    pool->parallelFor(0, count, 4096, [&](size_t begin, size_t end)
+                      {
+        for (size_t v = begin; v < end; ++v)
+        {
+            EyeVertex eye;
+            view.toEye(&mesh.positions[3 * v], eye.eye);
+            float normal[3];
+            view.rotate(&mesh.normals[3 * v], normal);
+            view.shade(settings, normal, colours ? colours + 3 * v : settings.surfaceColour, eye.colour);
+
+            // Vertices behind the near plane keep their plain colour for
+            // clipping, with invDepth 0
+            eyeDepth[v] = -eye.eye[2];
+            if (eyeDepth[v] >= view.nearPlane)
+                vertices[v] = project(eye, view);
+            else
+                vertices[v] = {0.0f, 0.0f, 0.0f, eye.colour[0], eye.colour[1], eye.colour[2]};
+        } });
+}
+
+void SoftwareRenderer::binMesh(const GridMeshF &mesh, const ViewTransform &view)
+{
+    SURFACE_TRACE_SCOPE("render", "bin", static_cast<int64_t>(mesh.triangleCount()));
+    size_t triangles = mesh.triangleCount();
+    int meshGroups = groupCount - 1;
+    int width = static_cast<int>(2 * view.centreX), height = static_cast<int>(2 * view.centreY);
+
+    pool->parallelFor(0, meshGroups, 1, [&](size_t begin, size_t end)
+                      {
+        for (size_t group = begin; group < end; ++group)
+        {
+            size_t first = triangles * group / meshGroups, last = triangles * (group + 1) / meshGroups;
+            for (size_t t = first; t < last; ++t)
+            {
+                const uint32_t *index = &mesh.indices[3 * t];
+                float depth[3] = {eyeDepth[index[0]], eyeDepth[index[1]], eyeDepth[index[2]]};
+                if (depth[0] > view.farPlane && depth[1] > view.farPlane && depth[2] > view.farPlane)
+                    continue;
+
+                int behind = (depth[0] < view.nearPlane) + (depth[1] < view.nearPlane) + (depth[2] < view.nearPlane);
+                if (behind == 0)
+                {
+                    binTriangle(static_cast<int>(group), static_cast<uint32_t>(t), &vertices[index[0]],
+                                &vertices[index[1]], &vertices[index[2]], width, height);
+                    continue;
+                }
+                if (behind == 3)
+                    continue;
+
+                // Crosses the near plane: clip in eye space
+                EyeVertex corners[3], clipped[4];
+                for (int k = 0; k < 3; ++k)
+                {
+                    view.toEye(&mesh.positions[3 * index[k]], corners[k].eye);
+                    const ScreenVertex &s = vertices[index[k]];
+                    float scale = s.invDepth > 0.0f ? 1.0f / s.invDepth : 1.0f;
+                    corners[k].colour[0] = s.r * scale;
+                    corners[k].colour[1] = s.g * scale;
+                    corners[k].colour[2] = s.b * scale;
+                }
+
+                int count = clipNear(corners, 3, clipped, view.nearPlane);
+                std::vector<ScreenTriangle> &extra = extraTriangles[group];
+                for (int k = 1; k + 1 < count; ++k)
+                {
+                    ScreenTriangle triangle = {{project(clipped[0], view), project(clipped[k], view),
+                                                project(clipped[k + 1], view)},
+                                               0.0f};
+                    extra.push_back(triangle);
+                    const ScreenTriangle &stored = extra.back();
+                    binTriangle(static_cast<int>(group), EXTRA_TRIANGLE | static_cast<uint32_t>(extra.size() - 1),
+                                &stored.v[0], &stored.v[1], &stored.v[2], width, height);
+                }
+            }
+        } });
+}
+
+void SoftwareRenderer::binTriangle(int group, uint32_t id, const ScreenVertex *v0, const ScreenVertex *v1,
+                                   const ScreenVertex *v2, int width, int height)
+{
+    float minX = std::min(v0->x, std::min(v1->x, v2->x)), maxX = std::max(v0->x, std::max(v1->x, v2->x));
+    float minY = std::min(v0->y, std::min(v1->y, v2->y)), maxY = std::max(v0->y, std::max(v1->y, v2->y));
+    if (!(maxX >= 0.0f && maxY >= 0.0f && minX < width && minY < height))
+        return;
+
+    int x0 = static_cast<int>(std::max(0.0f, minX)) / TILE_SIZE;
+    int x1 = static_cast<int>(std::min(static_cast<float>(width - 1), maxX)) / TILE_SIZE;
+    int y0 = static_cast<int>(std::max(0.0f, minY)) / TILE_SIZE;
+    int y1 = static_cast<int>(std::min(static_cast<float>(height - 1), maxY)) / TILE_SIZE;
+
+    size_t tileCount = static_cast<size_t>(tileColumns) * tileRows;
+    for (int ty = y0; ty <= y1; ++ty)
+        for (int tx = x0; tx <= x1; ++tx)
+            bins[group * tileCount + static_cast<size_t>(ty) * tileColumns + tx].push_back(id);
+}
+
+void SoftwareRenderer::addLine(const float *a, const float *b, const float *colour, float width,
+                               const ViewTransform &view)
+{
+    EyeVertex ends[2];
+    view.toEye(a, ends[0].eye);
+    view.toEye(b, ends[1].eye);
+    for (auto &end : ends)
+        std::copy(colour, colour + 3, end.colour);
+
+    float da = -ends[0].eye[2] - view.nearPlane, db = -ends[1].eye[2] - view.nearPlane;
+    if (da < 0 && db < 0)
+        return;
+    if (da < 0)
+        ends[0] = lerp(ends[0], ends[1], da / (da - db));
+    else if (db < 0)
+        ends[1] = lerp(ends[0], ends[1], da / (da - db));
+
+    ScreenVertex p = project(ends[0], view), q = project(ends[1], view);
+    float dx = q.x - p.x, dy = q.y - p.y;
+    float length = std::sqrt(dx * dx + dy * dy);
+    if (length == 0.0f)
+        return;
+
+    // Screen-space quad of the given width
+    float nx = -dy / length * 0.5f * width, ny = dx / length * 0.5f * width;
+    ScreenVertex corners[4] = {p, p, q, q};
+    for (int k = 0; k < 4; ++k)
+    {
+        float side = (k == 0 || k == 3) ? 1.0f : -1.0f;
+        corners[k].x += side * nx;
+        corners[k].y += side * ny;
+    }
+
+    int group = groupCount - 1;
+    int screenWidth = static_cast<int>(2 * view.centreX), screenHeight = static_cast<int>(2 * view.centreY);
+    std::vector<ScreenTriangle> &extra = extraTriangles[group];
+    const int quad[2][3] = {{0, 1, 2}, {0, 2, 3}};
+    for (const auto &corner : quad)
+    {
+        extra.push_back({{corners[corner[0]], corners[corner[1]], corners[corner[2]]}, OVERLAY_DEPTH_BIAS});
+        const ScreenTriangle &stored = extra.back();
+        binTriangle(group, EXTRA_TRIANGLE | static_cast<uint32_t>(extra.size() - 1),
+                    &stored.v[0], &stored.v[1], &stored.v[2], screenWidth, screenHeight);
+    }
+}
+
+void SoftwareRenderer::addOverlay(const OptimizationResult *path, const RenderSettings &settings,
+                                  const ViewTransform &view)
+{
+    if (settings.drawAxes)
+    {
+        const float origin[3] = {0, 0, 0};
+        const float axes[3][3] = {{10, 0, 0}, {0, 10, 0}, {0, 0, 10}};
+        const float colours[3][3] = {{1, 0, 0}, {0, 1, 0}, {0, 0, 1}};
+        for (int k = 0; k < 3; ++k)
+            addLine(origin, axes[k], colours[k], 2.0f, view);
+    }
+
+    if (!path || path->pathSize() == 0)
+        return;
+
+    const float red[3] = {1, 0, 0}, green[3] = {0, 1, 0};
+    for (size_t i = 0; i + 1 < path->pathSize(); ++i)
+    {
+        Point3D a = path->pathPoint(i), b = path->pathPoint(i + 1);
+        float pa[3] = {static_cast<float>(a.getX()), static_cast<float>(a.getY()), static_cast<float>(a.getZ())};
+        float pb[3] = {static_cast<float>(b.getX()), static_cast<float>(b.getY()), static_cast<float>(b.getZ())};
+        addLine(pa, pb, red, settings.pathWidth, view);
+    }
+
+    // Start and end markers, sized as in Visualizer::drawOptimizationPath
+    struct Marker
+    {
+        Point3D point;
+        float radius;
+        const float *colour;
+    };
+    Marker markers[2] = {{path->pathPoint(0), 0.2f, green},
+                         {path->pathPoint(path->pathSize() - 1), 0.3f, red}};
+    int width = static_cast<int>(2 * view.centreX), height = static_cast<int>(2 * view.centreY);
+    size_t tileCount = static_cast<size_t>(tileColumns) * tileRows;
+    for (const Marker &marker : markers)
+    {
+        ScreenDisc disc;
+        if (!projectDisc(marker.point, marker.radius, marker.colour, view, disc))
+            continue;
+
+        discs.push_back(disc);
+        uint32_t id = DISC | static_cast<uint32_t>(discs.size() - 1);
+        int x0 = std::max(0, static_cast<int>(disc.x - disc.radius)) / TILE_SIZE;
+        int x1 = std::min(width - 1, static_cast<int>(disc.x + disc.radius)) / TILE_SIZE;
+        int y0 = std::max(0, static_cast<int>(disc.y - disc.radius)) / TILE_SIZE;
+        int y1 = std::min(height - 1, static_cast<int>(disc.y + disc.radius)) / TILE_SIZE;
+        for (int ty = y0; ty <= y1; ++ty)
+            for (int tx = x0; tx <= x1; ++tx)
+                bins[(groupCount - 1) * tileCount + static_cast<size_t>(ty) * tileColumns + tx].push_back(id);
+    }
+}
+
+bool SoftwareRenderer::projectDisc(const Point3D &centre, float radius, const float *colour,
+                                   const ViewTransform &view, ScreenDisc &disc)
+{
+    float world[3] = {static_cast<float>(centre.getX()), static_cast<float>(centre.getY()),
+                      static_cast<float>(centre.getZ())};
+    float eye[3];
+    view.toEye(world, eye);
+    float depth = -eye[2];
+    if (depth - radius < view.nearPlane)
+        return false;
+
+    disc.x = view.centreX + view.focalX * eye[0] / depth;
+    disc.y = view.centreY - view.focalY * eye[1] / depth;
+    disc.radius = view.focalY * radius / depth;
+    disc.depth = depth;
+    disc.worldRadius = radius;
+    std::copy(colour, colour + 3, disc.colour);
+    return disc.x + disc.radius >= 0 && disc.y + disc.radius >= 0 && disc.x - disc.radius < 2 * view.centreX &&
+           disc.y - disc.radius < 2 * view.centreY;
+}
+
+void SoftwareRenderer::rasterizeTile(int tile, const GridMeshF &mesh, const RenderSettings &settings,
+                                     Image &image)
+{
+    int originX = (tile % tileColumns) * TILE_SIZE, originY = (tile / tileColumns) * TILE_SIZE;
+    int tileWidth = std::min(TILE_SIZE, image.width - originX);
+    int tileHeight = std::min(TILE_SIZE, image.height - originY);
+
+    thread_local TileBuffer buffer;
+    std::fill(buffer.invDepth, buffer.invDepth + TILE_SIZE * TILE_SIZE, 1.0f / settings.farPlane);
+    uint8_t background[3] = {toByte(settings.background[0]), toByte(settings.background[1]),
+                             toByte(settings.background[2])};
+    for (int p = 0; p < TILE_SIZE * TILE_SIZE; ++p)
+        std::copy(background, background + 3, buffer.rgb + 3 * p);
+
+    size_t tileCount = static_cast<size_t>(tileColumns) * tileRows;
+    for (int group = 0; group < groupCount; ++group)
+    {
+        for (uint32_t id : bins[group * tileCount + tile])
+        {
+            if (id & EXTRA_TRIANGLE)
+            {
+                const ScreenTriangle &triangle = extraTriangles[group][id & INDEX_MASK];
+                rasterTriangle(buffer, originX, originY, tileWidth, tileHeight, &triangle.v[0],
+                               &triangle.v[1], &triangle.v[2], triangle.depthBias);
+            }
+            else if (id & DISC)
+            {
+                rasterDisc(buffer, originX, originY, tileWidth, tileHeight, discs[id & INDEX_MASK]);
+            }
+            else
+            {
+                const uint32_t *index = &mesh.indices[3 * static_cast<size_t>(id)];
+                rasterTriangle(buffer, originX, originY, tileWidth, tileHeight, &vertices[index[0]],
+                               &vertices[index[1]], &vertices[index[2]], 0.0f);
+            }
+        }
+    }
+
+    for (int y = 0; y < tileHeight; ++y)
+        std::copy(buffer.rgb + 3 * y * TILE_SIZE, buffer.rgb + 3 * (y * TILE_SIZE + tileWidth),
+                  image.pixel(originX, originY + y));
+}
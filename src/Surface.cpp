@@ -1,4 +1,8 @@
 #include "Surface.h"
+#include "Instrumentation.h"
+#include "Trace.h"
+#include <algorithm>
+#include <cmath>
 
 const double h = 0.0001; // Small value for numerical derivatives
 
@@ -19,6 +23,29 @@ Point3D Surface::gradient(double x, double y) const
     return Point3D(partialX(x, y), partialY(x, y), 0);
 }
 
+double Surface::partialXX(double x, double y) const
+{
+    // Central difference of the first partials, exact if those are analytic
+    return (partialX(x + h, y) - partialX(x - h, y)) / (2 * h);
+}
+
+double Surface::partialYY(double x, double y) const
+{
+    return (partialY(x, y + h) - partialY(x, y - h)) / (2 * h);
+}
+
+double Surface::partialXY(double x, double y) const
+{
+    return (partialX(x, y + h) - partialX(x, y - h)) / (2 * h);
+}
+
+void Surface::hessian(double x, double y, double &fxx, double &fxy, double &fyy) const
+{
+    fxx = partialXX(x, y);
+    fxy = partialXY(x, y);
+    fyy = partialYY(x, y);
+}
+
 std::vector<Point3D> Surface::generateMesh(double xMin, double xMax,
                                            double yMin, double yMax,
                                            int resolution) const
@@ -41,6 +68,154 @@ std::vector<Point3D> Surface::generateMesh(double xMin, double xMax,
     return mesh;
 }
 
+void Surface::evaluateBatch(const double *x, const double *y, double *z, size_t count) const
+{
+    for (size_t k = 0; k < count; ++k)
+        z[k] = evaluate(x[k], y[k]);
+}
+
+void Surface::evaluateBatch(const float *x, const float *y, float *z, size_t count) const
+{
+    for (size_t k = 0; k < count; ++k)
+        z[k] = static_cast<float>(evaluate(x[k], y[k]));
+}
+
+void Surface::gradientBatch(const double *x, const double *y,
+                            double *gx, double *gy, size_t count) const
+{
+    for (size_t k = 0; k < count; ++k)
+    {
+        Point3D grad = gradient(x[k], y[k]);
+        gx[k] = grad.getX();
+        gy[k] = grad.getY();
+    }
+}
+
+void Surface::gradientBatch(const float *x, const float *y,
+                            float *gx, float *gy, size_t count) const
+{
+    for (size_t k = 0; k < count; ++k)
+    {
+        Point3D grad = gradient(x[k], y[k]);
+        gx[k] = static_cast<float>(grad.getX());
+        gy[k] = static_cast<float>(grad.getY());
+    }
+}
+
+// Objective interface. Batches are split into x and y arrays in
+// stack-sized chunks so the 2D batch overrides are used.
+static const size_t OBJECTIVE_CHUNK = 256;
+
+double Surface::valueAndGradient(const double *p, double *grad) const
+{
+    Point3D g = gradient(p[0], p[1]);
+    grad[0] = g.getX();
+    grad[1] = g.getY();
+    return evaluate(p[0], p[1]);
+}
+
+void Surface::valueBatch(const double *points, size_t count, double *values) const
+{
+    double x[OBJECTIVE_CHUNK], y[OBJECTIVE_CHUNK];
+    for (size_t begin = 0; begin < count; begin += OBJECTIVE_CHUNK)
+    {
+        size_t n = std::min(OBJECTIVE_CHUNK, count - begin);
+        for (size_t k = 0; k < n; ++k)
+        {
+            x[k] = points[2 * (begin + k)];
+            y[k] = points[2 * (begin + k) + 1];
+        }
+        evaluateBatch(x, y, values + begin, n);
+    }
+}
+
+void Surface::valueAndGradientBatch(const double *points, size_t count,
+                                    double *values, double *grads) const
+{
+    double x[OBJECTIVE_CHUNK], y[OBJECTIVE_CHUNK], gx[OBJECTIVE_CHUNK], gy[OBJECTIVE_CHUNK];
+    for (size_t begin = 0; begin < count; begin += OBJECTIVE_CHUNK)
+    {
+        size_t n = std::min(OBJECTIVE_CHUNK, count - begin);
+        for (size_t k = 0; k < n; ++k)
+        {
+            x[k] = points[2 * (begin + k)];
+            y[k] = points[2 * (begin + k) + 1];
+        }
+        evaluateBatch(x, y, values + begin, n);
+        gradientBatch(x, y, gx, gy, n);
+        for (size_t k = 0; k < n; ++k)
+        {
+            grads[2 * (begin + k)] = gx[k];
+            grads[2 * (begin + k) + 1] = gy[k];
+        }
+    }
+}
+
+template <typename Scalar>
+HeightFieldT<Scalar> Surface::sampleHeights(double xMin, double xMax,
+                                            double yMin, double yMax,
+                                            int resolution, bool withNormals) const
+{
+    SURFACE_TIME_SCOPE(MESH);
+    HeightFieldT<Scalar> field(xMin, xMax, yMin, yMax, resolution + 1, resolution + 1, withNormals);
+    SURFACE_COUNT(EVALUATIONS, field.sampleCount());
+    if (withNormals)
+        SURFACE_COUNT(GRADIENTS, field.sampleCount());
+    size_t columns = static_cast<size_t>(field.getColumns());
+    Scalar *heights = field.heightData();
+    Scalar *normals = field.normalData();
+
+    // One batch call per row
+    std::vector<Scalar> xs(columns), ys(columns), gx, gy;
+    for (size_t i = 0; i < columns; ++i)
+        xs[i] = static_cast<Scalar>(field.xAt(static_cast<int>(i)));
+    if (withNormals)
+    {
+        gx.resize(columns);
+        gy.resize(columns);
+    }
+
+    // Rows are sampled in tiles so a trace shows the progress of a mesh
+    const int tileRows = 32;
+    for (int tile = 0; tile <= resolution; tile += tileRows)
+    {
+        SURFACE_TRACE_SCOPE("mesh", "tile", tile);
+        int tileEnd = std::min(resolution, tile + tileRows - 1);
+        for (int j = tile; j <= tileEnd; ++j)
+        {
+            std::fill(ys.begin(), ys.end(), static_cast<Scalar>(field.yAt(j)));
+            size_t rowStart = static_cast<size_t>(j) * columns;
+            evaluateBatch(xs.data(), ys.data(), heights + rowStart, columns);
+
+            if (withNormals)
+            {
+                // Unit normal of z = f(x, y): (-fx, -fy, 1) / |(-fx, -fy, 1)|
+                gradientBatch(xs.data(), ys.data(), gx.data(), gy.data(), columns);
+                Scalar *row = normals + 3 * rowStart;
+                for (size_t i = 0; i < columns; ++i)
+                {
+                    Scalar inv = Scalar(1) / std::sqrt(gx[i] * gx[i] + gy[i] * gy[i] + Scalar(1));
+                    row[3 * i] = -gx[i] * inv;
+                    row[3 * i + 1] = -gy[i] * inv;
+                    row[3 * i + 2] = inv;
+                }
+            }
+        }
+    }
+
+    return field;
+}
+
+template HeightFieldT<float> Surface::sampleHeights<float>(double, double, double, double, int, bool) const;
+template HeightFieldT<double> Surface::sampleHeights<double>(double, double, double, double, int, bool) const;
+
+HeightField Surface::sampleHeightField(double xMin, double xMax,
+                                       double yMin, double yMax,
+                                       int resolution, bool withNormals) const
+{
+    return sampleHeights<float>(xMin, xMax, yMin, yMax, resolution, withNormals);
+}
+
 // Paraboloid implementation
 double Paraboloid::evaluate(double x, double y) const
 {
@@ -57,6 +232,60 @@ double Paraboloid::partialY(double x, double y) const
     return 2 * y;
 }
 
+double Paraboloid::partialXX(double, double) const
+{
+    return 2;
+}
+
+double Paraboloid::partialYY(double, double) const
+{
+    return 2;
+}
+
+double Paraboloid::partialXY(double, double) const
+{
+    return 0;
+}
+
+template <typename T>
+static void paraboloidBatch(const T *x, const T *y, T *z, size_t count)
+{
+    for (size_t k = 0; k < count; ++k)
+        z[k] = x[k] * x[k] + y[k] * y[k];
+}
+
+template <typename T>
+static void paraboloidGradientBatch(const T *x, const T *y, T *gx, T *gy, size_t count)
+{
+    for (size_t k = 0; k < count; ++k)
+    {
+        gx[k] = 2 * x[k];
+        gy[k] = 2 * y[k];
+    }
+}
+
+void Paraboloid::evaluateBatch(const double *x, const double *y, double *z, size_t count) const
+{
+    paraboloidBatch(x, y, z, count);
+}
+
+void Paraboloid::evaluateBatch(const float *x, const float *y, float *z, size_t count) const
+{
+    paraboloidBatch(x, y, z, count);
+}
+
+void Paraboloid::gradientBatch(const double *x, const double *y,
+                               double *gx, double *gy, size_t count) const
+{
+    paraboloidGradientBatch(x, y, gx, gy, count);
+}
+
+void Paraboloid::gradientBatch(const float *x, const float *y,
+                               float *gx, float *gy, size_t count) const
+{
+    paraboloidGradientBatch(x, y, gx, gy, count);
+}
+
 // Saddle surface implementation
 double SaddleSurface::evaluate(double x, double y) const
 {
@@ -73,8 +302,108 @@ double SaddleSurface::partialY(double x, double y) const
     return -2 * y;
 }
 
+double SaddleSurface::partialXX(double, double) const
+{
+    return 2;
+}
+
+double SaddleSurface::partialYY(double, double) const
+{
+    return -2;
+}
+
+double SaddleSurface::partialXY(double, double) const
+{
+    return 0;
+}
+
+template <typename T>
+static void saddleBatch(const T *x, const T *y, T *z, size_t count)
+{
+    for (size_t k = 0; k < count; ++k)
+        z[k] = x[k] * x[k] - y[k] * y[k];
+}
+
+template <typename T>
+static void saddleGradientBatch(const T *x, const T *y, T *gx, T *gy, size_t count)
+{
+    for (size_t k = 0; k < count; ++k)
+    {
+        gx[k] = 2 * x[k];
+        gy[k] = -2 * y[k];
+    }
+}
+
+void SaddleSurface::evaluateBatch(const double *x, const double *y, double *z, size_t count) const
+{
+    saddleBatch(x, y, z, count);
+}
+
+void SaddleSurface::evaluateBatch(const float *x, const float *y, float *z, size_t count) const
+{
+    saddleBatch(x, y, z, count);
+}
+
+void SaddleSurface::gradientBatch(const double *x, const double *y,
+                                  double *gx, double *gy, size_t count) const
+{
+    saddleGradientBatch(x, y, gx, gy, count);
+}
+
+void SaddleSurface::gradientBatch(const float *x, const float *y,
+                                  float *gx, float *gy, size_t count) const
+{
+    saddleGradientBatch(x, y, gx, gy, count);
+}
+
 // Custom surface implementation
 double CustomSurface::evaluate(double x, double y) const
 {
     return func(x, y);
-}
\ No newline at end of file
+}
+
+double CustomSurface::partialX(double x, double y) const
+{
+    return derivatives ? derivatives(x, y).dx : Surface::partialX(x, y);
+}
+
+double CustomSurface::partialY(double x, double y) const
+{
+    return derivatives ? derivatives(x, y).dy : Surface::partialY(x, y);
+}
+
+Point3D CustomSurface::gradient(double x, double y) const
+{
+    if (!derivatives)
+        return Surface::gradient(x, y);
+    expr::Dual2 d = derivatives(x, y);
+    return Point3D(d.dx, d.dy, 0);
+}
+
+double CustomSurface::partialXX(double x, double y) const
+{
+    return derivatives ? derivatives(x, y).dxx : Surface::partialXX(x, y);
+}
+
+double CustomSurface::partialYY(double x, double y) const
+{
+    return derivatives ? derivatives(x, y).dyy : Surface::partialYY(x, y);
+}
+
+double CustomSurface::partialXY(double x, double y) const
+{
+    return derivatives ? derivatives(x, y).dxy : Surface::partialXY(x, y);
+}
+
+void CustomSurface::hessian(double x, double y, double &fxx, double &fxy, double &fyy) const
+{
+    if (!derivatives)
+    {
+        Surface::hessian(x, y, fxx, fxy, fyy);
+        return;
+    }
+    expr::Dual2 d = derivatives(x, y);
+    fxx = d.dxx;
+    fxy = d.dxy;
+    fyy = d.dyy;
+}
@@ -0,0 +1,322 @@
+#include "TestFunctions.h"
+#include <cmath>
+#include <sstream>
+#include <stdexcept>
+
+static const double PI = 3.14159265358979323846;
+
+// Rosenbrock
+double RosenbrockSurface::evaluate(double x, double y) const
+{
+    double a = 1 - x;
+    double b = y - x * x;
+    return a * a + 100 * b * b;
+}
+
+double RosenbrockSurface::partialX(double x, double y) const
+{
+    return -2 * (1 - x) - 400 * x * (y - x * x);
+}
+
+double RosenbrockSurface::partialY(double x, double y) const
+{
+    return 200 * (y - x * x);
+}
+
+Point3D RosenbrockSurface::gradient(double x, double y) const
+{
+    double b = y - x * x;
+    return Point3D(-2 * (1 - x) - 400 * x * b, 200 * b, 0);
+}
+
+void RosenbrockSurface::hessian(double x, double y, double &fxx, double &fxy, double &fyy) const
+{
+    fxx = 2 - 400 * y + 1200 * x * x;
+    fxy = -400 * x;
+    fyy = 200;
+}
+
+// Himmelblau
+double HimmelblauSurface::evaluate(double x, double y) const
+{
+    double a = x * x + y - 11;
+    double b = x + y * y - 7;
+    return a * a + b * b;
+}
+
+double HimmelblauSurface::partialX(double x, double y) const
+{
+    return gradient(x, y).getX();
+}
+
+double HimmelblauSurface::partialY(double x, double y) const
+{
+    return gradient(x, y).getY();
+}
+
+Point3D HimmelblauSurface::gradient(double x, double y) const
+{
+    double a = x * x + y - 11;
+    double b = x + y * y - 7;
+    return Point3D(4 * x * a + 2 * b, 2 * a + 4 * y * b, 0);
+}
+
+void HimmelblauSurface::hessian(double x, double y, double &fxx, double &fxy, double &fyy) const
+{
+    double a = x * x + y - 11;
+    double b = x + y * y - 7;
+    fxx = 4 * a + 8 * x * x + 2;
+    fxy = 4 * (x + y);
+    fyy = 2 + 4 * b + 8 * y * y;
+}
+
+// Beale
+double BealeSurface::evaluate(double x, double y) const
+{
+    double a = 1.5 - x + x * y;
+    double b = 2.25 - x + x * y * y;
+    double c = 2.625 - x + x * y * y * y;
+    return a * a + b * b + c * c;
+}
+
+double BealeSurface::partialX(double x, double y) const
+{
+    return gradient(x, y).getX();
+}
+
+double BealeSurface::partialY(double x, double y) const
+{
+    return gradient(x, y).getY();
+}
+
+Point3D BealeSurface::gradient(double x, double y) const
+{
+    double y2 = y * y, y3 = y2 * y;
+    double a = 1.5 - x + x * y;
+    double b = 2.25 - x + x * y2;
+    double c = 2.625 - x + x * y3;
+    return Point3D(2 * a * (y - 1) + 2 * b * (y2 - 1) + 2 * c * (y3 - 1),
+                   2 * a * x + 4 * b * x * y + 6 * c * x * y2, 0);
+}
+
+void BealeSurface::hessian(double x, double y, double &fxx, double &fxy, double &fyy) const
+{
+    // Sum of squares r_i^2: H = 2 sum(∇r_i ∇r_i^T + r_i ∇²r_i)
+    double y2 = y * y, y3 = y2 * y;
+    double a = 1.5 - x + x * y;
+    double b = 2.25 - x + x * y2;
+    double c = 2.625 - x + x * y3;
+    double ax = y - 1, bx = y2 - 1, cx = y3 - 1;
+    double ay = x, by = 2 * x * y, cy = 3 * x * y2;
+    fxx = 2 * (ax * ax + bx * bx + cx * cx);
+    fxy = 2 * (ax * ay + a + bx * by + 2 * b * y + cx * cy + 3 * c * y2);
+    fyy = 2 * (ay * ay + by * by + 2 * b * x + cy * cy + 6 * c * x * y);
+}
+
+// Booth
+double BoothSurface::evaluate(double x, double y) const
+{
+    double a = x + 2 * y - 7;
+    double b = 2 * x + y - 5;
+    return a * a + b * b;
+}
+
+double BoothSurface::partialX(double x, double y) const
+{
+    return 2 * (x + 2 * y - 7) + 4 * (2 * x + y - 5);
+}
+
+double BoothSurface::partialY(double x, double y) const
+{
+    return 4 * (x + 2 * y - 7) + 2 * (2 * x + y - 5);
+}
+
+Point3D BoothSurface::gradient(double x, double y) const
+{
+    double a = x + 2 * y - 7;
+    double b = 2 * x + y - 5;
+    return Point3D(2 * a + 4 * b, 4 * a + 2 * b, 0);
+}
+
+void BoothSurface::hessian(double, double, double &fxx, double &fxy, double &fyy) const
+{
+    fxx = 10;
+    fxy = 8;
+    fyy = 10;
+}
+
+// Rastrigin
+double RastriginSurface::evaluate(double x, double y) const
+{
+    return 20 + x * x - 10 * std::cos(2 * PI * x) + y * y - 10 * std::cos(2 * PI * y);
+}
+
+double RastriginSurface::partialX(double x, double) const
+{
+    return 2 * x + 20 * PI * std::sin(2 * PI * x);
+}
+
+double RastriginSurface::partialY(double, double y) const
+{
+    return 2 * y + 20 * PI * std::sin(2 * PI * y);
+}
+
+Point3D RastriginSurface::gradient(double x, double y) const
+{
+    return Point3D(partialX(x, y), partialY(x, y), 0);
+}
+
+void RastriginSurface::hessian(double x, double y, double &fxx, double &fxy, double &fyy) const
+{
+    fxx = 2 + 40 * PI * PI * std::cos(2 * PI * x);
+    fxy = 0;
+    fyy = 2 + 40 * PI * PI * std::cos(2 * PI * y);
+}
+
+// Ackley
+double AckleySurface::evaluate(double x, double y) const
+{
+    double r = std::sqrt(0.5 * (x * x + y * y));
+    return -20 * std::exp(-0.2 * r) - std::exp(0.5 * (std::cos(2 * PI * x) + std::cos(2 * PI * y))) +
+           std::exp(1.0) + 20;
+}
+
+double AckleySurface::partialX(double x, double y) const
+{
+    return gradient(x, y).getX();
+}
+
+double AckleySurface::partialY(double x, double y) const
+{
+    return gradient(x, y).getY();
+}
+
+Point3D AckleySurface::gradient(double x, double y) const
+{
+    // The radial term has no gradient at the origin; 0 is its subgradient
+    double r = std::sqrt(0.5 * (x * x + y * y));
+    double radial = r > 0 ? 2 * std::exp(-0.2 * r) / r : 0.0;
+    double wave = PI * std::exp(0.5 * (std::cos(2 * PI * x) + std::cos(2 * PI * y)));
+    return Point3D(radial * x + wave * std::sin(2 * PI * x),
+                   radial * y + wave * std::sin(2 * PI * y), 0);
+}
+
+void AckleySurface::hessian(double x, double y, double &fxx, double &fxy, double &fyy) const
+{
+    double sx = std::sin(2 * PI * x), sy = std::sin(2 * PI * y);
+    double wave = PI * PI * std::exp(0.5 * (std::cos(2 * PI * x) + std::cos(2 * PI * y)));
+    fxx = wave * (2 * std::cos(2 * PI * x) - sx * sx);
+    fxy = -wave * sx * sy;
+    fyy = wave * (2 * std::cos(2 * PI * y) - sy * sy);
+
+    // Radial term 2 x exp(-0.2 r) / r, differentiated again; unbounded at the origin
+    double r = std::sqrt(0.5 * (x * x + y * y));
+    if (r > 0)
+    {
+        double e = std::exp(-0.2 * r);
+        double shared = 0.2 / (r * r) + 1 / (r * r * r);
+        fxx += e * (2 / r - x * x * shared);
+        fxy -= e * x * y * shared;
+        fyy += e * (2 / r - y * y * shared);
+    }
+}
+
+// Six-hump camel
+double SixHumpCamelSurface::evaluate(double x, double y) const
+{
+    double x2 = x * x, y2 = y * y;
+    return (4 - 2.1 * x2 + x2 * x2 / 3) * x2 + x * y + (4 * y2 - 4) * y2;
+}
+
+double SixHumpCamelSurface::partialX(double x, double y) const
+{
+    double x2 = x * x;
+    return 8 * x - 8.4 * x2 * x + 2 * x2 * x2 * x + y;
+}
+
+double SixHumpCamelSurface::partialY(double x, double y) const
+{
+    return x - 8 * y + 16 * y * y * y;
+}
+
+Point3D SixHumpCamelSurface::gradient(double x, double y) const
+{
+    return Point3D(partialX(x, y), partialY(x, y), 0);
+}
+
+void SixHumpCamelSurface::hessian(double x, double y, double &fxx, double &fxy, double &fyy) const
+{
+    double x2 = x * x;
+    fxx = 8 - 25.2 * x2 + 10 * x2 * x2;
+    fxy = 1;
+    fyy = -8 + 48 * y * y;
+}
+
+// Extended Rosenbrock
+double ExtendedRosenbrock::value(const double *x) const
+{
+    double sum = 0;
+    for (size_t i = 0; i + 1 < n; ++i)
+    {
+        double a = 1 - x[i];
+        double b = x[i + 1] - x[i] * x[i];
+        sum += a * a + 100 * b * b;
+    }
+    return sum;
+}
+
+double ExtendedRosenbrock::valueAndGradient(const double *x, double *grad) const
+{
+    double sum = 0;
+    for (size_t i = 0; i < n; ++i)
+        grad[i] = 0;
+    for (size_t i = 0; i + 1 < n; ++i)
+    {
+        double a = 1 - x[i];
+        double b = x[i + 1] - x[i] * x[i];
+        sum += a * a + 100 * b * b;
+        grad[i] += -2 * a - 400 * x[i] * b;
+        grad[i + 1] += 200 * b;
+    }
+    return sum;
+}
+
+std::unique_ptr<Surface> namedSurface(const std::string &name)
+{
+    if (name == "paraboloid")
+        return std::unique_ptr<Surface>(new Paraboloid());
+    if (name == "saddle")
+        return std::unique_ptr<Surface>(new SaddleSurface());
+    if (name == "rosenbrock")
+        return std::unique_ptr<Surface>(new RosenbrockSurface());
+    if (name == "himmelblau")
+        return std::unique_ptr<Surface>(new HimmelblauSurface());
+    if (name == "beale")
+        return std::unique_ptr<Surface>(new BealeSurface());
+    if (name == "booth")
+        return std::unique_ptr<Surface>(new BoothSurface());
+    if (name == "rastrigin")
+        return std::unique_ptr<Surface>(new RastriginSurface());
+    if (name == "ackley")
+        return std::unique_ptr<Surface>(new AckleySurface());
+    if (name == "six-hump-camel")
+        return std::unique_ptr<Surface>(new SixHumpCamelSurface());
+    throw std::runtime_error("Unknown function: " + name);
+}
+
+std::vector<std::string> surfaceNames()
+{
+    return {"paraboloid", "saddle", "rosenbrock", "himmelblau", "beale", "booth",
+            "rastrigin", "ackley", "six-hump-camel"};
+}
+
+std::vector<std::string> splitList(const std::string &text)
+{
+    std::vector<std::string> items;
+    std::stringstream stream(text);
+    std::string item;
+    while (std::getline(stream, item, ','))
+        if (!item.empty())
+            items.push_back(item);
+    return items;
+}
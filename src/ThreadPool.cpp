@@ -0,0 +1,154 @@
+#include "ThreadPool.h"
+#include "Trace.h"
+#include <algorithm>
+#include <atomic>
+#include <exception>
+
+ThreadPool::ThreadPool(unsigned threadCount) : stopping(false)
+{
+    if (threadCount == 0)
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+
+    for (unsigned i = 0; i < threadCount; ++i)
+        workers.emplace_back(&ThreadPool::workerLoop, this, i);
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    available.notify_all();
+
+    for (auto &worker : workers)
+        worker.join();
+}
+
+void ThreadPool::enqueue(std::function<void()> task)
+{
+    if (tracing::active())
+    {
+        // The time spent queued and the run show on the worker's track
+        uint64_t queued = tracing::now();
+        task = [inner = std::move(task), queued]()
+        {
+            tracing::complete("pool", "queued", queued, tracing::now());
+            SURFACE_TRACE_SCOPE("pool", "task");
+            inner();
+        };
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        tasks.push_back(std::move(task));
+    }
+    available.notify_one();
+}
+
+void ThreadPool::workerLoop(unsigned index)
+{
+    tracing::setThreadName("pool worker " + std::to_string(index));
+
+    for (;;)
+    {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            available.wait(lock, [this]()
+                           { return stopping || !tasks.empty(); });
+            if (stopping && tasks.empty())
+                return;
+            task = std::move(tasks.front());
+            tasks.pop_front();
+        }
+        task();
+    }
+}
+
+// Shared between the caller and helper tasks of one parallelFor; helpers
+// that start after all chunks are claimed find nothing to do and exit
+struct ParallelForState
+{
+    size_t begin, end, grain, chunkCount;
+    std::function<void(size_t, size_t)> body;
+
+    std::atomic<size_t> nextChunk{0};
+    std::atomic<size_t> finishedChunks{0};
+    std::mutex mutex;
+    std::condition_variable done;
+    std::exception_ptr error;
+
+    void run()
+    {
+        for (;;)
+        {
+            size_t chunk = nextChunk.fetch_add(1);
+            if (chunk >= chunkCount)
+                return;
+
+            size_t lo = begin + chunk * grain;
+            size_t hi = std::min(end, lo + grain);
+            SURFACE_TRACE_SCOPE("pool", "chunk", static_cast<int64_t>(lo));
+            try
+            {
+                body(lo, hi);
+            }
+            catch (...)
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (!error)
+                    error = std::current_exception();
+            }
+
+            if (finishedChunks.fetch_add(1) + 1 == chunkCount)
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                done.notify_all();
+            }
+        }
+    }
+};
+
+void ThreadPool::parallelFor(size_t begin, size_t end, size_t grain,
+                             const std::function<void(size_t, size_t)> &body)
+{
+    if (end <= begin)
+        return;
+
+    grain = std::max<size_t>(1, grain);
+    size_t chunkCount = (end - begin + grain - 1) / grain;
+    if (chunkCount == 1 || workers.empty())
+    {
+        body(begin, end);
+        return;
+    }
+
+    SURFACE_TRACE_SCOPE("pool", "parallelFor", static_cast<int64_t>(chunkCount));
+    auto state = std::make_shared<ParallelForState>();
+    state->begin = begin;
+    state->end = end;
+    state->grain = grain;
+    state->chunkCount = chunkCount;
+    state->body = body;
+
+    size_t helpers = std::min<size_t>(workers.size(), chunkCount - 1);
+    for (size_t i = 0; i < helpers; ++i)
+        enqueue([state]()
+                { state->run(); });
+
+    state->run();
+
+    std::unique_lock<std::mutex> lock(state->mutex);
+    state->done.wait(lock, [&]()
+                     { return state->finishedChunks.load() == state->chunkCount; });
+
+    if (state->error)
+        std::rethrow_exception(state->error);
+}
+
+ThreadPool &ThreadPool::shared()
+{
+    static ThreadPool pool;
+    return pool;
+}
@@ -0,0 +1,264 @@
+#include "Trace.h"
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+namespace tracing
+{
+    std::atomic<bool> recording{false};
+
+#if SURFACE_INSTRUMENTATION
+
+    namespace
+    {
+        struct Event
+        {
+            const char *category;
+            const char *name;
+            uint64_t begin;
+            uint64_t end;
+            int64_t value;
+            bool hasValue;
+        };
+
+        // Events are appended into fixed-size chunks so a chunk never moves
+        // once the writer can see it; count is published with release
+        struct Chunk
+        {
+            static const size_t CAPACITY = 4096;
+            Event events[CAPACITY];
+            std::atomic<size_t> count{0};
+        };
+
+        // One per thread. Only the owning thread appends; the mutex guards
+        // the chunk list, taken when a chunk is added or the buffer is read.
+        // start() marks buffers stale and each owner empties its own on its
+        // next append; until then writeJson skips the old events by time.
+        struct Buffer
+        {
+            int tid;
+            std::string name;
+            std::mutex mutex;
+            std::vector<std::unique_ptr<Chunk>> chunks;
+            Chunk *current = nullptr;
+            std::atomic<bool> stale{false};
+
+            void append(const Event &event)
+            {
+                if (stale.load(std::memory_order_relaxed))
+                    recycle();
+                if (!current || current->count.load(std::memory_order_relaxed) == Chunk::CAPACITY)
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    chunks.emplace_back(new Chunk());
+                    current = chunks.back().get();
+                }
+                size_t n = current->count.load(std::memory_order_relaxed);
+                current->events[n] = event;
+                current->count.store(n + 1, std::memory_order_release);
+            }
+
+            // Keeps the first chunk for reuse
+            void recycle()
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (chunks.size() > 1)
+                    chunks.resize(1);
+                if (!chunks.empty())
+                    chunks.front()->count.store(0, std::memory_order_relaxed);
+                current = chunks.empty() ? nullptr : chunks.front().get();
+                stale.store(false, std::memory_order_relaxed);
+            }
+        };
+
+        // Buffers of every thread that has traced, kept after the thread
+        // exits so its events still reach the file
+        struct Registry
+        {
+            std::mutex mutex;
+            std::vector<std::shared_ptr<Buffer>> buffers;
+            uint64_t epoch = 0;
+            std::string exitPath;
+        };
+
+        Registry &registry()
+        {
+            static Registry instance;
+            return instance;
+        }
+
+        Buffer &threadBuffer()
+        {
+            thread_local std::shared_ptr<Buffer> buffer = []()
+            {
+                auto created = std::make_shared<Buffer>();
+                Registry &r = registry();
+                std::lock_guard<std::mutex> lock(r.mutex);
+                created->tid = static_cast<int>(r.buffers.size()) + 1;
+                created->name = "thread " + std::to_string(created->tid);
+                r.buffers.push_back(created);
+                return created;
+            }();
+            return *buffer;
+        }
+
+        void writeEscaped(std::ostream &out, const char *text)
+        {
+            out << '"';
+            for (const char *c = text; *c; ++c)
+            {
+                unsigned char ch = static_cast<unsigned char>(*c);
+                if (ch == '"' || ch == '\\')
+                    out << '\\' << *c;
+                else if (ch < 0x20)
+                {
+                    char escaped[8];
+                    std::snprintf(escaped, sizeof(escaped), "\\u%04x", ch);
+                    out << escaped;
+                }
+                else
+                    out << *c;
+            }
+            out << '"';
+        }
+
+        // Microseconds since start(), with nanosecond resolution
+        void writeMicroseconds(std::ostream &out, int64_t nanoseconds)
+        {
+            char text[32];
+            std::snprintf(text, sizeof(text), "%.3f", nanoseconds * 1e-3);
+            out << text;
+        }
+
+        void writeAtExit()
+        {
+            try
+            {
+                stop();
+                writeJson(registry().exitPath);
+            }
+            catch (const std::exception &e)
+            {
+                std::fprintf(stderr, "Trace not written: %s\n", e.what());
+            }
+        }
+    }
+
+    void start()
+    {
+        Registry &r = registry();
+        {
+            std::lock_guard<std::mutex> lock(r.mutex);
+            for (auto &buffer : r.buffers)
+                buffer->stale.store(true, std::memory_order_relaxed);
+            r.epoch = now();
+        }
+        recording.store(true, std::memory_order_relaxed);
+    }
+
+    void stop()
+    {
+        recording.store(false, std::memory_order_relaxed);
+    }
+
+    bool startFromEnvironment()
+    {
+        const char *path = std::getenv("SURFACE_TRACE");
+        if (!path || !*path)
+            return false;
+
+        registry().exitPath = path;
+        setThreadName("main");
+        start();
+        std::atexit(writeAtExit);
+        return true;
+    }
+
+    void setThreadName(const std::string &name)
+    {
+        Buffer &buffer = threadBuffer();
+        std::lock_guard<std::mutex> lock(buffer.mutex);
+        buffer.name = name;
+    }
+
+    void complete(const char *category, const char *name, uint64_t begin, uint64_t end,
+                  int64_t value, bool hasValue)
+    {
+        threadBuffer().append(Event{category, name, begin, end, value, hasValue});
+    }
+
+    void writeJson(const std::string &path)
+    {
+        std::ofstream out(path);
+        if (!out)
+            throw std::runtime_error("Cannot open trace file " + path);
+
+        Registry &r = registry();
+        std::lock_guard<std::mutex> registryLock(r.mutex);
+
+        out << "{\"traceEvents\":[\n";
+        bool first = true;
+        auto separator = [&]()
+        {
+            if (!first)
+                out << ",\n";
+            first = false;
+        };
+
+        for (auto &buffer : r.buffers)
+        {
+            std::lock_guard<std::mutex> lock(buffer->mutex);
+
+            separator();
+            out << "{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":1,\"tid\":" << buffer->tid
+                << ",\"args\":{\"name\":";
+            writeEscaped(out, buffer->name.c_str());
+            out << "}}";
+
+            for (auto &chunk : buffer->chunks)
+            {
+                size_t count = chunk->count.load(std::memory_order_acquire);
+                for (size_t i = 0; i < count; ++i)
+                {
+                    const Event &event = chunk->events[i];
+                    // Events that began before the last start() were left
+                    // over from an earlier recording
+                    if (event.begin < r.epoch)
+                        continue;
+
+                    separator();
+                    out << "{\"ph\":\"X\",\"cat\":";
+                    writeEscaped(out, event.category);
+                    out << ",\"name\":";
+                    writeEscaped(out, event.name);
+                    out << ",\"pid\":1,\"tid\":" << buffer->tid << ",\"ts\":";
+                    writeMicroseconds(out, static_cast<int64_t>(event.begin - r.epoch));
+                    out << ",\"dur\":";
+                    writeMicroseconds(out, static_cast<int64_t>(event.end - event.begin));
+                    if (event.hasValue)
+                        out << ",\"args\":{\"value\":" << event.value << "}";
+                    out << "}";
+                }
+            }
+        }
+        out << "\n],\"displayTimeUnit\":\"ms\"}\n";
+
+        if (!out)
+            throw std::runtime_error("Error writing trace file " + path);
+    }
+
+#else
+
+    void start() {}
+    void stop() {}
+    bool startFromEnvironment() { return false; }
+    void writeJson(const std::string &) {}
+    void setThreadName(const std::string &) {}
+    void complete(const char *, const char *, uint64_t, uint64_t, int64_t, bool) {}
+
+#endif
+}
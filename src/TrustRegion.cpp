@@ -0,0 +1,191 @@
+#include "TrustRegion.h"
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+    // Eigen decomposition of the symmetric [[a, b], [b, c]]: eigenvalues
+    // small <= large, with (qx, qy) the unit eigenvector of the small one
+    struct SymmetricEigen
+    {
+        double small, large;
+        double qx, qy;
+
+        SymmetricEigen(double a, double b, double c)
+        {
+            double mid = 0.5 * (a + c);
+            double radius = std::hypot(0.5 * (a - c), b);
+            small = mid - radius;
+            large = mid + radius;
+
+            if (radius == 0)
+            {
+                qx = 1;
+                qy = 0;
+                return;
+            }
+
+            // Two candidate null vectors of H - small I; keep the longer one
+            double ux = b, uy = small - a;
+            double vx = small - c, vy = b;
+            if (ux * ux + uy * uy < vx * vx + vy * vy)
+            {
+                ux = vx;
+                uy = vy;
+            }
+            double length = std::hypot(ux, uy);
+            qx = ux / length;
+            qy = uy / length;
+        }
+    };
+}
+
+TrustRegionNewton::TrustRegionNewton(const Surface *surf, double lr, int maxIter,
+                                     double tol, double maxRadius)
+    : Optimizer(surf, lr, maxIter, tol), maxRadius(maxRadius) {}
+
+double TrustRegionNewton::solveSubproblem(double gx, double gy,
+                                          double fxx, double fxy, double fyy,
+                                          double radius, double &px, double &py)
+{
+    SymmetricEigen eigen(fxx, fxy, fyy);
+    const double l1 = eigen.small, l2 = eigen.large;
+
+    // Gradient in the eigenbasis (q1, q2) with q2 = q1 rotated by 90 degrees
+    const double g1 = eigen.qx * gx + eigen.qy * gy;
+    const double g2 = -eigen.qy * gx + eigen.qx * gy;
+    const double gNorm = std::hypot(gx, gy);
+
+    double p1, p2;
+    auto stepNorm = [&](double mu)
+    { return std::hypot(g1 / (l1 + mu), g2 / (l2 + mu)); };
+
+    if (l1 > 0 && stepNorm(0) <= radius)
+    {
+        // Newton step inside the region
+        p1 = -g1 / l1;
+        p2 = -g2 / l2;
+    }
+    else
+    {
+        double lo = std::max(0.0, -l1);
+        double p2Pole = l2 - l1 > 0 ? -g2 / (l2 - l1) : 0.0;
+
+        if (l1 <= 0 && std::abs(g1) <= 1e-14 * std::max(1.0, gNorm) && std::abs(p2Pole) <= radius)
+        {
+            // Hard case: no shift reaches the boundary, so move along the
+            // most negative curvature direction to it
+            p2 = p2Pole;
+            p1 = std::sqrt(radius * radius - p2 * p2);
+            if (g1 > 0)
+                p1 = -p1;
+        }
+        else
+        {
+            // Shift mu with |p(mu)| = radius; 1/|p| - 1/radius increases in mu
+            double hi = lo + gNorm / radius;
+            double mu = hi;
+            for (int k = 0; k < 100; ++k)
+            {
+                double a = l1 + mu, b = l2 + mu;
+                double norm = std::hypot(g1 / a, g2 / b);
+                double phi = 1.0 / norm - 1.0 / radius;
+                if (std::abs(norm - radius) <= 1e-12 * radius)
+                    break;
+                if (phi < 0)
+                    lo = mu;
+                else
+                    hi = mu;
+
+                // Newton step on phi, bisection when it leaves the bracket
+                double slope = (g1 * g1 / (a * a * a) + g2 * g2 / (b * b * b)) / (norm * norm * norm);
+                double next = mu - phi / slope;
+                if (!(next > lo && next < hi))
+                    next = 0.5 * (lo + hi);
+                if (next == mu)
+                    break;
+                mu = next;
+            }
+            p1 = -g1 / (l1 + mu);
+            p2 = -g2 / (l2 + mu);
+        }
+    }
+
+    px = eigen.qx * p1 - eigen.qy * p2;
+    py = eigen.qy * p1 + eigen.qx * p2;
+    return -(g1 * p1 + g2 * p2 + 0.5 * (l1 * p1 * p1 + l2 * p2 * p2));
+}
+
+OptimizationResult TrustRegionNewton::optimize(double startX, double startY)
+{
+    OptimizationResult result;
+    result.converged = false;
+    result.iterations = 0;
+    resetCounters();
+
+    // Only accepted points go into the path
+    PathRecorder recorder(pathRecording, result.path, result.compactPath, maxIterations);
+
+    double x = startX, y = startY;
+    double z = evaluateSurface(x, y);
+    Point3D grad = surfaceGradient(x, y);
+    double fxx, fxy, fyy;
+    surfaceHessian(x, y, fxx, fxy, fyy);
+    double radius = learningRate;
+    recorder.record(x, y, z);
+
+    for (int iter = 0; iter < maxIterations; ++iter)
+    {
+        if (!keepGoing(x, y, z))
+            break;
+
+        double gx = grad.getX(), gy = grad.getY();
+
+        // A small gradient at a saddle is not a minimum; keep going down the
+        // negative curvature unless it is within the tolerance
+        if (std::hypot(gx, gy) < tolerance && SymmetricEigen(fxx, fxy, fyy).small > -tolerance)
+        {
+            result.converged = true;
+            result.iterations = iter;
+            break;
+        }
+
+        double px, py;
+        double predicted = solveSubproblem(gx, gy, fxx, fxy, fyy, radius, px, py);
+        if (!(predicted > 0))
+            break;
+
+        double xNew = x + px, yNew = y + py;
+        double zNew = evaluateSurface(xNew, yNew);
+        double rho = (z - zNew) / predicted;
+        double stepLength = std::hypot(px, py);
+
+        if (!(rho >= 0.25))
+            radius = 0.25 * stepLength;
+        else if (rho > 0.75 && stepLength >= 0.99 * radius)
+            radius = std::min(2 * radius, maxRadius);
+
+        result.iterations = iter + 1;
+
+        if (rho > 1e-4)
+        {
+            x = xNew;
+            y = yNew;
+            z = zNew;
+            grad = surfaceGradient(x, y);
+            surfaceHessian(x, y, fxx, fxy, fyy);
+            recorder.record(x, y, z);
+        }
+
+        // The region has collapsed below the resolution of x and y
+        if (radius <= 1e-15 * (1 + std::hypot(x, y)))
+            break;
+    }
+
+    recorder.finish();
+    result.minimumValue = z;
+    result.minimumPoint = Point3D(x, y, z);
+    recordCounters(result);
+
+    return result;
+}
@@ -0,0 +1,246 @@
+#include "VectorOptimizer.h"
+#include "QuasiNewton.h"
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <stdexcept>
+
+static void checkStart(const Objective *objective, const std::vector<double> &start)
+{
+    if (start.size() != objective->dimension())
+        throw std::runtime_error("Start point has " + std::to_string(start.size()) +
+                                 " entries, the objective " + std::to_string(objective->dimension()));
+}
+
+// Gradient descent
+VectorOptimizationResult VectorGradientDescent::minimize(const std::vector<double> &start)
+{
+    checkStart(objective, start);
+    const size_t n = start.size();
+
+    VectorOptimizationResult result;
+    result.x = start;
+    std::vector<double> grad(n);
+    double *x = result.x.data();
+
+    for (int iter = 0; iter < maxIterations; ++iter)
+    {
+        result.value = objective->valueAndGradient(x, grad.data());
+        result.functionEvaluations++;
+        result.gradientEvaluations++;
+        if (!std::isfinite(result.value))
+            break;
+
+        double norm2 = 0;
+        for (size_t i = 0; i < n; ++i)
+            norm2 += grad[i] * grad[i];
+        if (std::sqrt(norm2) < tolerance)
+        {
+            result.converged = true;
+            break;
+        }
+
+        for (size_t i = 0; i < n; ++i)
+            x[i] -= learningRate * grad[i];
+        result.iterations = iter + 1;
+    }
+
+    // Value at the final point when the loop ran out of iterations
+    if (!result.converged && result.iterations == maxIterations)
+    {
+        result.value = objective->value(x);
+        result.functionEvaluations++;
+    }
+
+    return result;
+}
+
+// L-BFGS
+VectorOptimizationResult VectorLBFGS::minimize(const std::vector<double> &start)
+{
+    checkStart(objective, start);
+
+    QuasiNewtonOptions options;
+    options.memory = memory;
+    options.maxIterations = maxIterations;
+    options.tolerance = tolerance;
+    options.initialStep = learningRate;
+    options.lineSearch = lineSearch;
+    options.recordPath = false;
+
+    const Objective *f = objective;
+    QuasiNewton solver([f](const std::vector<double> &x, std::vector<double> &grad)
+                       { return f->valueAndGradient(x.data(), grad.data()); },
+                       options);
+    QuasiNewtonResult qn = solver.minimize(start);
+
+    VectorOptimizationResult result;
+    result.x = std::move(qn.x);
+    result.value = qn.value;
+    result.iterations = qn.iterations;
+    result.converged = qn.converged;
+    result.functionEvaluations = qn.evaluations;
+    result.gradientEvaluations = qn.evaluations;
+    return result;
+}
+
+// Nelder-Mead
+VectorOptimizationResult VectorNelderMead::minimize(const std::vector<double> &start)
+{
+    checkStart(objective, start);
+    const size_t n = start.size();
+    const double dim = static_cast<double>(n);
+
+    // Reflection, expansion, contraction and shrink (Gao & Han 2012);
+    // the standard 1, 2, 0.5, 0.5 for n = 2
+    const double alpha = 1.0;
+    const double gamma = 1.0 + 2.0 / dim;
+    const double rho = 0.75 - 1.0 / (2.0 * dim);
+    const double sigma = 1.0 - 1.0 / dim;
+
+    VectorOptimizationResult result;
+
+    // Vertex k occupies simplex[k * n, (k + 1) * n)
+    std::vector<double> simplex((n + 1) * n), values(n + 1);
+    for (size_t k = 0; k <= n; ++k)
+    {
+        std::copy(start.begin(), start.end(), simplex.begin() + k * n);
+        if (k > 0)
+            simplex[k * n + (k - 1)] += learningRate;
+    }
+    objective->valueBatch(simplex.data(), n + 1, values.data());
+    result.functionEvaluations += static_cast<int>(n + 1);
+
+    std::vector<size_t> order(n + 1);
+    std::vector<double> sum(n), centroid(n), reflected(n), trial(n);
+    auto vertex = [&](size_t k)
+    { return &simplex[k * n]; };
+    auto resum = [&]()
+    {
+        std::fill(sum.begin(), sum.end(), 0.0);
+        for (size_t k = 0; k <= n; ++k)
+            for (size_t i = 0; i < n; ++i)
+                sum[i] += simplex[k * n + i];
+    };
+    // Replaces the worst vertex, keeping the sum current in O(n)
+    auto replace = [&](double *worst, const std::vector<double> &point)
+    {
+        for (size_t i = 0; i < n; ++i)
+        {
+            sum[i] += point[i] - worst[i];
+            worst[i] = point[i];
+        }
+    };
+    resum();
+    auto along = [&](double t, const double *from, std::vector<double> &out)
+    {
+        // out = centroid + t * (centroid - from)
+        for (size_t i = 0; i < n; ++i)
+            out[i] = centroid[i] + t * (centroid[i] - from[i]);
+    };
+
+    for (int iter = 0; iter < maxIterations; ++iter)
+    {
+        std::iota(order.begin(), order.end(), 0);
+        std::sort(order.begin(), order.end(), [&](size_t a, size_t b)
+                  { return values[a] < values[b]; });
+        const double *best = vertex(order[0]);
+        double bestValue = values[order[0]];
+
+        // An infinite or NaN best value (the objective overflowed or is
+        // unbounded below) would poison the running sum; stop here
+        if (!std::isfinite(bestValue))
+            break;
+
+        // Converged once the simplex is small in both f and x; the O(n^2)
+        // size check only runs once the values have closed up
+        double spread = values[order[n]] - bestValue;
+        double size = 0;
+        for (size_t k = 1; spread < tolerance && k <= n && size < tolerance; ++k)
+        {
+            const double *v = vertex(order[k]);
+            for (size_t i = 0; i < n; ++i)
+                size = std::max(size, std::abs(v[i] - best[i]));
+        }
+        if (spread < tolerance && size < tolerance)
+        {
+            result.converged = true;
+            break;
+        }
+        result.iterations = iter + 1;
+
+        size_t worstIndex = order[n];
+        double *worst = vertex(worstIndex);
+        double secondWorstValue = values[order[n - 1]];
+
+        // Centroid of all vertices but the worst, from the running sum
+        for (size_t i = 0; i < n; ++i)
+            centroid[i] = (sum[i] - worst[i]) / dim;
+
+        along(alpha, worst, reflected);
+        double reflectedValue = objective->value(reflected.data());
+        result.functionEvaluations++;
+
+        if (reflectedValue < bestValue)
+        {
+            // Expand: centroid + gamma * (reflected - centroid)
+            along(alpha * gamma, worst, trial);
+            double expandedValue = objective->value(trial.data());
+            result.functionEvaluations++;
+            if (expandedValue < reflectedValue)
+            {
+                replace(worst, trial);
+                values[worstIndex] = expandedValue;
+            }
+            else
+            {
+                replace(worst, reflected);
+                values[worstIndex] = reflectedValue;
+            }
+            continue;
+        }
+        if (reflectedValue < secondWorstValue)
+        {
+            replace(worst, reflected);
+            values[worstIndex] = reflectedValue;
+            continue;
+        }
+
+        // Contract outside towards the reflection or inside towards the worst
+        bool outside = reflectedValue < values[worstIndex];
+        along(outside ? alpha * rho : -rho, worst, trial);
+        double contractedValue = objective->value(trial.data());
+        result.functionEvaluations++;
+        if (contractedValue < std::min(reflectedValue, values[worstIndex]))
+        {
+            replace(worst, trial);
+            values[worstIndex] = contractedValue;
+            continue;
+        }
+
+        // Shrink every vertex towards the best. The best moves to slot 0 so
+        // the n shrunk vertices are contiguous and go in one batch; its own
+        // value is unchanged and not evaluated again
+        size_t bestIndex = order[0];
+        if (bestIndex != 0)
+        {
+            std::swap_ranges(vertex(0), vertex(0) + n, vertex(bestIndex));
+            std::swap(values[0], values[bestIndex]);
+        }
+        best = vertex(0);
+        for (size_t k = 1; k <= n; ++k)
+        {
+            double *v = vertex(k);
+            for (size_t i = 0; i < n; ++i)
+                v[i] = best[i] + sigma * (v[i] - best[i]);
+        }
+        objective->valueBatch(vertex(1), n, values.data() + 1);
+        result.functionEvaluations += static_cast<int>(n);
+        resum();
+    }
+
+    size_t bestIndex = static_cast<size_t>(std::min_element(values.begin(), values.end()) - values.begin());
+    result.x.assign(vertex(bestIndex), vertex(bestIndex) + n);
+    result.value = values[bestIndex];
+    return result;
+}
@@ -1,14 +1,23 @@
 #include "Visualizer.h"
+#include "BasinMap.h"
+#include "Instrumentation.h"
+#include "Trace.h"
+#include <algorithm>
 #include <cmath>
+#include <iostream>
+#include <vector>
 
 // Static instance for GLUT callbacks
 Visualizer *Visualizer::instance = nullptr;
 
 Visualizer::Visualizer(const Surface *surf, double xMin, double xMax,
                        double yMin, double yMax, int res)
-    : surface(surf), optResult(nullptr),
+    : surface(surf), optResult(nullptr), heightField(nullptr),
       rotationX(30.0f), rotationY(45.0f), zoom(30.0f),
-      xMin(xMin), xMax(xMax), yMin(yMin), yMax(yMax), resolution(res)
+      xMin(xMin), xMax(xMax), yMin(yMin), yMax(yMax), resolution(res),
+      modelviewMatrix(), projectionMatrix(), viewport(), hasPick(false),
+      basinMap(nullptr), basinColouring(PLAIN), basinMaxIterations(0),
+      surfaceList(0), meshListsValid(true)
 {
     instance = this;
 }
@@ -18,6 +27,36 @@ void Visualizer::setOptimizationResult(OptimizationResult *result)
     optResult = result;
 }
 
+void Visualizer::setHeightField(const HeightField *field)
+{
+    heightField = (field && !field->empty()) ? field : nullptr;
+    pyramid = heightField ? HeightPyramid(*heightField) : HeightPyramid();
+    fieldMesh = heightField ? buildGridMesh(*heightField) : GridMeshF();
+    hasPick = false;
+    meshListsValid = false;
+}
+
+void Visualizer::setBasinMap(const BasinMap *map)
+{
+    basinMap = map;
+    basinColouring = map ? BASINS : PLAIN;
+    basinMaxIterations = 0;
+    if (map)
+        for (int iterations : map->iterations)
+            basinMaxIterations = std::max(basinMaxIterations, iterations);
+    meshListsValid = false; // Basin colours are compiled into the lists
+}
+
+void Visualizer::setStatusText(const std::string &text)
+{
+    statusText = text;
+}
+
+void Visualizer::setCancelHandler(std::function<void()> handler)
+{
+    cancelHandler = std::move(handler);
+}
+
 void Visualizer::initialize(int argc, char **argv)
 {
     glutInit(&argc, argv);
@@ -43,6 +82,7 @@ void Visualizer::initialize(int argc, char **argv)
     glutDisplayFunc(displayCallback);
     glutReshapeFunc(reshapeCallback);
     glutKeyboardFunc(keyboardCallback);
+    glutMouseFunc(mouseCallback);
 }
 
 void Visualizer::run()
@@ -102,6 +142,17 @@ void Visualizer::keyboardCallback(unsigned char key, int x, int y)
         instance->rotationY = 45.0f;
         instance->zoom = 30.0f;
         break;
+    case 'b':
+        if (instance->basinMap)
+        {
+            instance->basinColouring = (BasinColouring)((instance->basinColouring + 1) % 3);
+            instance->meshListsValid = false;
+        }
+        break;
+    case 'c':
+        if (instance->cancelHandler)
+            instance->cancelHandler();
+        break;
     case 27: // ESC
         exit(0);
         break;
@@ -109,8 +160,22 @@ void Visualizer::keyboardCallback(unsigned char key, int x, int y)
     glutPostRedisplay();
 }
 
+void Visualizer::mouseCallback(int button, int state, int x, int y)
+{
+    if (!instance)
+        return;
+
+    // Left click picks a point on the surface
+    if (button == GLUT_LEFT_BUTTON && state == GLUT_DOWN)
+    {
+        instance->pick(x, y);
+        glutPostRedisplay();
+    }
+}
+
 void Visualizer::display()
 {
+    SURFACE_TIME_SCOPE(RENDER);
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
     glLoadIdentity();
 
@@ -121,19 +186,67 @@ void Visualizer::display()
     glRotatef(rotationX, 1, 0, 0);
     glRotatef(rotationY, 0, 1, 0);
 
+    // Remember the camera for LOD selection and picking
+    glGetDoublev(GL_MODELVIEW_MATRIX, modelviewMatrix);
+    glGetDoublev(GL_PROJECTION_MATRIX, projectionMatrix);
+    glGetIntegerv(GL_VIEWPORT, viewport);
+
     drawAxes();
     drawSurface();
 
+    if (hasPick)
+    {
+        drawPick();
+    }
+
     if (optResult)
     {
         drawOptimizationPath();
     }
 
+    if (!statusText.empty())
+    {
+        drawStatus();
+    }
+
+    SURFACE_TRACE_SCOPE("render", "swap");
     glutSwapBuffers();
 }
 
+void Visualizer::drawStatus()
+{
+    SURFACE_TRACE_SCOPE("render", "status");
+    glDisable(GL_LIGHTING);
+    glDisable(GL_DEPTH_TEST);
+
+    // Window coordinates, restored afterwards
+    glMatrixMode(GL_PROJECTION);
+    glPushMatrix();
+    glLoadIdentity();
+    gluOrtho2D(0, viewport[2], 0, viewport[3]);
+    glMatrixMode(GL_MODELVIEW);
+    glPushMatrix();
+    glLoadIdentity();
+
+    glColor3f(1.0f, 1.0f, 1.0f);
+    glRasterPos2f(10, 10);
+    for (char c : statusText)
+    {
+        glutBitmapCharacter(GLUT_BITMAP_8_BY_13, c);
+    }
+
+    glPopMatrix();
+    glMatrixMode(GL_PROJECTION);
+    glPopMatrix();
+    glMatrixMode(GL_MODELVIEW);
+
+    glEnable(GL_DEPTH_TEST);
+    glEnable(GL_LIGHTING);
+}
+
 void Visualizer::drawAxes()
 {
+    SURFACE_TRACE_SCOPE("render", "axes");
     glDisable(GL_LIGHTING);
     glLineWidth(2.0f);
 
@@ -161,45 +274,315 @@ void Visualizer::drawAxes()
 
 void Visualizer::drawSurface()
 {
-    double xStep = (xMax - xMin) / resolution;
-    double yStep = (yMax - yMin) / resolution;
+    SURFACE_TRACE_SCOPE("render", "surface");
+    if (!meshListsValid)
+    {
+        releaseMeshLists();
+        meshListsValid = true;
+    }
 
+    if (heightField)
+    {
+        drawHeightField();
+        return;
+    }
+
+    if (surfaceList != 0)
+    {
+        glCallList(surfaceList);
+        return;
+    }
+
+    // Each vertex is evaluated once, in batches, with analytic normals
+    GridMeshF mesh = buildGridMesh(surface->sampleHeightField(xMin, xMax, yMin, yMax, resolution, true));
+
+    std::vector<float> colours;
+    if (basinColouring != PLAIN)
+    {
+        colours.resize(mesh.positions.size());
+        for (size_t v = 0; v < mesh.vertexCount(); ++v)
+            basinColour(mesh.positions[3 * v], mesh.positions[3 * v + 1], &colours[3 * v]);
+    }
+
+    // Vertex arrays are copied into the list when it is compiled
+    surfaceList = glGenLists(1);
+    glNewList(surfaceList, GL_COMPILE_AND_EXECUTE);
     glColor3f(0.5f, 0.7f, 1.0f); // Light blue surface
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glEnableClientState(GL_NORMAL_ARRAY);
+    glVertexPointer(3, GL_FLOAT, 0, mesh.positions.data());
+    glNormalPointer(GL_FLOAT, 0, mesh.normals.data());
+    if (!colours.empty())
+    {
+        glEnableClientState(GL_COLOR_ARRAY);
+        glColorPointer(3, GL_FLOAT, 0, colours.data());
+    }
+    glDrawElements(GL_TRIANGLES, static_cast<GLsizei>(mesh.indices.size()), GL_UNSIGNED_INT,
+                   mesh.indices.data());
+    glDisableClientState(GL_COLOR_ARRAY);
+    glDisableClientState(GL_NORMAL_ARRAY);
+    glDisableClientState(GL_VERTEX_ARRAY);
+    glEndList();
+}
+
+void Visualizer::releaseMeshLists()
+{
+    if (surfaceList != 0)
+        glDeleteLists(surfaceList, 1);
+    surfaceList = 0;
+
+    for (GLuint list : tileLists)
+        if (list != 0)
+            glDeleteLists(list, 1);
+    tileLists.clear();
+}
+
+// Base cells per LOD tile side; a power of two so that coarse tile
+// vertices line up with pyramid cells
+static const int LOD_TILE_CELLS = 32;
 
-    for (int i = 0; i < resolution; ++i)
+// Largest on-screen geometric error, in pixels, a tile may show
+static const double LOD_PIXEL_TOLERANCE = 1.0;
+
+static const double PI = 3.14159265358979323846;
+
+void Visualizer::drawHeightField()
+{
+    const HeightField &field = *heightField;
+    int cellColumns = field.getColumns() - 1;
+    int cellRows = field.getRows() - 1;
+    int tileColumns = (cellColumns + LOD_TILE_CELLS - 1) / LOD_TILE_CELLS;
+    int tileRows = (cellRows + LOD_TILE_CELLS - 1) / LOD_TILE_CELLS;
+
+    int maxLevel = 0;
+    while ((2 << maxLevel) <= LOD_TILE_CELLS && maxLevel + 1 < pyramid.levelCount())
+        ++maxLevel;
+
+    // Pixels covered by one world unit at unit eye distance (45 degree FOV)
+    double pixelsPerUnit = viewport[3] / (2.0 * std::tan(45.0 * PI / 360.0));
+
+    // Pick the coarsest level whose projected error stays under tolerance
+    std::vector<int> tileLevels(static_cast<size_t>(tileColumns) * tileRows);
+    std::vector<float> tileErrors(tileLevels.size());
+    for (int tj = 0; tj < tileRows; ++tj)
     {
-        glBegin(GL_TRIANGLE_STRIP);
-        for (int j = 0; j <= resolution; ++j)
+        for (int ti = 0; ti < tileColumns; ++ti)
         {
-            double x1 = xMin + i * xStep;
-            double x2 = xMin + (i + 1) * xStep;
-            double y = yMin + j * yStep;
+            int i0 = ti * LOD_TILE_CELLS, i1 = std::min(i0 + LOD_TILE_CELLS, cellColumns);
+            int j0 = tj * LOD_TILE_CELLS, j1 = std::min(j0 + LOD_TILE_CELLS, cellRows);
+
+            double cx = 0.5 * (field.xAt(i0) + field.xAt(i1));
+            double cy = 0.5 * (field.yAt(j0) + field.yAt(j1));
+            double cz = field.height((i0 + i1) / 2, (j0 + j1) / 2);
+            const GLdouble *m = modelviewMatrix;
+            double ex = m[0] * cx + m[4] * cy + m[8] * cz + m[12];
+            double ey = m[1] * cx + m[5] * cy + m[9] * cz + m[13];
+            double ez = m[2] * cx + m[6] * cy + m[10] * cz + m[14];
+            double distance = std::max(std::sqrt(ex * ex + ey * ey + ez * ez), 1e-6);
+
+            int level = 0;
+            for (int candidate = maxLevel; candidate > 0; --candidate)
+            {
+                double error = pyramid.maxError(candidate, i0, j0, i1, j1);
+                if (error * pixelsPerUnit / distance <= LOD_PIXEL_TOLERANCE)
+                {
+                    level = candidate;
+                    break;
+                }
+            }
+
+            size_t tile = static_cast<size_t>(tj) * tileColumns + ti;
+            tileLevels[tile] = level;
+            tileErrors[tile] = pyramid.maxError(level, i0, j0, i1, j1);
+        }
+    }
 
-            double z1 = surface->evaluate(x1, y);
-            double z2 = surface->evaluate(x2, y);
+    // One display list per tile and level, compiled on first use
+    size_t levelCount = static_cast<size_t>(maxLevel) + 1;
+    if (tileLists.empty())
+        tileLists.assign(tileLevels.size() * levelCount, 0);
 
-            // Calculate normals for lighting
-            Point3D grad1 = surface->gradient(x1, y);
-            Point3D normal1(-grad1.getX(), -grad1.getY(), 1.0);
-            normal1 = normal1.normalize();
+    glColor3f(0.5f, 0.7f, 1.0f); // Light blue surface
 
-            Point3D grad2 = surface->gradient(x2, y);
-            Point3D normal2(-grad2.getX(), -grad2.getY(), 1.0);
-            normal2 = normal2.normalize();
+    for (int tj = 0; tj < tileRows; ++tj)
+    {
+        for (int ti = 0; ti < tileColumns; ++ti)
+        {
+            size_t tile = static_cast<size_t>(tj) * tileColumns + ti;
+
+            // Skirts must cover the error of whichever neighbour is coarser
+            float skirt = tileErrors[tile];
+            if (ti > 0)
+                skirt = std::max(skirt, tileErrors[tile - 1]);
+            if (ti + 1 < tileColumns)
+                skirt = std::max(skirt, tileErrors[tile + 1]);
+            if (tj > 0)
+                skirt = std::max(skirt, tileErrors[tile - tileColumns]);
+            if (tj + 1 < tileRows)
+                skirt = std::max(skirt, tileErrors[tile + tileColumns]);
+
+            int i0 = ti * LOD_TILE_CELLS, i1 = std::min(i0 + LOD_TILE_CELLS, cellColumns);
+            int j0 = tj * LOD_TILE_CELLS, j1 = std::min(j0 + LOD_TILE_CELLS, cellRows);
+            drawTile(i0, j0, i1, j1, 1 << tileLevels[tile], skirt,
+                     tileLists[tile * levelCount + tileLevels[tile]]);
+        }
+    }
+}
 
-            glNormal3f(normal1.getX(), normal1.getY(), normal1.getZ());
-            glVertex3f(x1, y, z1);
+void Visualizer::drawTile(int i0, int j0, int i1, int j1, int stride, float skirtDepth, GLuint &list)
+{
+    if (list != 0)
+    {
+        glCallList(list);
+    }
+    else
+    {
+        list = glGenLists(1);
+        glNewList(list, GL_COMPILE_AND_EXECUTE);
+        for (int i = i0; i < i1; i += stride)
+        {
+            int iNext = std::min(i + stride, i1);
+            glBegin(GL_TRIANGLE_STRIP);
+            for (int j = j0;; j = std::min(j + stride, j1))
+            {
+                emitFieldVertex(i, j);
+                emitFieldVertex(iNext, j);
+                if (j == j1)
+                    break;
+            }
+            glEnd();
+        }
+        glEndList();
+    }
+
+    if (skirtDepth <= 0.0f)
+        return;
 
-            glNormal3f(normal2.getX(), normal2.getY(), normal2.getZ());
-            glVertex3f(x2, y, z2);
+    // Vertical skirts hide cracks against tiles drawn at another level;
+    // their depth changes with the view, so they are not cached
+    int edgeRows[2] = {j0, j1};
+    for (int j : edgeRows)
+    {
+        glBegin(GL_TRIANGLE_STRIP);
+        for (int i = i0;; i = std::min(i + stride, i1))
+        {
+            emitFieldVertex(i, j);
+            emitFieldVertex(i, j, -skirtDepth);
+            if (i == i1)
+                break;
         }
         glEnd();
     }
+
+    int edgeColumns[2] = {i0, i1};
+    for (int i : edgeColumns)
+    {
+        glBegin(GL_TRIANGLE_STRIP);
+        for (int j = j0;; j = std::min(j + stride, j1))
+        {
+            emitFieldVertex(i, j);
+            emitFieldVertex(i, j, -skirtDepth);
+            if (j == j1)
+                break;
+        }
+        glEnd();
+    }
+}
+
+void Visualizer::emitFieldVertex(int i, int j, float zOffset)
+{
+    size_t v = 3 * (static_cast<size_t>(j) * fieldMesh.columns + i);
+    const float *position = &fieldMesh.positions[v];
+    applyBasinColour(position[0], position[1]);
+    glNormal3fv(&fieldMesh.normals[v]);
+    glVertex3f(position[0], position[1], position[2] + zOffset);
+}
+
+void Visualizer::applyBasinColour(double x, double y)
+{
+    float rgb[3];
+    if (basinColour(x, y, rgb))
+        glColor3fv(rgb);
+}
+
+bool Visualizer::basinColour(double x, double y, float *rgb) const
+{
+    if (basinColouring == PLAIN)
+        return false;
+
+    if (basinColouring == ITERATIONS)
+    {
+        // Log-scaled heat map: blue for quick descents, red for slow ones
+        int iterations = basinMap->iterationsAt(x, y);
+        float t = basinMaxIterations > 0
+                      ? static_cast<float>(std::log1p(iterations) / std::log1p(basinMaxIterations))
+                      : 0.0f;
+        rgb[0] = t;
+        rgb[1] = 0.2f + 0.6f * (1 - std::abs(2 * t - 1));
+        rgb[2] = 1 - t;
+        return true;
+    }
+
+    int label = basinMap->labelAt(x, y);
+    if (label == BasinMap::NO_MINIMUM)
+    {
+        rgb[0] = rgb[1] = rgb[2] = 0.4f; // Grey where no run converged
+        return true;
+    }
+
+    // Hues spaced by the golden angle stay distinct for many basins
+    double hue = std::fmod(label * 0.618033988749895, 1.0) * 6.0;
+    int sector = static_cast<int>(hue);
+    float f = static_cast<float>(hue - sector);
+    float table[6][3] = {{1, f, 0}, {1 - f, 1, 0}, {0, 1, f}, {0, 1 - f, 1}, {f, 0, 1}, {1, 0, 1 - f}};
+    const float *c = table[sector % 6];
+    for (int k = 0; k < 3; ++k)
+        rgb[k] = 0.25f + 0.65f * c[k];
+    return true;
+}
+
+void Visualizer::drawPick()
+{
+    SURFACE_TRACE_SCOPE("render", "pick");
+    glDisable(GL_LIGHTING);
+    glColor3f(1.0f, 1.0f, 0.0f);
+    glPushMatrix();
+    glTranslatef(pickPoint.getX(), pickPoint.getY(), pickPoint.getZ());
+    glutSolidSphere(0.15, 12, 12);
+    glPopMatrix();
+    glEnable(GL_LIGHTING);
+}
+
+void Visualizer::pick(int x, int y)
+{
+    if (pyramid.empty())
+        return;
+
+    // Unproject the click at the near and far planes
+    GLdouble winX = x;
+    GLdouble winY = viewport[1] + viewport[3] - y;
+    GLdouble nearX, nearY, nearZ, farX, farY, farZ;
+    if (!gluUnProject(winX, winY, 0.0, modelviewMatrix, projectionMatrix, viewport,
+                      &nearX, &nearY, &nearZ) ||
+        !gluUnProject(winX, winY, 1.0, modelviewMatrix, projectionMatrix, viewport,
+                      &farX, &farY, &farZ))
+        return;
+
+    Point3D origin(nearX, nearY, nearZ);
+    Point3D direction(farX - nearX, farY - nearY, farZ - nearZ);
+
+    hasPick = pyramid.intersectRay(origin, direction, pickPoint);
+    if (hasPick)
+    {
+        std::cout << "Picked point: ";
+        pickPoint.print();
+    }
 }
 
 void Visualizer::drawOptimizationPath()
 {
-    if (!optResult || optResult->path.empty())
+    SURFACE_TRACE_SCOPE("render", "path");
+    if (!optResult || optResult->pathSize() == 0)
         return;
 
     glDisable(GL_LIGHTING);
@@ -209,8 +592,9 @@ void Visualizer::drawOptimizationPath()
     glLineWidth(3.0f);
 
     glBegin(GL_LINE_STRIP);
-    for (const auto &point : optResult->path)
+    for (size_t i = 0; i < optResult->pathSize(); ++i)
     {
+        Point3D point = optResult->pathPoint(i);
         glVertex3f(point.getX(), point.getY(), point.getZ());
     }
     glEnd();
@@ -218,7 +602,7 @@ void Visualizer::drawOptimizationPath()
     // Draw start point as green sphere
     glColor3f(0.0f, 1.0f, 0.0f);
     glPushMatrix();
-    Point3D start = optResult->path.front();
+    Point3D start = optResult->pathPoint(0);
     glTranslatef(start.getX(), start.getY(), start.getZ());
     glutSolidSphere(0.2, 20, 20);
     glPopMatrix();
@@ -226,7 +610,7 @@ void Visualizer::drawOptimizationPath()
     // Draw end point (minimum) as large red sphere
     glColor3f(1.0f, 0.0f, 0.0f);
     glPushMatrix();
-    Point3D end = optResult->path.back();
+    Point3D end = optResult->pathPoint(optResult->pathSize() - 1);
     glTranslatef(end.getX(), end.getY(), end.getZ());
     glutSolidSphere(0.3, 20, 20);
     glPopMatrix();